@@ -0,0 +1,65 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <cstdint>
+#include <thread>
+#include <catch2/catch.hpp>
+#include "async/atomic_acq_rel.h"
+
+namespace
+{
+    // One thread writes written while another thread polls polled; without padding, both values share a cache line.
+    template <template <typename> typename Atomic>
+    struct neighbors final
+    {
+        Atomic<std::int64_t> written{ 0 };
+        Atomic<std::int64_t> polled{ 0 };
+    };
+
+    template <typename T>
+    using unpadded_atomic_acq_rel = async::details::atomic_acq_rel<T>;
+
+    template <template <typename> typename Atomic>
+    void write_while_polling(Catch::Benchmark::Chronometer& meter, std::int64_t iterations)
+    {
+        neighbors<Atomic> values{};
+        async::details::padded_atomic_acq_rel<bool> started{ false };
+        std::thread poller{ [&values, &started]()
+            {
+                started = true;
+
+                while (values.polled.load() == 0)
+                {
+                }
+            } };
+
+        while (!started.load())
+        {
+        }
+
+        meter.measure([&values, iterations]()
+            {
+                for (std::int64_t i = 1; i <= iterations; ++i)
+                {
+                    values.written = i;
+                }
+            });
+
+        values.polled = 1;
+        poller.join();
+    }
+}
+
+TEST_CASE("atomic_acq_rel false sharing", "[benchmark]")
+{
+    constexpr std::int64_t iterations{ 100000 };
+
+    BENCHMARK_ADVANCED("write 100000 times next to a polled atomic_acq_rel")(Catch::Benchmark::Chronometer meter)
+    {
+        write_while_polling<unpadded_atomic_acq_rel>(meter, iterations);
+    };
+
+    BENCHMARK_ADVANCED("write 100000 times next to a polled padded_atomic_acq_rel")(Catch::Benchmark::Chronometer meter)
+    {
+        write_while_polling<async::details::padded_atomic_acq_rel>(meter, iterations);
+    };
+}
@@ -0,0 +1,63 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <coroutine>
+#include <catch2/catch.hpp>
+#include "async/awaitable_result.h"
+#include "async/awaitable_then.h"
+
+namespace
+{
+    constexpr int stepCount{ 8 };
+
+    struct ready_value final
+    {
+        [[nodiscard]] constexpr bool await_ready() const noexcept { return true; }
+        constexpr void await_suspend(std::coroutine_handle<>) const noexcept {}
+        [[nodiscard]] constexpr int await_resume() const noexcept { return value; }
+
+        int value;
+    };
+
+    constexpr int increment(int value) noexcept { return value + 1; }
+
+    // Chains steps the only way awaitable_then allows: each continuation starts the next awaitable_then, so every
+    // step allocates its own coroutine frame.
+    void run_nested(int value, int remaining, int& result)
+    {
+        if (remaining == 0)
+        {
+            result = value;
+            return;
+        }
+
+        async::awaitable_then(ready_value{ value }, [remaining, &result](async::awaitable_result<int> stepResult)
+            { run_nested(increment(stepResult()), remaining - 1, result); });
+    }
+}
+
+// The nested form allocates one coroutine frame per step (8 per chain); the fused then() chain runs its steps in the
+// frame of the awaitable_then that consumes it (1 per chain).
+TEST_CASE("awaitable_then() chaining", "[benchmark]")
+{
+    BENCHMARK("8 steps as nested awaitable_then() calls")
+    {
+        int result{};
+        run_nested(0, stepCount, result);
+        return result;
+    };
+
+    BENCHMARK("8 steps fused by then()")
+    {
+        int result{};
+        async::awaitable_then(async::then(ready_value{ 0 }, increment)
+                                  .then(increment)
+                                  .then(increment)
+                                  .then(increment)
+                                  .then(increment)
+                                  .then(increment)
+                                  .then(increment)
+                                  .then(increment),
+            [&result](async::awaitable_result<int> chainResult) { result = chainResult(); });
+        return result;
+    };
+}
@@ -0,0 +1,79 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/batcher.h"
+#include "async/task.h"
+
+namespace
+{
+    // Simulates a storage backend whose calls have a fixed cost (such as a network round trip) plus a small cost per
+    // item.
+    void simulate_backend_call(std::size_t itemCount)
+    {
+        const std::chrono::steady_clock::time_point done{ std::chrono::steady_clock::now() +
+                                                          std::chrono::microseconds{ 2 } +
+                                                          std::chrono::nanoseconds{ 20 } * itemCount };
+
+        while (std::chrono::steady_clock::now() < done)
+        {
+        }
+    }
+
+    async::task<std::int64_t> get_one(std::int64_t key)
+    {
+        simulate_backend_call(1);
+        co_return key;
+    }
+
+    async::task<std::vector<std::int64_t>> get_many(std::vector<std::int64_t> keys)
+    {
+        simulate_backend_call(keys.size());
+        co_return keys;
+    }
+
+    async::task<void> get_unbatched(std::int64_t key, std::int64_t& sum) { sum += co_await get_one(key); }
+
+    async::task<void> get_batched(async::batcher<std::int64_t, std::int64_t>& batcher, std::int64_t key,
+        std::int64_t& sum)
+    {
+        sum += co_await batcher.submit(key);
+    }
+}
+
+// Issues 10000 independent gets, either as individual backend calls or coalesced by a batcher into calls of up to 64
+// items.
+TEST_CASE("batcher throughput", "[benchmark]")
+{
+    constexpr std::int64_t getCount{ 10000 };
+
+    BENCHMARK("10000 unbatched gets")
+    {
+        std::int64_t sum{};
+        std::vector<async::task<void>> gets{};
+
+        for (std::int64_t key = 0; key != getCount; ++key)
+        {
+            gets.push_back(get_unbatched(key, sum));
+        }
+
+        return sum;
+    };
+
+    BENCHMARK("10000 gets in batches of 64")
+    {
+        std::int64_t sum{};
+        async::batcher<std::int64_t, std::int64_t> batcher{ 64, std::chrono::milliseconds{ 1 }, get_many };
+        std::vector<async::task<void>> gets{};
+
+        for (std::int64_t key = 0; key != getCount; ++key)
+        {
+            gets.push_back(get_batched(batcher, key, sum));
+        }
+
+        batcher.flush();
+        return sum;
+    };
+}
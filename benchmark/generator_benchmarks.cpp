@@ -0,0 +1,87 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/generator.h"
+
+namespace
+{
+    constexpr int valueCount{ 1'000'000 };
+
+    async::generator<int> generate_values(int count)
+    {
+        for (int value = 0; value != count; ++value)
+        {
+            co_yield value;
+        }
+    }
+
+    // Yields count values through a chain of depth nested generators (the values all come from the innermost one).
+    async::generator<int> generate_nested_values(int depth, int count)
+    {
+        if (depth == 0)
+        {
+            co_yield async::elements_of(generate_values(count));
+        }
+        else
+        {
+            co_yield async::elements_of(generate_nested_values(depth - 1, count));
+        }
+    }
+
+    // The approach generator replaces: materializing every value in a vector before consuming it.
+    std::vector<int> materialize_values(int count)
+    {
+        std::vector<int> values{};
+
+        for (int value = 0; value != count; ++value)
+        {
+            values.push_back(value);
+        }
+
+        return values;
+    }
+
+    std::int64_t sum(async::generator<int> generator)
+    {
+        std::int64_t total{};
+
+        for (int value : generator)
+        {
+            total += value;
+        }
+
+        return total;
+    }
+}
+
+TEST_CASE("generator throughput", "[benchmark]")
+{
+    BENCHMARK("generator 1M values")
+    {
+        return sum(generate_values(valueCount));
+    };
+
+    BENCHMARK("vector-materializing loop 1M values")
+    {
+        std::int64_t total{};
+
+        for (int value : materialize_values(valueCount))
+        {
+            total += value;
+        }
+
+        return total;
+    };
+
+    // Resuming goes directly to the innermost generator, so the time should not grow with the depth.
+    for (int depth = 1; depth <= 64; depth *= 8)
+    {
+        BENCHMARK("generator 1M values nested " + std::to_string(depth) + " deep")
+        {
+            return sum(generate_nested_values(depth, valueCount));
+        };
+    }
+}
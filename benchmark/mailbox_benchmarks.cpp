@@ -0,0 +1,159 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/mailbox.h"
+#include "async/mpmc_channel.h"
+#include "async/task.h"
+
+namespace
+{
+    constexpr int messageCount{ 1 << 20 };
+
+    struct message final : async::mailbox_node
+    {
+        explicit message(int id) noexcept : value{ id } {}
+
+        int value;
+    };
+
+    std::vector<message> make_messages()
+    {
+        std::vector<message> messages{};
+        messages.reserve(messageCount);
+
+        for (int index = 0; index != messageCount; ++index)
+        {
+            messages.emplace_back(index);
+        }
+
+        return messages;
+    }
+
+    async::task<std::int64_t> receive_from_mailbox(async::mailbox<message>& mailbox)
+    {
+        std::int64_t sum{};
+        int received{};
+
+        while (received != messageCount)
+        {
+            async::mailbox_batch<message> batch{ co_await mailbox.receive_batch() };
+            received += static_cast<int>(batch.size());
+
+            while (message* popped{ batch.pop() })
+            {
+                sum += popped->value;
+            }
+        }
+
+        co_return sum;
+    }
+
+    std::int64_t run_mailbox(std::vector<message>& messages, int producerCount)
+    {
+        async::mailbox<message> mailbox{};
+        std::int64_t sum{};
+        std::thread consumer{ [&mailbox, &sum]() { sum = async::awaitable_get(receive_from_mailbox(mailbox)); } };
+        std::vector<std::thread> producers{};
+        const int perProducer{ messageCount / producerCount };
+
+        for (int producer = 0; producer != producerCount; ++producer)
+        {
+            producers.emplace_back(
+                [&mailbox, &messages, producer, perProducer]()
+                {
+                    for (int index = producer * perProducer; index != (producer + 1) * perProducer; ++index)
+                    {
+                        mailbox.post(messages[index]);
+                    }
+                });
+        }
+
+        for (std::thread& producer : producers)
+        {
+            producer.join();
+        }
+
+        consumer.join();
+        return sum;
+    }
+
+    // The alternative for callers that cannot await a send: a bounded mpmc_channel of pointers, with producers retrying
+    // try_send() while it is full, and the consumer receiving up to 64 at a time.
+    async::task<std::int64_t> receive_from_channel(async::mpmc_channel<message*>& channel)
+    {
+        std::int64_t sum{};
+        std::array<message*, 64> items{};
+
+        while (const std::size_t count{ co_await channel.receive_many(items) })
+        {
+            for (std::size_t index = 0; index != count; ++index)
+            {
+                sum += items[index]->value;
+            }
+        }
+
+        co_return sum;
+    }
+
+    std::int64_t run_channel(std::vector<message>& messages, int producerCount)
+    {
+        async::mpmc_channel<message*> channel{ 1024 };
+        std::int64_t sum{};
+        std::thread consumer{ [&channel, &sum]() { sum = async::awaitable_get(receive_from_channel(channel)); } };
+        std::vector<std::thread> producers{};
+        const int perProducer{ messageCount / producerCount };
+
+        for (int producer = 0; producer != producerCount; ++producer)
+        {
+            producers.emplace_back(
+                [&channel, &messages, producer, perProducer]()
+                {
+                    for (int index = producer * perProducer; index != (producer + 1) * perProducer; ++index)
+                    {
+                        message* posted{ &messages[index] };
+
+                        while (!channel.try_send(posted))
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
+                });
+        }
+
+        for (std::thread& producer : producers)
+        {
+            producer.join();
+        }
+
+        channel.close();
+        consumer.join();
+        return sum;
+    }
+}
+
+// Posts 1M messages from several threads to one consumer coroutine. Messages per second is 1M divided by the reported
+// time.
+TEST_CASE("mailbox compared with mpmc_channel", "[benchmark]")
+{
+    std::vector<message> messages{ make_messages() };
+
+    for (int producerCount = 1; producerCount <= 4; producerCount *= 2)
+    {
+        BENCHMARK("mailbox, " + std::to_string(producerCount) + " producers")
+        {
+            return run_mailbox(messages, producerCount);
+        };
+
+        BENCHMARK("mpmc_channel try_send, " + std::to_string(producerCount) + " producers")
+        {
+            return run_channel(messages, producerCount);
+        };
+    }
+}
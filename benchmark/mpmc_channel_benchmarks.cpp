@@ -0,0 +1,89 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/mpmc_channel.h"
+#include "async/task.h"
+
+namespace
+{
+    constexpr int messageCount{ 1 << 20 };
+    constexpr int consumerCount{ 2 };
+
+    async::task<void> send_messages(async::mpmc_channel<int>& channel, int count)
+    {
+        for (int index = 0; index != count; ++index)
+        {
+            co_await channel.send(index);
+        }
+    }
+
+    async::task<std::int64_t> receive_until_closed(async::mpmc_channel<int>& channel)
+    {
+        std::int64_t sum{};
+        std::array<int, 64> items{};
+
+        while (const std::size_t count{ co_await channel.receive_many(items) })
+        {
+            for (std::size_t index = 0; index != count; ++index)
+            {
+                sum += items[index];
+            }
+        }
+
+        co_return sum;
+    }
+
+    std::int64_t run(int producerCount)
+    {
+        async::mpmc_channel<int> channel{ 1024 };
+        std::atomic<std::int64_t> sum{};
+        std::vector<std::thread> consumers{};
+        std::vector<std::thread> producers{};
+
+        for (int index = 0; index != consumerCount; ++index)
+        {
+            consumers.emplace_back([&channel, &sum]() { sum += async::awaitable_get(receive_until_closed(channel)); });
+        }
+
+        for (int index = 0; index != producerCount; ++index)
+        {
+            producers.emplace_back([&channel, producerCount]()
+                { async::awaitable_get(send_messages(channel, messageCount / producerCount)); });
+        }
+
+        for (std::thread& producer : producers)
+        {
+            producer.join();
+        }
+
+        channel.close();
+
+        for (std::thread& consumer : consumers)
+        {
+            consumer.join();
+        }
+
+        return sum;
+    }
+}
+
+// Sends 1M ints in total from 1 to 32 producer threads to 2 consumer threads, which receive up to 64 items at a time;
+// messages per second is 1M divided by the reported time. Scaling depends on the number of cores available.
+TEST_CASE("mpmc_channel throughput", "[benchmark]")
+{
+    for (int producerCount = 1; producerCount <= 32; producerCount *= 2)
+    {
+        BENCHMARK("send 1M messages from " + std::to_string(producerCount) + " producers to 2 consumers")
+        {
+            return run(producerCount);
+        };
+    }
+}
@@ -0,0 +1,4 @@
+// © Microsoft Corporation. All rights reserved.
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
@@ -0,0 +1,40 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/reduce.h"
+#include "async/thread_pool.h"
+
+namespace
+{
+    std::int64_t sum(std::vector<int>::const_iterator first, std::vector<int>::const_iterator last)
+    {
+        return std::accumulate(first, last, std::int64_t{});
+    }
+
+    std::int64_t add(std::int64_t left, std::int64_t right) noexcept { return left + right; }
+}
+
+// Sums 100M ints (400 MB), so the work is bound by memory bandwidth; the speedup over a serial loop depends on the
+// number of cores (and memory channels) available.
+TEST_CASE("reduce() sum", "[benchmark]")
+{
+    constexpr std::size_t elementCount{ 100'000'000 };
+    constexpr std::size_t chunkSize{ 1'000'000 };
+    const std::vector<int> values(elementCount, 1);
+    async::thread_pool pool{};
+
+    BENCHMARK("sum 100M elements serially")
+    {
+        return sum(values.begin(), values.end());
+    };
+
+    BENCHMARK("sum 100M elements with reduce() in 1M-element chunks")
+    {
+        return async::awaitable_get(async::reduce(values, chunkSize, sum, add, pool.executor()));
+    };
+}
@@ -0,0 +1,124 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/mpmc_channel.h"
+#include "async/select.h"
+#include "async/task.h"
+#include "async/when_all.h"
+
+namespace
+{
+    constexpr int messageCount{ 1 << 20 };
+
+    // Sends messageCount messages on the data channel, and one on the control channel every 1024 messages.
+    void produce(async::mpmc_channel<int>& data, async::mpmc_channel<int>& control)
+    {
+        async::awaitable_get(
+            [](async::mpmc_channel<int>& data, async::mpmc_channel<int>& control) -> async::task<void>
+            {
+                for (int index = 0; index != messageCount; ++index)
+                {
+                    co_await data.send(index);
+
+                    if ((index & 1023) == 0)
+                    {
+                        co_await control.send(-1);
+                    }
+                }
+            }(data, control));
+
+        data.close();
+        control.close();
+    }
+
+    async::task<std::int64_t> consume_with_select(async::mpmc_channel<int>& data, async::mpmc_channel<int>& control)
+    {
+        std::int64_t sum{};
+        bool dataOpen{ true };
+
+        while (dataOpen)
+        {
+            auto result = co_await async::select(data.receive(), control.receive());
+
+            if (result.index() == 0)
+            {
+                if (const std::optional<int>& value{ std::get<0>(result) })
+                {
+                    sum += *value;
+                }
+                else
+                {
+                    dataOpen = false;
+                }
+            }
+        }
+
+        co_return sum;
+    }
+
+    async::task<void> forward(async::mpmc_channel<int>& source, async::mpmc_channel<int>& merged)
+    {
+        while (std::optional<int> value{ co_await source.receive() })
+        {
+            co_await merged.send(*value);
+        }
+    }
+
+    async::task<void> forward_both(
+        async::mpmc_channel<int>& data, async::mpmc_channel<int>& control, async::mpmc_channel<int>& merged)
+    {
+        co_await async::when_all(forward(data, merged), forward(control, merged));
+        merged.close();
+    }
+
+    // The workaround select replaces: a coroutine per source forwarding into a merged channel.
+    async::task<std::int64_t> consume_with_forwarding(
+        async::mpmc_channel<int>& data, async::mpmc_channel<int>& control)
+    {
+        async::mpmc_channel<int> merged{ 1024 };
+        async::task<void> forwarding{ forward_both(data, control, merged) };
+        std::int64_t sum{};
+
+        while (std::optional<int> value{ co_await merged.receive() })
+        {
+            if (*value >= 0)
+            {
+                sum += *value;
+            }
+        }
+
+        co_await std::move(forwarding);
+        co_return sum;
+    }
+
+    template <typename Consume>
+    std::int64_t run(Consume consume)
+    {
+        async::mpmc_channel<int> data{ 1024 };
+        async::mpmc_channel<int> control{ 16 };
+        std::thread producer{ [&data, &control]() { produce(data, control); } };
+        const std::int64_t sum{ async::awaitable_get(consume(data, control)) };
+        producer.join();
+        return sum;
+    }
+}
+
+// Receives 1M messages on a data channel (and 1K on a control channel) sent from another thread, either with select()
+// over both channels or with a forwarding coroutine per channel feeding a merged channel. Messages per second is 1M
+// divided by the reported time.
+TEST_CASE("select() compared with forwarding coroutines", "[benchmark]")
+{
+    BENCHMARK("select() over a data and a control channel")
+    {
+        return run(consume_with_select);
+    };
+
+    BENCHMARK("forwarding coroutines into a merged channel")
+    {
+        return run(consume_with_forwarding);
+    };
+}
@@ -0,0 +1,151 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/async_generator.h"
+#include "async/awaitable_get.h"
+#include "async/stream_operators.h"
+#include "async/task.h"
+#include "async/thread_pool.h"
+
+namespace
+{
+    constexpr int valueCount{ 10'000'000 };
+    constexpr std::size_t chunkSize{ 64 };
+
+    async::async_generator<int> generate_values(int count)
+    {
+        for (int value = 0; value != count; ++value)
+        {
+            co_yield value;
+        }
+    }
+
+    std::int64_t triple(int value) noexcept { return static_cast<std::int64_t>(value) * 3; }
+
+    bool is_even(std::int64_t value) noexcept { return (value & 1) == 0; }
+
+    std::int64_t increment(std::int64_t value) noexcept { return value + 1; }
+
+    std::int64_t sum_chunk(const std::vector<std::int64_t>& values) noexcept
+    {
+        std::int64_t total{};
+
+        for (std::int64_t value : values)
+        {
+            total += value;
+        }
+
+        return total;
+    }
+
+    // map, filter, map, chunk and map, fused into a single coroutine.
+    async::async_generator<std::int64_t> fused_pipeline(async::async_generator<int> source)
+    {
+        return std::move(source) | async::map(triple) | async::filter(is_even) | async::map(increment) |
+            async::chunk(chunkSize) | async::map(sum_chunk);
+    }
+
+    // The approach the operators replace: the same five stages written as a coroutine each.
+    async::async_generator<std::int64_t> triple_stage(async::async_generator<int> source)
+    {
+        while (int* value{ co_await source.next() })
+        {
+            co_yield triple(*value);
+        }
+    }
+
+    async::async_generator<std::int64_t> is_even_stage(async::async_generator<std::int64_t> source)
+    {
+        while (std::int64_t* value{ co_await source.next() })
+        {
+            if (is_even(*value))
+            {
+                co_yield *value;
+            }
+        }
+    }
+
+    async::async_generator<std::int64_t> increment_stage(async::async_generator<std::int64_t> source)
+    {
+        while (std::int64_t* value{ co_await source.next() })
+        {
+            co_yield increment(*value);
+        }
+    }
+
+    async::async_generator<std::vector<std::int64_t>> chunk_stage(async::async_generator<std::int64_t> source)
+    {
+        std::vector<std::int64_t> chunk{};
+
+        while (std::int64_t* value{ co_await source.next() })
+        {
+            if (chunk.empty())
+            {
+                chunk.reserve(chunkSize);
+            }
+
+            chunk.push_back(*value);
+
+            if (chunk.size() == chunkSize)
+            {
+                co_yield std::exchange(chunk, {});
+            }
+        }
+
+        if (!chunk.empty())
+        {
+            co_yield std::move(chunk);
+        }
+    }
+
+    async::async_generator<std::int64_t> sum_chunk_stage(async::async_generator<std::vector<std::int64_t>> source)
+    {
+        while (std::vector<std::int64_t>* value{ co_await source.next() })
+        {
+            co_yield sum_chunk(*value);
+        }
+    }
+
+    async::async_generator<std::int64_t> coroutine_per_stage_pipeline(async::async_generator<int> source)
+    {
+        return sum_chunk_stage(chunk_stage(increment_stage(is_even_stage(triple_stage(std::move(source))))));
+    }
+
+    async::task<std::int64_t> sum(async::async_generator<std::int64_t> generator)
+    {
+        std::int64_t total{};
+
+        while (std::int64_t* value{ co_await generator.next() })
+        {
+            total += *value;
+        }
+
+        co_return total;
+    }
+}
+
+// Runs 10M values through the same five stages (map, filter, map, chunk and map). Values per second is 10M divided by
+// the reported time.
+TEST_CASE("stream operators compared with a coroutine per stage", "[benchmark]")
+{
+    BENCHMARK("fused operators, 5 stages over 10M values")
+    {
+        return async::awaitable_get(sum(fused_pipeline(generate_values(valueCount))));
+    };
+
+    BENCHMARK("coroutine per stage, 5 stages over 10M values")
+    {
+        return async::awaitable_get(sum(coroutine_per_stage_pipeline(generate_values(valueCount))));
+    };
+
+    // The source runs ahead on a thread pool while the consumer's thread runs the stages.
+    BENCHMARK("fused operators after buffer(1024), 5 stages over 10M values")
+    {
+        async::async_generator<int> buffered{ generate_values(valueCount) |
+            async::buffer(1024, async::thread_pool::shared().executor()) };
+        return async::awaitable_get(sum(fused_pipeline(std::move(buffered))));
+    };
+}
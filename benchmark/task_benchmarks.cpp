@@ -0,0 +1,63 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/task.h"
+#include "async/task_completion_source.h"
+
+namespace
+{
+    async::task<std::int64_t> await_all(std::vector<async::task<int>>& tasks)
+    {
+        std::int64_t sum{};
+
+        for (async::task<int>& task : tasks)
+        {
+            sum += co_await std::move(task);
+        }
+
+        co_return sum;
+    }
+}
+
+// Each completion writes the task's result on the producer thread while the consumer thread polls (await_ready) and
+// then suspends on the same task state, so this measures the cross-thread cost of task_state's layout. To count
+// hardware cache misses per completion, run this benchmark under a profiler that reads CPU performance counters and
+// divide by the number of completions.
+TEST_CASE("task<T> completion on another thread", "[benchmark]")
+{
+    constexpr int completionCount{ 10000 };
+
+    BENCHMARK_ADVANCED("complete 10000 tasks awaited on another thread")(Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<std::vector<async::task_completion_source<int>>> promises{};
+        std::vector<std::vector<async::task<int>>> tasks(meter.runs());
+
+        for (int run = 0; run != meter.runs(); ++run)
+        {
+            promises.emplace_back(completionCount);
+
+            for (async::task_completion_source<int>& promise : promises.back())
+            {
+                tasks[run].push_back(promise.task());
+            }
+        }
+
+        meter.measure([&promises, &tasks](int run)
+            {
+                std::int64_t sum{};
+                std::thread consumer{ [&sum, &tasks, run]() { sum = async::awaitable_get(await_all(tasks[run])); } };
+
+                for (async::task_completion_source<int>& promise : promises[run])
+                {
+                    promise.set_value(1);
+                }
+
+                consumer.join();
+                return sum;
+            });
+    };
+}
@@ -0,0 +1,100 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <cstdint>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/task.h"
+#include "async/task_completion_source.h"
+#include "async/when_all.h"
+
+namespace
+{
+    async::task<std::int64_t> await_each(std::vector<async::task<int>> tasks)
+    {
+        std::int64_t sum{};
+
+        for (async::task<int>& task : tasks)
+        {
+            sum += co_await std::move(task);
+        }
+
+        co_return sum;
+    }
+
+    async::task<std::int64_t> await_when_all(std::vector<async::task<int>> tasks)
+    {
+        std::int64_t sum{};
+
+        for (int result : co_await async::when_all(std::move(tasks)))
+        {
+            sum += result;
+        }
+
+        co_return sum;
+    }
+
+    std::vector<async::task<int>> get_tasks(std::vector<async::task_completion_source<int>>& promises)
+    {
+        std::vector<async::task<int>> tasks{};
+        tasks.reserve(promises.size());
+
+        for (async::task_completion_source<int>& promise : promises)
+        {
+            tasks.push_back(promise.task());
+        }
+
+        return tasks;
+    }
+}
+
+// Fans in 10000 pending tasks, comparing when_all (one child frame per task and one shared counter) to awaiting each
+// task in turn (which resumes the awaiting coroutine once per task).
+TEST_CASE("when_all(range) fan-in", "[benchmark]")
+{
+    constexpr int taskCount{ 10000 };
+
+    BENCHMARK_ADVANCED("when_all of 10000 tasks")(Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<std::vector<async::task_completion_source<int>>> promises{};
+
+        for (int run = 0; run != meter.runs(); ++run)
+        {
+            promises.emplace_back(taskCount);
+        }
+
+        meter.measure([&promises](int run)
+            {
+                async::task<std::int64_t> sum{ await_when_all(get_tasks(promises[run])) };
+
+                for (async::task_completion_source<int>& promise : promises[run])
+                {
+                    promise.set_value(1);
+                }
+
+                return async::awaitable_get(std::move(sum));
+            });
+    };
+
+    BENCHMARK_ADVANCED("co_await each of 10000 tasks")(Catch::Benchmark::Chronometer meter)
+    {
+        std::vector<std::vector<async::task_completion_source<int>>> promises{};
+
+        for (int run = 0; run != meter.runs(); ++run)
+        {
+            promises.emplace_back(taskCount);
+        }
+
+        meter.measure([&promises](int run)
+            {
+                async::task<std::int64_t> sum{ await_each(get_tasks(promises[run])) };
+
+                for (async::task_completion_source<int>& promise : promises[run])
+                {
+                    promise.set_value(1);
+                }
+
+                return async::awaitable_get(std::move(sum));
+            });
+    };
+}
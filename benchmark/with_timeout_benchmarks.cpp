@@ -0,0 +1,49 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <chrono>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/task.h"
+#include "async/task_completion_source.h"
+#include "async/timer_service.h"
+#include "async/with_timeout.h"
+
+// Starts 100000 timeouts that are all pending at once (sharing one timer thread, which sleeps until the earliest
+// deadline rather than polling), then completes every awaitable before its deadline so each timeout is canceled. This
+// measures the cost of adding and removing timer heap entries; CPU use while the timeouts are merely pending is that of
+// one sleeping thread.
+TEST_CASE("with_timeout() with many pending timeouts", "[benchmark]")
+{
+    constexpr int timeoutCount{ 100000 };
+
+    BENCHMARK_ADVANCED("start and complete 100000 timeouts")(Catch::Benchmark::Chronometer meter)
+    {
+        async::timer_service timers{};
+        std::vector<std::vector<async::task_completion_source<int>>> promises{};
+
+        for (int run = 0; run != meter.runs(); ++run)
+        {
+            promises.emplace_back(timeoutCount);
+        }
+
+        meter.measure([&timers, &promises](int run)
+            {
+                std::vector<async::task<int>> tasks{};
+                tasks.reserve(promises[run].size());
+
+                for (async::task_completion_source<int>& promise : promises[run])
+                {
+                    tasks.push_back(async::with_timeout(promise.task(), std::chrono::minutes{ 1 }, timers));
+                }
+
+                const std::size_t pending{ timers.pending_count() };
+
+                for (async::task_completion_source<int>& promise : promises[run])
+                {
+                    promise.set_value(1);
+                }
+
+                return pending;
+            });
+    };
+}
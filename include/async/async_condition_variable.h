@@ -0,0 +1,170 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <coroutine>
+#include <mutex>
+#include <stdexcept>
+#include "async_mutex.h"
+#include "task.h"
+
+namespace async
+{
+    struct async_condition_variable;
+}
+
+namespace async::details
+{
+    struct async_condition_variable_wait_operation final
+    {
+        async_condition_variable_wait_operation(async_condition_variable& condition, async_mutex& mutex) noexcept :
+            m_condition{ condition }, m_waiter{ mutex }
+        {
+        }
+
+        [[nodiscard]] constexpr bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle);
+
+        constexpr void await_resume() const noexcept {}
+
+    private:
+        async_condition_variable& m_condition;
+        async_mutex_waiter m_waiter;
+    };
+}
+
+namespace async
+{
+    // A condition variable for coroutines holding an async_mutex. Waiting releases the mutex and suspends the coroutine
+    // without blocking a thread. Notifying moves waiters directly onto the mutex's queue of waiters, so a notified
+    // coroutine resumes only once it owns the mutex again (rather than waking up only to contend for the mutex).
+    // notify_one() and notify_all() may be called with or without holding the mutex.
+    struct async_condition_variable final
+    {
+        async_condition_variable() noexcept : m_mutex{}, m_head{}, m_tail{} {}
+
+        async_condition_variable(const async_condition_variable&) = delete;
+        async_condition_variable(async_condition_variable&&) noexcept = delete;
+
+        ~async_condition_variable() noexcept = default;
+
+        async_condition_variable& operator=(const async_condition_variable&) = delete;
+        async_condition_variable& operator=(async_condition_variable&&) noexcept = delete;
+
+        // co_await wait(lock) to release the mutex until notified; the mutex is owned by lock again upon resumption.
+        [[nodiscard]] details::async_condition_variable_wait_operation wait(async_mutex_lock& lock)
+        {
+            if (!lock.owns_lock())
+            {
+                throw std::runtime_error{ "async_condition_variable.wait() requires a lock that owns its mutex." };
+            }
+
+            return details::async_condition_variable_wait_operation{ *this, *lock.mutex() };
+        }
+
+        // co_await wait(lock, predicate) to wait until predicate() returns true. predicate is called only while the
+        // mutex is owned by lock.
+        template <typename Predicate>
+        [[nodiscard]] task<void> wait(async_mutex_lock& lock, Predicate predicate)
+        {
+            while (!predicate())
+            {
+                co_await wait(lock);
+            }
+        }
+
+        void notify_one()
+        {
+            details::async_mutex_waiter* waiter{};
+
+            {
+                std::lock_guard<std::mutex> mutexGuard{ m_mutex };
+                waiter = m_head;
+
+                if (waiter == nullptr)
+                {
+                    return;
+                }
+
+                m_head = waiter->next;
+
+                if (m_head == nullptr)
+                {
+                    m_tail = nullptr;
+                }
+            }
+
+            transfer_to_mutex(*waiter);
+        }
+
+        void notify_all()
+        {
+            details::async_mutex_waiter* waiter{};
+
+            {
+                std::lock_guard<std::mutex> mutexGuard{ m_mutex };
+                waiter = m_head;
+                m_head = nullptr;
+                m_tail = nullptr;
+            }
+
+            while (waiter != nullptr)
+            {
+                // Read next before transferring; once transferred, the waiter may be resumed and destroyed.
+                details::async_mutex_waiter* next{ waiter->next };
+                transfer_to_mutex(*waiter);
+                waiter = next;
+            }
+        }
+
+    private:
+        friend struct details::async_condition_variable_wait_operation;
+
+        void enqueue(details::async_mutex_waiter& waiter) noexcept
+        {
+            std::lock_guard<std::mutex> mutexGuard{ m_mutex };
+            waiter.next = nullptr;
+
+            if (m_tail == nullptr)
+            {
+                m_head = &waiter;
+            }
+            else
+            {
+                m_tail->next = &waiter;
+            }
+
+            m_tail = &waiter;
+        }
+
+        static void transfer_to_mutex(details::async_mutex_waiter& waiter)
+        {
+            // Usually the notifier holds the mutex, so the waiter is queued and resumed by the notifier's unlock().
+            // If the mutex is free, the waiter now owns it and can run immediately.
+            if (waiter.try_lock_or_enqueue())
+            {
+                waiter.handle.resume();
+            }
+        }
+
+        // Guards only the list of waiters below; never held while resuming a coroutine.
+        std::mutex m_mutex;
+        details::async_mutex_waiter* m_head;
+        details::async_mutex_waiter* m_tail;
+    };
+}
+
+namespace async::details
+{
+    inline void async_condition_variable_wait_operation::await_suspend(std::coroutine_handle<> handle)
+    {
+        m_waiter.handle = handle;
+        m_condition.enqueue(m_waiter);
+
+        // Once the mutex is unlocked, a notification may resume this coroutine (and destroy this operation) at any
+        // time, so this operation must not be accessed afterwards.
+        async_mutex& mutex{ m_waiter.mutex };
+        mutex.unlock();
+    }
+}
@@ -0,0 +1,186 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace async
+{
+    template <typename T>
+    struct async_generator;
+}
+
+namespace async::details
+{
+    template <typename T>
+    struct async_generator_promise;
+
+    // Suspends the generator after it yields (or completes) and transfers directly to the consumer waiting in next().
+    struct async_generator_yield_operation final
+    {
+        [[nodiscard]] constexpr bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        [[nodiscard]] std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+        {
+            return handle.promise().consumer;
+        }
+
+        constexpr void await_resume() const noexcept {}
+    };
+
+    // Holds a copy of a value yielded as a const lvalue (when T is not const), which lives in the generator's
+    // coroutine frame until the generator is resumed.
+    template <typename T>
+    struct async_generator_yield_copy_operation final
+    {
+        explicit async_generator_yield_copy_operation(const T& value) : m_value{ value } {}
+
+        [[nodiscard]] constexpr bool await_ready() const noexcept { return false; }
+
+        [[nodiscard]] std::coroutine_handle<> await_suspend(
+            std::coroutine_handle<async_generator_promise<T>> handle) noexcept
+        {
+            handle.promise().current = std::addressof(m_value);
+            return handle.promise().consumer;
+        }
+
+        constexpr void await_resume() const noexcept {}
+
+    private:
+        T m_value;
+    };
+
+    template <typename T>
+    struct async_generator_promise final
+    {
+        async_generator<T> get_return_object() noexcept;
+
+        constexpr std::suspend_always initial_suspend() const noexcept { return {}; }
+
+        async_generator_yield_operation final_suspend() noexcept
+        {
+            current = nullptr;
+            return {};
+        }
+
+        // A yielded value lives in the generator's coroutine frame until the generator is resumed (a temporary lasts
+        // until the end of its co_yield expression), so only its address is stored.
+        async_generator_yield_operation yield_value(T& value) noexcept
+        {
+            current = std::addressof(value);
+            return {};
+        }
+
+        async_generator_yield_operation yield_value(T&& value) noexcept
+        {
+            current = std::addressof(value);
+            return {};
+        }
+
+        template <typename U = T, typename = std::enable_if_t<!std::is_const_v<U>>>
+        async_generator_yield_copy_operation<T> yield_value(const U& value)
+        {
+            return async_generator_yield_copy_operation<T>{ value };
+        }
+
+        constexpr void return_void() const noexcept {}
+
+        void unhandled_exception() noexcept { exception = std::current_exception(); }
+
+        T* current{};
+        std::coroutine_handle<> consumer{};
+        std::exception_ptr exception{};
+    };
+
+    template <typename T>
+    struct async_generator_next_operation final
+    {
+        explicit async_generator_next_operation(std::coroutine_handle<async_generator_promise<T>> handle) noexcept :
+            m_handle{ handle }
+        {
+        }
+
+        [[nodiscard]] bool await_ready() const noexcept { return m_handle.done(); }
+
+        // Transfers directly to the generator, which transfers back when it yields or completes.
+        [[nodiscard]] std::coroutine_handle<> await_suspend(std::coroutine_handle<> handle) const noexcept
+        {
+            m_handle.promise().consumer = handle;
+            return m_handle;
+        }
+
+        [[nodiscard]] T* await_resume() const
+        {
+            async_generator_promise<T>& promise{ m_handle.promise() };
+
+            if (promise.exception)
+            {
+                std::rethrow_exception(std::exchange(promise.exception, nullptr));
+            }
+
+            return promise.current;
+        }
+
+    private:
+        std::coroutine_handle<async_generator_promise<T>> m_handle;
+    };
+}
+
+namespace async
+{
+    // A coroutine return type for producing a sequence of values asynchronously: the coroutine may both co_yield
+    // values and co_await other operations. The coroutine does not start until the first co_await next(), and each
+    // co_await next() runs it until its next co_yield (returning a pointer to the yielded value, valid until next() is
+    // called again) or until it completes (returning nullptr). Control transfers directly between the consumer and the
+    // generator in both directions (without nesting on the stack), and nothing is allocated per value; yielded values
+    // are not copied, except for const lvalues when T is not const.
+    // If the coroutine throws, co_await next() rethrows the exception (and then returns nullptr).
+    // The generator must not be destroyed while next() is outstanding.
+    template <typename T>
+    struct async_generator final
+    {
+        static_assert(!std::is_reference_v<T>, "async_generator<T> requires a non-reference value type.");
+
+        using promise_type = details::async_generator_promise<T>;
+
+        explicit async_generator(std::coroutine_handle<promise_type> handle) noexcept : m_handle{ handle } {}
+
+        async_generator(const async_generator&) = delete;
+
+        async_generator(async_generator&& other) noexcept : m_handle{ std::exchange(other.m_handle, {}) } {}
+
+        ~async_generator() noexcept
+        {
+            if (m_handle)
+            {
+                m_handle.destroy();
+            }
+        }
+
+        async_generator& operator=(const async_generator&) = delete;
+        async_generator& operator=(async_generator&&) noexcept = delete;
+
+        // co_await next() returns a pointer to the next value, or nullptr once the generator has completed.
+        [[nodiscard]] details::async_generator_next_operation<T> next() const noexcept
+        {
+            return details::async_generator_next_operation<T>{ m_handle };
+        }
+
+    private:
+        std::coroutine_handle<promise_type> m_handle;
+    };
+}
+
+namespace async::details
+{
+    template <typename T>
+    inline async_generator<T> async_generator_promise<T>::get_return_object() noexcept
+    {
+        return async_generator<T>{ std::coroutine_handle<async_generator_promise<T>>::from_promise(*this) };
+    }
+}
@@ -0,0 +1,193 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <cassert>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include "atomic_acq_rel.h"
+#include "awaitable_then.h"
+
+namespace async
+{
+    template <typename T>
+    struct async_lazy;
+}
+
+namespace async::details
+{
+    template <typename T>
+    struct async_lazy_operation final
+    {
+        explicit async_lazy_operation(async_lazy<T>& lazy) noexcept : m_lazy{ lazy }, m_next{}, m_handle{} {}
+
+        [[nodiscard]] bool await_ready() const noexcept { return m_lazy.is_ready(); }
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            m_handle = handle;
+            return m_lazy.try_enqueue(*this);
+        }
+
+        [[nodiscard]] const T& await_resume() const { return m_lazy.get(); }
+
+    private:
+        friend struct ::async::async_lazy<T>;
+
+        async_lazy<T>& m_lazy;
+        async_lazy_operation* m_next;
+        std::coroutine_handle<> m_handle;
+    };
+}
+
+namespace async
+{
+    // Runs a factory coroutine exactly once, the first time the async_lazy<T> is co_awaited, and provides its result
+    // (as a const T&) to any number of awaiters. Awaiters that arrive while the factory is running are resumed inline
+    // on the thread that completes the factory. Once the factory has completed, co_await does not suspend, and
+    // checking for completion is a single atomic load.
+    // If the factory throws, every co_await rethrows that exception.
+    template <typename T>
+    struct async_lazy final
+    {
+        static_assert(!std::is_void_v<T> && !std::is_reference_v<T>, "async_lazy<T> requires a non-void value type.");
+
+        // factory is called with no arguments and must return an awaitable whose result converts to T.
+        template <typename Factory>
+        explicit async_lazy(Factory factory) :
+            m_state{ not_started_state() },
+            m_start{ [factory = std::move(factory)](async_lazy& self) mutable { run(self, factory); } },
+            m_value{},
+            m_exception{}
+        {
+        }
+
+        async_lazy(const async_lazy&) = delete;
+        async_lazy(async_lazy&&) noexcept = delete;
+
+        ~async_lazy() noexcept
+        {
+            // The factory must not still be running.
+            assert(m_state.load() == not_started_state() || is_ready());
+        }
+
+        async_lazy& operator=(const async_lazy&) = delete;
+        async_lazy& operator=(async_lazy&&) noexcept = delete;
+
+        [[nodiscard]] details::async_lazy_operation<T> operator co_await() noexcept
+        {
+            return details::async_lazy_operation<T>{ *this };
+        }
+
+        [[nodiscard]] bool is_ready() const noexcept { return m_state.load() == ready_state(); }
+
+    private:
+        friend struct details::async_lazy_operation<T>;
+
+        template <typename Factory>
+        static details::then_task run(async_lazy& self, Factory& factory)
+        {
+            try
+            {
+                self.m_value.emplace(co_await factory());
+            }
+            catch (...)
+            {
+                self.m_exception = std::current_exception();
+            }
+
+            self.complete();
+        }
+
+        // Returns false if the factory has already completed (so the awaiter should not suspend).
+        [[nodiscard]] bool try_enqueue(details::async_lazy_operation<T>& operation) noexcept
+        {
+            void* currentState{ m_state.load() };
+
+            if (currentState == not_started_state() &&
+                m_state.compare_exchange_strong(currentState, running_no_waiters_state()))
+            {
+                // Only the first awaiter gets here; m_start is not accessed again after it is released.
+                std::function<void(async_lazy&)> start{ std::move(m_start) };
+                start(*this);
+                currentState = m_state.load();
+            }
+
+            while (true)
+            {
+                if (currentState == ready_state())
+                {
+                    return false;
+                }
+
+                assert(currentState != not_started_state());
+
+                // running_no_waiters_state() is nullptr, so the current state is also the correct next pointer.
+                operation.m_next = static_cast<details::async_lazy_operation<T>*>(currentState);
+
+                if (m_state.compare_exchange_weak(currentState, &operation))
+                {
+                    return true;
+                }
+            }
+        }
+
+        void complete() noexcept
+        {
+            void* waiters{ m_state.exchange(ready_state()) };
+            assert(waiters != not_started_state() && waiters != ready_state());
+
+            // Waiters were pushed in LIFO order; resume them in the order they arrived.
+            details::async_lazy_operation<T>* head{};
+            details::async_lazy_operation<T>* next{ static_cast<details::async_lazy_operation<T>*>(waiters) };
+
+            while (next != nullptr)
+            {
+                details::async_lazy_operation<T>* following{ next->m_next };
+                next->m_next = head;
+                head = next;
+                next = following;
+            }
+
+            while (head != nullptr)
+            {
+                // Read next before resuming; the resumed coroutine may destroy the operation.
+                details::async_lazy_operation<T>* following{ head->m_next };
+                head->m_handle.resume();
+                head = following;
+            }
+        }
+
+        [[nodiscard]] const T& get() const
+        {
+            if (m_exception)
+            {
+                std::rethrow_exception(m_exception);
+            }
+
+            return *m_value;
+        }
+
+        // Possible m_state values:
+        //   not_started_state(): the factory has not been started.
+        //   running_no_waiters_state() (nullptr): the factory is running, and no awaiters are waiting.
+        //   ready_state(): the factory has completed.
+        //   any other value: the factory is running, and the value is the most recently pushed async_lazy_operation.
+        [[nodiscard]] void* not_started_state() const noexcept { return const_cast<async_lazy*>(this); }
+
+        [[nodiscard]] constexpr void* running_no_waiters_state() const noexcept { return nullptr; }
+
+        [[nodiscard]] void* ready_state() const noexcept
+        {
+            return const_cast<std::optional<T>*>(std::addressof(m_value));
+        }
+
+        details::atomic_acq_rel<void*> m_state;
+        std::function<void(async_lazy&)> m_start;
+        std::optional<T> m_value;
+        std::exception_ptr m_exception;
+    };
+}
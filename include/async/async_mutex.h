@@ -0,0 +1,235 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <cassert>
+#include <coroutine>
+#include <mutex>
+#include <stdexcept>
+#include "atomic_acq_rel.h"
+
+namespace async
+{
+    struct async_mutex;
+}
+
+namespace async::details
+{
+    // A coroutine waiting to acquire an async_mutex. Ownership of the mutex is handed directly to the waiter when the
+    // current owner unlocks, so a resumed waiter never needs to retry acquiring the mutex.
+    struct async_mutex_waiter
+    {
+        explicit async_mutex_waiter(async_mutex& owner) noexcept : mutex{ owner }, next{}, handle{} {}
+
+        // Acquires the mutex if it is not locked; otherwise, queues this waiter to receive ownership of the mutex when
+        // it is unlocked. Returns true if the mutex was acquired immediately (in which case handle will not be resumed
+        // by the mutex).
+        [[nodiscard]] bool try_lock_or_enqueue() noexcept;
+
+        async_mutex& mutex;
+        async_mutex_waiter* next;
+        std::coroutine_handle<> handle;
+    };
+
+    struct async_mutex_lock_operation
+    {
+        explicit async_mutex_lock_operation(async_mutex& mutex) noexcept : m_waiter{ mutex } {}
+
+        [[nodiscard]] constexpr bool await_ready() const noexcept { return false; }
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            m_waiter.handle = handle;
+            return !m_waiter.try_lock_or_enqueue();
+        }
+
+        constexpr void await_resume() const noexcept {}
+
+    protected:
+        async_mutex_waiter m_waiter;
+    };
+
+    struct async_mutex_scoped_lock_operation;
+}
+
+namespace async
+{
+    // A mutex that suspends the awaiting coroutine, rather than blocking the calling thread, while the mutex is locked.
+    // Waiters acquire the mutex in FIFO order and are resumed inline on the thread that calls unlock().
+    struct async_mutex final
+    {
+        async_mutex() noexcept : m_state{ not_locked_state() }, m_waiters{} {}
+
+        async_mutex(const async_mutex&) = delete;
+        async_mutex(async_mutex&&) noexcept = delete;
+
+        ~async_mutex() noexcept
+        {
+            // The mutex must not be destroyed while it is locked or has waiters.
+            assert(m_state.load() == not_locked_state());
+            assert(m_waiters == nullptr);
+        }
+
+        async_mutex& operator=(const async_mutex&) = delete;
+        async_mutex& operator=(async_mutex&&) noexcept = delete;
+
+        [[nodiscard]] bool try_lock() noexcept
+        {
+            void* expected{ not_locked_state() };
+            return m_state.compare_exchange_strong(expected, locked_no_waiters_state());
+        }
+
+        // co_await lock_async() to acquire the mutex; the caller is responsible for calling unlock().
+        [[nodiscard]] details::async_mutex_lock_operation lock_async() noexcept
+        {
+            return details::async_mutex_lock_operation{ *this };
+        }
+
+        // co_await scoped_lock_async() to acquire the mutex as an async_mutex_lock, which unlocks on destruction.
+        [[nodiscard]] details::async_mutex_scoped_lock_operation scoped_lock_async() noexcept;
+
+        void unlock()
+        {
+            void* currentState{ m_state.load() };
+
+            if (currentState == not_locked_state())
+            {
+                throw std::runtime_error{ "async_mutex.unlock() may be called only when the mutex is locked." };
+            }
+
+            details::async_mutex_waiter* waitersHead{ m_waiters };
+
+            if (waitersHead == nullptr)
+            {
+                void* expected{ locked_no_waiters_state() };
+
+                if (m_state.compare_exchange_strong(expected, not_locked_state()))
+                {
+                    return;
+                }
+
+                // New waiters have been pushed onto m_state (in LIFO order). Take all of them and reverse them into
+                // FIFO order. Only the owner of the mutex touches m_waiters, so no further synchronization is needed.
+                void* newWaiters{ m_state.exchange(locked_no_waiters_state()) };
+                assert(newWaiters != locked_no_waiters_state() && newWaiters != not_locked_state());
+                details::async_mutex_waiter* next{ static_cast<details::async_mutex_waiter*>(newWaiters) };
+
+                do
+                {
+                    details::async_mutex_waiter* following{ next->next };
+                    next->next = waitersHead;
+                    waitersHead = next;
+                    next = following;
+                } while (next != nullptr);
+            }
+
+            // Hand ownership directly to the oldest waiter; the mutex stays locked.
+            m_waiters = waitersHead->next;
+            waitersHead->handle.resume();
+        }
+
+    private:
+        friend struct details::async_mutex_waiter;
+
+        // Possible m_state values:
+        //   not_locked_state(): the mutex is not locked.
+        //   locked_no_waiters_state() (nullptr): the mutex is locked, and no waiters have been pushed since the owner
+        //     last took the waiters.
+        //   any other value: the mutex is locked, and the value is the most recently pushed async_mutex_waiter.
+        [[nodiscard]] void* not_locked_state() const noexcept { return const_cast<async_mutex*>(this); }
+
+        [[nodiscard]] constexpr void* locked_no_waiters_state() const noexcept { return nullptr; }
+
+        details::atomic_acq_rel<void*> m_state;
+
+        // Waiters in FIFO order; accessed only by the current owner of the mutex.
+        details::async_mutex_waiter* m_waiters;
+    };
+
+    // Owns a locked async_mutex and unlocks it on destruction, like std::unique_lock.
+    struct async_mutex_lock final
+    {
+        async_mutex_lock(async_mutex& mutex, std::adopt_lock_t) noexcept : m_mutex{ &mutex } {}
+
+        async_mutex_lock(const async_mutex_lock&) = delete;
+
+        async_mutex_lock(async_mutex_lock&& other) noexcept : m_mutex{ other.m_mutex } { other.m_mutex = nullptr; }
+
+        ~async_mutex_lock()
+        {
+            if (m_mutex != nullptr)
+            {
+                m_mutex->unlock();
+            }
+        }
+
+        async_mutex_lock& operator=(const async_mutex_lock&) = delete;
+        async_mutex_lock& operator=(async_mutex_lock&&) noexcept = delete;
+
+        [[nodiscard]] async_mutex* mutex() const noexcept { return m_mutex; }
+
+        [[nodiscard]] bool owns_lock() const noexcept { return m_mutex != nullptr; }
+
+        void unlock()
+        {
+            if (m_mutex == nullptr)
+            {
+                throw std::runtime_error{ "async_mutex_lock.unlock() may be called only when the lock is owned." };
+            }
+
+            async_mutex* owned{ m_mutex };
+            m_mutex = nullptr;
+            owned->unlock();
+        }
+
+    private:
+        async_mutex* m_mutex;
+    };
+}
+
+namespace async::details
+{
+    inline bool async_mutex_waiter::try_lock_or_enqueue() noexcept
+    {
+        void* currentState{ mutex.m_state.load() };
+
+        while (true)
+        {
+            if (currentState == mutex.not_locked_state())
+            {
+                if (mutex.m_state.compare_exchange_weak(currentState, mutex.locked_no_waiters_state()))
+                {
+                    return true;
+                }
+            }
+            else
+            {
+                // locked_no_waiters_state() is nullptr, so the current state is also the correct next pointer.
+                next = static_cast<async_mutex_waiter*>(currentState);
+
+                if (mutex.m_state.compare_exchange_weak(currentState, this))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    struct async_mutex_scoped_lock_operation final : async_mutex_lock_operation
+    {
+        using async_mutex_lock_operation::async_mutex_lock_operation;
+
+        [[nodiscard]] async_mutex_lock await_resume() const noexcept
+        {
+            return async_mutex_lock{ m_waiter.mutex, std::adopt_lock };
+        }
+    };
+}
+
+namespace async
+{
+    inline details::async_mutex_scoped_lock_operation async_mutex::scoped_lock_async() noexcept
+    {
+        return details::async_mutex_scoped_lock_operation{ *this };
+    }
+}
@@ -0,0 +1,161 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <stdexcept>
+#include "atomic_acq_rel.h"
+#include "awaitable_get.h"
+
+namespace async
+{
+    struct async_wait_group;
+}
+
+namespace async::details
+{
+    struct async_wait_group_operation final
+    {
+        explicit async_wait_group_operation(async_wait_group& group) noexcept : m_group{ group }, m_next{}, m_handle{}
+        {
+        }
+
+        [[nodiscard]] bool await_ready() const noexcept;
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle) noexcept;
+
+        constexpr void await_resume() const noexcept {}
+
+    private:
+        friend struct ::async::async_wait_group;
+
+        async_wait_group& m_group;
+        async_wait_group_operation* m_next;
+        std::coroutine_handle<> m_handle;
+    };
+}
+
+namespace async
+{
+    // Tracks a number of outstanding operations (such as detached coroutines) and lets callers wait, asynchronously or
+    // by blocking, until all of them are done. Call add() before starting each operation and done() when it finishes.
+    // Waiters are resumed inline on the thread whose done() call brings the count to zero.
+    struct async_wait_group final
+    {
+        async_wait_group() noexcept : m_count{ 0 }, m_waiters{ nullptr } {}
+
+        async_wait_group(const async_wait_group&) = delete;
+        async_wait_group(async_wait_group&&) noexcept = delete;
+
+        ~async_wait_group() noexcept
+        {
+            // The wait group must not be destroyed while any waiters remain.
+            assert(m_waiters.load() == nullptr);
+        }
+
+        async_wait_group& operator=(const async_wait_group&) = delete;
+        async_wait_group& operator=(async_wait_group&&) noexcept = delete;
+
+        void add(std::ptrdiff_t count = 1)
+        {
+            if (count < 0)
+            {
+                throw std::invalid_argument{ "The count must not be negative." };
+            }
+
+            m_count.fetch_add(count);
+        }
+
+        void done()
+        {
+            const std::ptrdiff_t previousCount{ m_count.fetch_sub(1) };
+
+            if (previousCount <= 0)
+            {
+                m_count.fetch_add(1);
+                throw std::runtime_error{ "async_wait_group.done() may not be called more times than add()." };
+            }
+
+            if (previousCount == 1)
+            {
+                resume_waiters(m_waiters.exchange(nullptr), nullptr);
+            }
+        }
+
+        [[nodiscard]] std::ptrdiff_t count() const noexcept { return m_count.load(); }
+
+        // co_await wait_async() to suspend until the count reaches zero.
+        [[nodiscard]] details::async_wait_group_operation wait_async() noexcept
+        {
+            return details::async_wait_group_operation{ *this };
+        }
+
+        // Blocks the calling thread until the count reaches zero.
+        void wait() { awaitable_get(wait_async()); }
+
+    private:
+        friend struct details::async_wait_group_operation;
+
+        // Returns false if the count has already reached zero (so the awaiter should not suspend).
+        [[nodiscard]] bool try_enqueue(details::async_wait_group_operation& operation) noexcept
+        {
+            void* head{ m_waiters.load() };
+
+            do
+            {
+                operation.m_next = static_cast<details::async_wait_group_operation*>(head);
+            } while (!m_waiters.compare_exchange_weak(head, &operation));
+
+            if (m_count.load() != 0)
+            {
+                return true;
+            }
+
+            // The count reached zero, possibly before this operation was pushed (so the done() call that reached zero
+            // may have missed it). Resume whatever waiters remain; if this operation is among them, don't suspend.
+            return !resume_waiters(m_waiters.exchange(nullptr), &operation);
+        }
+
+        // Resumes every waiter in the list except self; returns true if self was in the list.
+        static bool resume_waiters(void* waiters, const details::async_wait_group_operation* self) noexcept
+        {
+            bool foundSelf{ false };
+            details::async_wait_group_operation* next{ static_cast<details::async_wait_group_operation*>(waiters) };
+
+            while (next != nullptr)
+            {
+                // Read next before resuming; the resumed coroutine may destroy the operation.
+                details::async_wait_group_operation* following{ next->m_next };
+
+                if (next == self)
+                {
+                    foundSelf = true;
+                }
+                else
+                {
+                    next->m_handle.resume();
+                }
+
+                next = following;
+            }
+
+            return foundSelf;
+        }
+
+        details::atomic_acq_rel<std::ptrdiff_t> m_count;
+        details::atomic_acq_rel<void*> m_waiters;
+    };
+}
+
+namespace async::details
+{
+    inline bool async_wait_group_operation::await_ready() const noexcept { return m_group.count() == 0; }
+
+    inline bool async_wait_group_operation::await_suspend(std::coroutine_handle<> handle) noexcept
+    {
+        m_handle = handle;
+        return m_group.try_enqueue(*this);
+    }
+}
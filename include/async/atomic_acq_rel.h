@@ -3,15 +3,34 @@
 #pragma once
 
 #include <atomic>
+#include <cstddef>
+#include <new>
 
 namespace async::details
 {
+#if defined(__cpp_lib_hardware_interference_size) && !defined(__GNUC__)
+    inline constexpr std::size_t cache_line_size{ std::hardware_destructive_interference_size };
+#else
+    // GCC provides std::hardware_destructive_interference_size but warns that its value may vary between compiler
+    // versions and flags (so it is not safe to use in a header); use the typical value instead.
+    inline constexpr std::size_t cache_line_size{ 64 };
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push)
+// structure was padded due to alignment specifier (intended for padded_atomic_acq_rel)
+#pragma warning(disable : 4324)
+#endif
+
     // Like std::atomic, but defaults to std::memory_order_acq_rel (or memory_order_acquire or memory_order_release,
     // as appropriate) rather than memory_order_seq_cst.
     // Does not include some parts of std::atomic not currently used by callers.
-    template <typename T>
-    struct atomic_acq_rel final
+    // Alignment may be increased (see padded_atomic_acq_rel) to keep the value on its own cache line.
+    template <typename T, std::size_t Alignment = alignof(std::atomic<T>)>
+    struct alignas(Alignment) atomic_acq_rel final
     {
+        static_assert(Alignment >= alignof(std::atomic<T>), "Alignment may not be less than that of std::atomic<T>.");
+
         constexpr atomic_acq_rel() noexcept = default;
 
         constexpr atomic_acq_rel(T desired) noexcept : m_value{ std::forward<T>(desired) } {}
@@ -83,7 +102,24 @@ namespace async::details
                 std::forward<T&>(expected), std::forward<T>(desired), std::memory_order_acq_rel);
         }
 
+        T fetch_add(T operand) noexcept { return m_value.fetch_add(operand, std::memory_order_acq_rel); }
+
+        T fetch_add(T operand) volatile noexcept { return m_value.fetch_add(operand, std::memory_order_acq_rel); }
+
+        T fetch_sub(T operand) noexcept { return m_value.fetch_sub(operand, std::memory_order_acq_rel); }
+
+        T fetch_sub(T operand) volatile noexcept { return m_value.fetch_sub(operand, std::memory_order_acq_rel); }
+
     private:
         std::atomic<T> m_value;
     };
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+    // An atomic_acq_rel aligned to (and occupying a whole multiple of) a cache line, for values written by one thread
+    // while other threads access neighboring data. Prevents false sharing at the cost of extra memory.
+    template <typename T>
+    using padded_atomic_acq_rel = atomic_acq_rel<T, cache_line_size>;
 }
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <iterator>
 #include <type_traits>
 #include <utility>
 
@@ -33,6 +34,31 @@ namespace async::details
     {
         using type = decltype(std::declval<co_await_t<T>>().await_resume());
     };
+
+    template <typename T, typename = std::void_t<>>
+    struct is_awaitable : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct is_awaitable<T, std::void_t<decltype(std::declval<co_await_t<T>>().await_resume())>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    inline constexpr bool is_awaitable_v = is_awaitable<T>::value;
+
+    template <typename T, typename = std::void_t<>>
+    struct is_awaitable_range : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct is_awaitable_range<T,
+        std::void_t<decltype(std::begin(std::declval<T&>())), decltype(std::end(std::declval<T&>()))>> :
+        std::bool_constant<!is_awaitable_v<T> && is_awaitable_v<decltype(*std::begin(std::declval<T&>()))>>
+    {
+    };
 }
 
 namespace async
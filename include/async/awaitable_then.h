@@ -4,8 +4,12 @@
 
 #include <coroutine>
 #include <exception>
+#include <functional>
+#include <type_traits>
+#include <utility>
 #include "awaitable_result.h"
 #include "awaitable_resume_t.h"
+#include "task.h"
 
 namespace async::details
 {
@@ -21,10 +25,38 @@ namespace async::details
         };
     };
 
+    // Used when no executor is given; the continuation runs inline wherever the awaitable completes.
+    struct inline_executor final
+    {
+    };
+
+    // Suspends the awaiting coroutine and passes it to executor to resume (for example, on a thread pool).
+    template <typename Executor>
+    struct executor_resume_operation final
+    {
+        explicit executor_resume_operation(Executor& executor) noexcept : m_executor{ executor } {}
+
+        [[nodiscard]] constexpr bool await_ready() const noexcept { return std::is_same_v<Executor, inline_executor>; }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            if constexpr (!std::is_same_v<Executor, inline_executor>)
+            {
+                std::invoke(m_executor, handle);
+            }
+        }
+
+        constexpr void await_resume() const noexcept {}
+
+    private:
+        Executor& m_executor;
+    };
+
     template <typename T, typename Awaitable, typename Continuation>
     struct then_task_factory final
     {
-        static then_task create(Awaitable awaitable, Continuation continuation)
+        template <typename Executor>
+        static then_task create(Awaitable awaitable, Executor executor, Continuation continuation)
         {
             Awaitable capturedAwaitable{ std::move(awaitable) };
             awaitable_result<T> result{};
@@ -38,6 +70,7 @@ namespace async::details
                 result.set_exception(std::current_exception());
             }
 
+            co_await executor_resume_operation<Executor>{ executor };
             continuation(std::move(result));
             co_return;
         }
@@ -46,7 +79,8 @@ namespace async::details
     template <typename Awaitable, typename Continuation>
     struct then_task_factory<void, Awaitable, Continuation> final
     {
-        static then_task create(Awaitable awaitable, Continuation continuation)
+        template <typename Executor>
+        static then_task create(Awaitable awaitable, Executor executor, Continuation continuation)
         {
             Awaitable capturedAwaitable{ std::move(awaitable) };
             std::exception_ptr exception{};
@@ -60,10 +94,131 @@ namespace async::details
                 exception = std::current_exception();
             }
 
+            co_await executor_resume_operation<Executor>{ executor };
             continuation(awaitable_result<void>{ exception });
             co_return;
         }
     };
+
+    // Calls first, then second with first's result (or with no arguments, if first returns void).
+    template <typename First, typename Second>
+    struct then_compose final
+    {
+        template <typename... Args>
+        decltype(auto) operator()(Args&&... args)
+        {
+            if constexpr (std::is_void_v<std::invoke_result_t<First&, Args...>>)
+            {
+                std::invoke(first, std::forward<Args>(args)...);
+                return std::invoke(second);
+            }
+            else
+            {
+                return std::invoke(second, std::invoke(first, std::forward<Args>(args)...));
+            }
+        }
+
+        First first;
+        Second second;
+    };
+
+    template <typename T, typename Fn>
+    struct then_invoke_result final
+    {
+        using type = std::invoke_result_t<Fn&, T>;
+    };
+
+    template <typename Fn>
+    struct then_invoke_result<void, Fn> final
+    {
+        using type = std::invoke_result_t<Fn&>;
+    };
+
+    template <typename T, typename Fn>
+    using then_invoke_result_t = typename then_invoke_result<T, Fn>::type;
+
+    // Holds an awaitable and the awaiter obtained from it (which is the awaitable itself unless it has an operator
+    // co_await).
+    template <typename Awaitable, bool = std::is_same_v<co_await_t<Awaitable>, Awaitable>>
+    struct then_awaiter_storage final
+    {
+        explicit then_awaiter_storage(Awaitable awaitable) : m_awaitable{ std::move(awaitable) } {}
+
+        [[nodiscard]] Awaitable& awaiter() noexcept { return m_awaitable; }
+
+    private:
+        Awaitable m_awaitable;
+    };
+
+    template <typename Awaitable>
+    struct then_awaiter_storage<Awaitable, false> final
+    {
+        explicit then_awaiter_storage(Awaitable awaitable) :
+            m_awaitable{ std::move(awaitable) }, m_awaiter{ get_awaiter(std::move(m_awaitable)) }
+        {
+        }
+
+        [[nodiscard]] co_await_t<Awaitable>& awaiter() noexcept { return m_awaiter; }
+
+    private:
+        static co_await_t<Awaitable> get_awaiter(Awaitable&& awaitable)
+        {
+            if constexpr (requires { std::move(awaitable).operator co_await(); })
+            {
+                return std::move(awaitable).operator co_await();
+            }
+            else
+            {
+                return operator co_await(std::move(awaitable));
+            }
+        }
+
+        Awaitable m_awaitable;
+        co_await_t<Awaitable> m_awaiter;
+    };
+
+    // Awaits a then_chain without an executor by forwarding to the awaitable's own awaiter and running the chain's
+    // steps in await_resume, so the chain needs no coroutine frame of its own.
+    template <typename Awaitable, typename Fn>
+    struct then_chain_awaiter final
+    {
+        using result_type = then_invoke_result_t<awaitable_resume_t<Awaitable>, Fn>;
+
+        then_chain_awaiter(Awaitable awaitable, Fn fn) : m_storage{ std::move(awaitable) }, m_fn{ std::move(fn) } {}
+
+        then_chain_awaiter(const then_chain_awaiter&) = delete;
+        then_chain_awaiter(then_chain_awaiter&&) noexcept = delete;
+
+        ~then_chain_awaiter() noexcept = default;
+
+        then_chain_awaiter& operator=(const then_chain_awaiter&) = delete;
+        then_chain_awaiter& operator=(then_chain_awaiter&&) noexcept = delete;
+
+        [[nodiscard]] bool await_ready() { return m_storage.awaiter().await_ready(); }
+
+        template <typename Promise>
+        decltype(auto) await_suspend(std::coroutine_handle<Promise> handle)
+        {
+            return m_storage.awaiter().await_suspend(handle);
+        }
+
+        result_type await_resume()
+        {
+            if constexpr (std::is_void_v<awaitable_resume_t<Awaitable>>)
+            {
+                m_storage.awaiter().await_resume();
+                return std::invoke(m_fn);
+            }
+            else
+            {
+                return std::invoke(m_fn, m_storage.awaiter().await_resume());
+            }
+        }
+
+    private:
+        then_awaiter_storage<Awaitable> m_storage;
+        Fn m_fn;
+    };
 }
 
 namespace async
@@ -73,6 +228,89 @@ namespace async
     {
         using T = awaitable_resume_t<Awaitable>;
 
-        details::then_task_factory<T, Awaitable, Continuation>::create(std::move(awaitable), continuation);
+        details::then_task_factory<T, Awaitable, Continuation>::create(
+            std::move(awaitable), details::inline_executor{}, continuation);
+    }
+
+    // Like awaitable_then(awaitable, continuation), but runs continuation on executor rather than inline wherever the
+    // awaitable completes. An executor is any object callable with a std::coroutine_handle<> that arranges for the
+    // handle to be resumed, for example by posting it to a thread pool's queue.
+    template <typename Awaitable, typename Executor, typename Continuation>
+    inline void awaitable_then(Awaitable awaitable, Executor executor, Continuation continuation)
+    {
+        using T = awaitable_resume_t<Awaitable>;
+
+        details::then_task_factory<T, Awaitable, Continuation>::create(
+            std::move(awaitable), std::move(executor), continuation);
+    }
+
+    // A chain of synchronous steps to run on the result of an awaitable, created by then(). Each step is called with
+    // the previous step's result (or the awaitable's result, for the first step). Adding a step with .then() composes
+    // it with the previous steps, so nothing is allocated per step: without an executor, the steps run in the frame
+    // of the coroutine that awaits the chain; with one, the chain allocates a single task. The chain starts when it is
+    // awaited. If the awaitable or any step throws, the remaining steps are skipped and co_await rethrows.
+    template <typename Awaitable, typename Executor, typename Fn>
+    struct then_chain final
+    {
+        using result_type = details::then_invoke_result_t<awaitable_resume_t<Awaitable>, Fn>;
+
+        then_chain(Awaitable awaitable, Executor executor, Fn fn) :
+            m_awaitable{ std::move(awaitable) }, m_executor{ std::move(executor) }, m_fn{ std::move(fn) }
+        {
+        }
+
+        template <typename Next>
+        [[nodiscard]] then_chain<Awaitable, Executor, details::then_compose<Fn, Next>> then(Next next) &&
+        {
+            return { std::move(m_awaitable), std::move(m_executor),
+                details::then_compose<Fn, Next>{ std::move(m_fn), std::move(next) } };
+        }
+
+        [[nodiscard]] auto operator co_await() &&
+        {
+            if constexpr (std::is_same_v<Executor, details::inline_executor>)
+            {
+                return details::then_chain_awaiter<Awaitable, Fn>{ std::move(m_awaitable), std::move(m_fn) };
+            }
+            else
+            {
+                return run(std::move(m_awaitable), std::move(m_executor), std::move(m_fn));
+            }
+        }
+
+    private:
+        static task<result_type> run(Awaitable awaitable, Executor executor, Fn fn)
+        {
+            if constexpr (std::is_void_v<awaitable_resume_t<Awaitable>>)
+            {
+                co_await std::move(awaitable);
+                co_await details::executor_resume_operation<Executor>{ executor };
+                co_return std::invoke(fn);
+            }
+            else
+            {
+                auto&& value{ co_await std::move(awaitable) };
+                co_await details::executor_resume_operation<Executor>{ executor };
+                co_return std::invoke(fn, std::forward<decltype(value)>(value));
+            }
+        }
+
+        Awaitable m_awaitable;
+        Executor m_executor;
+        Fn m_fn;
+    };
+
+    // Starts a chain of steps to run on the result of awaitable; see then_chain.
+    template <typename Awaitable, typename Fn>
+    [[nodiscard]] then_chain<Awaitable, details::inline_executor, Fn> then(Awaitable awaitable, Fn fn)
+    {
+        return { std::move(awaitable), details::inline_executor{}, std::move(fn) };
+    }
+
+    // Like then(awaitable, fn), but runs the chain's steps on executor (see awaitable_then).
+    template <typename Awaitable, typename Executor, typename Fn>
+    [[nodiscard]] then_chain<Awaitable, Executor, Fn> then(Awaitable awaitable, Executor executor, Fn fn)
+    {
+        return { std::move(awaitable), std::move(executor), std::move(fn) };
     }
 }
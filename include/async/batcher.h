@@ -0,0 +1,369 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "atomic_acq_rel.h"
+#include "awaitable_result.h"
+#include "awaitable_then.h"
+#include "task.h"
+#include "task_canceled.h"
+#include "timer_service.h"
+
+namespace async::details
+{
+    template <typename Item, typename Result>
+    struct batcher_state;
+
+    // Lives in the awaiting coroutine's frame and holds that caller's item and result, so submitting an item allocates
+    // nothing; pending operations form an intrusive FIFO list.
+    template <typename Item, typename Result>
+    struct batcher_submit_operation final
+    {
+        batcher_submit_operation(batcher_state<Item, Result>& state, Item item) noexcept :
+            m_state{ state }, m_item{ std::move(item) }, m_result{}, m_remaining{ 2 }, m_next{}, m_handle{}
+        {
+        }
+
+        batcher_submit_operation(const batcher_submit_operation&) = delete;
+
+        // The operation may be moved only before it is awaited.
+        batcher_submit_operation(batcher_submit_operation&& other) noexcept :
+            batcher_submit_operation{ other.m_state, std::move(other.m_item) }
+        {
+        }
+
+        ~batcher_submit_operation() noexcept = default;
+
+        batcher_submit_operation& operator=(const batcher_submit_operation&) = delete;
+        batcher_submit_operation& operator=(batcher_submit_operation&&) noexcept = delete;
+
+        [[nodiscard]] constexpr bool await_ready() const noexcept { return false; }
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle)
+        {
+            m_handle = handle;
+            m_state.enqueue(*this);
+
+            // If this submission filled the batch, the batch may already have completed (on this thread) by now.
+            return m_remaining.fetch_sub(1) > 1;
+        }
+
+        [[nodiscard]] Result await_resume() { return m_result(); }
+
+    private:
+        friend struct batcher_state<Item, Result>;
+
+        // Called once, by the batch that contained this operation, after m_result has been set.
+        void complete() noexcept
+        {
+            if (m_remaining.fetch_sub(1) == 1)
+            {
+                m_handle.resume();
+            }
+        }
+
+        batcher_state<Item, Result>& m_state;
+        Item m_item;
+        awaitable_result<Result> m_result;
+        atomic_acq_rel<int> m_remaining;
+        batcher_submit_operation* m_next;
+        std::coroutine_handle<> m_handle;
+    };
+
+    // Shared by the batcher and its running batch and timer coroutines, so they may finish after the batcher itself is
+    // destroyed.
+    template <typename Item, typename Result>
+    struct batcher_state final : std::enable_shared_from_this<batcher_state<Item, Result>>
+    {
+        using operation = batcher_submit_operation<Item, Result>;
+        using batch_function = std::function<task<std::vector<Result>>(std::vector<Item>)>;
+
+        batcher_state(std::size_t maxBatchSize, std::chrono::microseconds maxDelay, batch_function batchFunction,
+            timer_service& timers) :
+            m_maxBatchSize{ maxBatchSize },
+            m_maxDelay{ maxDelay },
+            m_batchFunction{ std::move(batchFunction) },
+            m_timers{ timers },
+            m_mutex{},
+            m_head{},
+            m_tail{},
+            m_count{},
+            m_generation{},
+            m_timerStopSource{ std::nostopstate }
+        {
+        }
+
+        batcher_state(const batcher_state&) = delete;
+        batcher_state(batcher_state&&) noexcept = delete;
+
+        ~batcher_state() noexcept = default;
+
+        batcher_state& operator=(const batcher_state&) = delete;
+        batcher_state& operator=(batcher_state&&) noexcept = delete;
+
+        void enqueue(operation& submitted)
+        {
+            operation* batch{};
+            std::size_t batchSize{};
+            std::stop_source timerStopSource{ std::nostopstate };
+            bool startTimer{};
+            std::uint64_t generation{};
+
+            {
+                std::lock_guard<std::mutex> mutexLock{ m_mutex };
+
+                if (m_tail == nullptr)
+                {
+                    m_head = &submitted;
+                }
+                else
+                {
+                    m_tail->m_next = &submitted;
+                }
+
+                m_tail = &submitted;
+                ++m_count;
+
+                if (m_count == m_maxBatchSize)
+                {
+                    batchSize = m_count;
+                    batch = take_batch(timerStopSource);
+                }
+                else if (m_count == 1)
+                {
+                    // The first item of a new batch starts its timer.
+                    m_timerStopSource = std::stop_source{};
+                    timerStopSource = m_timerStopSource;
+                    generation = m_generation;
+                    startTimer = true;
+                }
+            }
+
+            if (batch != nullptr)
+            {
+                // A full batch no longer needs its timer.
+                timerStopSource.request_stop();
+                run_batch(this->shared_from_this(), batch, batchSize);
+            }
+            else if (startTimer)
+            {
+                run_timer(this->shared_from_this(), generation, timerStopSource.get_token());
+            }
+        }
+
+        void flush()
+        {
+            operation* batch{};
+            std::size_t batchSize{};
+            std::stop_source timerStopSource{ std::nostopstate };
+
+            {
+                std::lock_guard<std::mutex> mutexLock{ m_mutex };
+                batchSize = m_count;
+                batch = take_batch(timerStopSource);
+            }
+
+            timerStopSource.request_stop();
+
+            if (batch != nullptr)
+            {
+                run_batch(this->shared_from_this(), batch, batchSize);
+            }
+        }
+
+        void cancel_timer()
+        {
+            std::stop_source timerStopSource{ std::nostopstate };
+
+            {
+                std::lock_guard<std::mutex> mutexLock{ m_mutex };
+                timerStopSource = std::exchange(m_timerStopSource, std::stop_source{ std::nostopstate });
+            }
+
+            timerStopSource.request_stop();
+        }
+
+    private:
+        // Called with m_mutex held; detaches the pending batch (if any) and its timer.
+        [[nodiscard]] operation* take_batch(std::stop_source& timerStopSource) noexcept
+        {
+            operation* batch{ m_head };
+            m_head = nullptr;
+            m_tail = nullptr;
+            m_count = 0;
+            ++m_generation;
+            timerStopSource = std::exchange(m_timerStopSource, std::stop_source{ std::nostopstate });
+            return batch;
+        }
+
+        void flush_generation(std::uint64_t generation)
+        {
+            operation* batch{};
+            std::size_t batchSize{};
+            std::stop_source timerStopSource{ std::nostopstate };
+
+            {
+                std::lock_guard<std::mutex> mutexLock{ m_mutex };
+
+                // The batch this timer was started for may already have been flushed because it filled up.
+                if (generation != m_generation)
+                {
+                    return;
+                }
+
+                batchSize = m_count;
+                batch = take_batch(timerStopSource);
+            }
+
+            if (batch != nullptr)
+            {
+                run_batch(this->shared_from_this(), batch, batchSize);
+            }
+        }
+
+        static then_task run_timer(
+            std::shared_ptr<batcher_state> self, std::uint64_t generation, std::stop_token stopToken)
+        {
+            try
+            {
+                co_await self->m_timers.wait_for(self->m_maxDelay, std::move(stopToken));
+            }
+            catch (const task_canceled&)
+            {
+                co_return;
+            }
+
+            self->flush_generation(generation);
+        }
+
+        static then_task run_batch(std::shared_ptr<batcher_state> self, operation* batch, std::size_t batchSize)
+        {
+            std::vector<Item> items{};
+            items.reserve(batchSize);
+
+            for (operation* current = batch; current != nullptr; current = current->m_next)
+            {
+                items.push_back(std::move(current->m_item));
+            }
+
+            std::vector<Result> results{};
+            std::exception_ptr exception{};
+
+            try
+            {
+                results = co_await self->m_batchFunction(std::move(items));
+
+                if (results.size() != batchSize)
+                {
+                    throw std::runtime_error{ "The batch function must return exactly one result per item." };
+                }
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+
+            std::size_t index{};
+
+            while (batch != nullptr)
+            {
+                // Read next before completing; the resumed coroutine may destroy the operation.
+                operation* next{ batch->m_next };
+
+                if (exception)
+                {
+                    batch->m_result.set_exception(exception);
+                }
+                else
+                {
+                    batch->m_result.set_value(std::move(results[index]));
+                }
+
+                batch->complete();
+                batch = next;
+                ++index;
+            }
+        }
+
+        const std::size_t m_maxBatchSize;
+        const std::chrono::microseconds m_maxDelay;
+        const batch_function m_batchFunction;
+        timer_service& m_timers;
+        std::mutex m_mutex;
+        operation* m_head;
+        operation* m_tail;
+        std::size_t m_count;
+        std::uint64_t m_generation;
+        std::stop_source m_timerStopSource;
+    };
+}
+
+namespace async
+{
+    // Coalesces individual submissions into batches: co_await submit(item) adds item to the pending batch, which is
+    // passed to the batch function once it holds maxBatchSize items or maxDelay after its first item was submitted,
+    // whichever comes first. The batch function receives the items in submission order and must return one result per
+    // item, in the same order; each submitter is resumed with its own result (or the exception thrown by the batch
+    // function). Submitting allocates nothing per item (the item and its result are held in the awaiting coroutine's
+    // frame); each batch allocates its vector of items and a timer wait on timers.
+    // A batch that fills up runs inline on the thread that submitted its last item; a batch that times out runs on the
+    // timer thread. The batcher must not be destroyed while submissions are pending.
+    template <typename Item, typename Result>
+    struct batcher final
+    {
+        static_assert(
+            !std::is_void_v<Result> && !std::is_reference_v<Result>, "batcher requires a non-void result type.");
+
+        using batch_function = typename details::batcher_state<Item, Result>::batch_function;
+
+        batcher(std::size_t maxBatchSize, std::chrono::microseconds maxDelay, batch_function batchFunction,
+            timer_service& timers = timer_service::shared()) :
+            m_state{ create_state(maxBatchSize, maxDelay, std::move(batchFunction), timers) }
+        {
+        }
+
+        batcher(const batcher&) = delete;
+        batcher(batcher&&) noexcept = delete;
+
+        ~batcher() noexcept { m_state->cancel_timer(); }
+
+        batcher& operator=(const batcher&) = delete;
+        batcher& operator=(batcher&&) noexcept = delete;
+
+        [[nodiscard]] details::batcher_submit_operation<Item, Result> submit(Item item) noexcept
+        {
+            return details::batcher_submit_operation<Item, Result>{ *m_state, std::move(item) };
+        }
+
+        // Passes the pending batch (if any) to the batch function now.
+        void flush() { m_state->flush(); }
+
+    private:
+        static std::shared_ptr<details::batcher_state<Item, Result>> create_state(std::size_t maxBatchSize,
+            std::chrono::microseconds maxDelay, batch_function batchFunction, timer_service& timers)
+        {
+            if (maxBatchSize == 0)
+            {
+                throw std::invalid_argument{ "The maximum batch size must not be zero." };
+            }
+
+            return std::make_shared<details::batcher_state<Item, Result>>(
+                maxBatchSize, maxDelay, std::move(batchFunction), timers);
+        }
+
+        std::shared_ptr<details::batcher_state<Item, Result>> m_state;
+    };
+}
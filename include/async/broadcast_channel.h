@@ -0,0 +1,373 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <utility>
+#include "atomic_acq_rel.h"
+
+namespace async
+{
+    template <typename T>
+    struct broadcast_channel;
+
+    template <typename T>
+    struct broadcast_subscriber;
+
+    // What a subscriber's receive() does when the subscriber has fallen so far behind that items it had not yet
+    // received were overwritten.
+    enum class broadcast_lag_policy
+    {
+        // Skip to the oldest item still in the channel.
+        drop_oldest,
+
+        // Skip to the oldest item still in the channel, and throw broadcast_overflow first.
+        report_overflow
+    };
+
+    // Thrown by a subscriber's co_await receive() (with broadcast_lag_policy::report_overflow) when items it had not
+    // yet received were overwritten. The next receive() returns the oldest item still in the channel.
+    struct broadcast_overflow final : std::exception
+    {
+        explicit broadcast_overflow(std::uint64_t skipped) noexcept : m_skipped{ skipped } {}
+
+        [[nodiscard]] const char* what() const noexcept override { return "broadcast subscriber overflowed"; }
+
+        // The number of items the subscriber missed.
+        [[nodiscard]] std::uint64_t skipped() const noexcept { return m_skipped; }
+
+    private:
+        std::uint64_t m_skipped;
+    };
+}
+
+namespace async::details
+{
+    // The slot for position p holds the item sent at p (and sequence is p) until the producer overwrites it with the
+    // item sent at p + capacity. Subscribers copy the item under a shared lock.
+    template <typename T>
+    struct broadcast_channel_slot final
+    {
+        std::shared_mutex mutex;
+        std::uint64_t sequence{};
+        std::optional<T> value{};
+    };
+
+    struct broadcast_channel_waiter final
+    {
+        std::uint64_t position{};
+        broadcast_channel_waiter* next{};
+        std::coroutine_handle<> handle{};
+    };
+
+    template <typename T>
+    struct broadcast_receive_operation final
+    {
+        explicit broadcast_receive_operation(broadcast_subscriber<T>& subscriber) noexcept :
+            m_subscriber{ subscriber }, m_waiter{}
+        {
+        }
+
+        [[nodiscard]] bool await_ready() const noexcept;
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle);
+
+        // Returns the next item, or nullopt if the channel was closed and the subscriber has received every item.
+        [[nodiscard]] std::optional<T> await_resume();
+
+    private:
+        broadcast_subscriber<T>& m_subscriber;
+        broadcast_channel_waiter m_waiter;
+    };
+}
+
+namespace async
+{
+    // A channel from a single producer to any number of subscribers, each of which receives every item sent after it
+    // subscribed. Items are stored once, in a ring buffer shared by every subscriber (so memory does not grow with the
+    // number of subscribers); each subscriber keeps its own position in the ring, and co_await receive() suspends only
+    // when the subscriber has received every item sent so far. send() never waits: once the ring is full, it
+    // overwrites the oldest item, so a slow subscriber cannot stall the producer. A subscriber that falls more than
+    // capacity() items behind skips to the oldest item still in the channel, as the lag policy specifies.
+    // Waiting subscribers are resumed inline on the producer's thread (by send() or close()). After close(), receives
+    // return the items still in the channel and then nullopt.
+    // send() and close() may be called only by a single producer; each subscriber may be used by only one coroutine
+    // at a time, and every subscriber must be destroyed before the channel.
+    template <typename T>
+    struct broadcast_channel final
+    {
+        explicit broadcast_channel(
+            std::size_t capacity, broadcast_lag_policy lagPolicy = broadcast_lag_policy::drop_oldest) :
+            m_mask{ capacity - 1 }, m_lagPolicy{ lagPolicy }, m_slots{}, m_tail{ 0 }, m_waitingCount{ 0 }, m_mutex{},
+            m_closed{ false }, m_waiters{}
+        {
+            if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+            {
+                throw std::invalid_argument{ "The capacity must be a power of two." };
+            }
+
+            m_slots = std::make_unique<details::broadcast_channel_slot<T>[]>(capacity);
+        }
+
+        broadcast_channel(const broadcast_channel&) = delete;
+        broadcast_channel(broadcast_channel&&) noexcept = delete;
+
+        ~broadcast_channel() noexcept
+        {
+            // The channel must not be destroyed while any coroutines are waiting.
+            assert(m_waiters == nullptr);
+        }
+
+        broadcast_channel& operator=(const broadcast_channel&) = delete;
+        broadcast_channel& operator=(broadcast_channel&&) noexcept = delete;
+
+        [[nodiscard]] std::size_t capacity() const noexcept { return m_mask + 1; }
+
+        // Returns a subscriber that receives every item sent from now on.
+        [[nodiscard]] broadcast_subscriber<T> subscribe() noexcept { return broadcast_subscriber<T>{ *this }; }
+
+        // Stores value in the ring (overwriting the oldest item once the ring is full) and resumes every waiting
+        // subscriber. Must not be called after close().
+        void send(T value)
+        {
+            const std::uint64_t position{ m_tail.load() };
+            details::broadcast_channel_slot<T>& slot{ slot_at(position) };
+
+            {
+                std::unique_lock<std::shared_mutex> slotLock{ slot.mutex };
+                slot.value = std::move(value);
+                slot.sequence = position;
+
+                // Publishing the new tail under the slot's lock means a subscriber that finds the slot overwritten
+                // also sees a tail that accounts for the overwrite.
+                m_tail = position + 1;
+            }
+
+            resume_waiters();
+        }
+
+        void close()
+        {
+            details::broadcast_channel_waiter* waiters{};
+
+            {
+                std::lock_guard<std::mutex> mutexLock{ m_mutex };
+                m_closed = true;
+                waiters = std::exchange(m_waiters, nullptr);
+                m_waitingCount = 0;
+            }
+
+            resume_all(waiters);
+        }
+
+    private:
+        friend struct broadcast_subscriber<T>;
+        friend struct details::broadcast_receive_operation<T>;
+
+        [[nodiscard]] details::broadcast_channel_slot<T>& slot_at(std::uint64_t position) const noexcept
+        {
+            return m_slots[static_cast<std::size_t>(position & m_mask)];
+        }
+
+        // Returns false if the waiter did not need to be queued (because an item was sent after position or the
+        // channel was closed).
+        [[nodiscard]] bool try_enqueue(details::broadcast_channel_waiter& waiter, std::uint64_t position)
+        {
+            std::lock_guard<std::mutex> mutexLock{ m_mutex };
+
+            if (m_closed.load())
+            {
+                return false;
+            }
+
+            // The producer advances the tail before checking m_waitingCount, and this subscriber counted itself before
+            // checking the tail again, so at least one side sees the other.
+            m_waitingCount.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (m_tail.load() != position)
+            {
+                m_waitingCount.fetch_sub(1);
+                return false;
+            }
+
+            waiter.position = position;
+            waiter.next = m_waiters;
+            m_waiters = &waiter;
+            return true;
+        }
+
+        void resume_waiters()
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (m_waitingCount.load() == 0)
+            {
+                return;
+            }
+
+            details::broadcast_channel_waiter* ready{};
+
+            {
+                std::lock_guard<std::mutex> mutexLock{ m_mutex };
+
+                // A subscriber may have caught up with this item and queued itself after the tail was advanced; it
+                // stays queued for the next item. (The tail cannot change meanwhile; only this producer advances it.)
+                const std::uint64_t tail{ m_tail.load() };
+                details::broadcast_channel_waiter* waiter{ std::exchange(m_waiters, nullptr) };
+                std::size_t remaining{};
+
+                while (waiter != nullptr)
+                {
+                    details::broadcast_channel_waiter* const following{ waiter->next };
+
+                    if (waiter->position == tail)
+                    {
+                        waiter->next = m_waiters;
+                        m_waiters = waiter;
+                        ++remaining;
+                    }
+                    else
+                    {
+                        waiter->next = ready;
+                        ready = waiter;
+                    }
+
+                    waiter = following;
+                }
+
+                m_waitingCount = remaining;
+            }
+
+            resume_all(ready);
+        }
+
+        static void resume_all(details::broadcast_channel_waiter* waiter) noexcept
+        {
+            while (waiter != nullptr)
+            {
+                // Read next before resuming; the resumed coroutine may destroy the waiter.
+                details::broadcast_channel_waiter* const following{ waiter->next };
+                waiter->handle.resume();
+                waiter = following;
+            }
+        }
+
+        const std::size_t m_mask;
+        const broadcast_lag_policy m_lagPolicy;
+        std::unique_ptr<details::broadcast_channel_slot<T>[]> m_slots;
+
+        // The position of the next item to send; it increases without wrapping in practice (it is 64-bit) and is
+        // masked to find a slot. It and the waiter count that every send polls are each kept on their own cache line.
+        details::padded_atomic_acq_rel<std::uint64_t> m_tail;
+        details::padded_atomic_acq_rel<std::size_t> m_waitingCount;
+
+        // Guards the waiter list, which is used only by subscribers that have received every item (or when closing).
+        std::mutex m_mutex;
+        details::atomic_acq_rel<bool> m_closed;
+        details::broadcast_channel_waiter* m_waiters;
+    };
+
+    // A subscriber's position in a broadcast_channel; see broadcast_channel<T>.
+    template <typename T>
+    struct broadcast_subscriber final
+    {
+        broadcast_subscriber(const broadcast_subscriber&) = delete;
+        broadcast_subscriber(broadcast_subscriber&&) noexcept = default;
+
+        ~broadcast_subscriber() noexcept = default;
+
+        broadcast_subscriber& operator=(const broadcast_subscriber&) = delete;
+        broadcast_subscriber& operator=(broadcast_subscriber&&) noexcept = default;
+
+        // co_await receive() returns a copy of the next item, or nullopt if the channel was closed and every item has
+        // been received.
+        [[nodiscard]] details::broadcast_receive_operation<T> receive() noexcept
+        {
+            return details::broadcast_receive_operation<T>{ *this };
+        }
+
+    private:
+        friend struct broadcast_channel<T>;
+        friend struct details::broadcast_receive_operation<T>;
+
+        explicit broadcast_subscriber(broadcast_channel<T>& channel) noexcept :
+            m_channel{ &channel }, m_position{ channel.m_tail.load() }
+        {
+        }
+
+        [[nodiscard]] bool ready() const noexcept
+        {
+            return m_channel->m_tail.load() != m_position || m_channel->m_closed.load();
+        }
+
+        [[nodiscard]] std::optional<T> read()
+        {
+            while (m_channel->m_tail.load() != m_position)
+            {
+                details::broadcast_channel_slot<T>& slot{ m_channel->slot_at(m_position) };
+                std::uint64_t oldest{};
+
+                {
+                    std::shared_lock<std::shared_mutex> slotLock{ slot.mutex };
+
+                    if (slot.sequence == m_position)
+                    {
+                        std::optional<T> value{ slot.value };
+                        ++m_position;
+                        return value;
+                    }
+
+                    // The item was overwritten; the tail read under the slot's lock includes the overwrite.
+                    oldest = m_channel->m_tail.load() - m_channel->capacity();
+                }
+
+                const std::uint64_t skipped{ oldest - m_position };
+                m_position = oldest;
+
+                if (m_channel->m_lagPolicy == broadcast_lag_policy::report_overflow)
+                {
+                    throw broadcast_overflow{ skipped };
+                }
+            }
+
+            return std::nullopt;
+        }
+
+        broadcast_channel<T>* m_channel;
+
+        // The position of the next item to receive.
+        std::uint64_t m_position;
+    };
+}
+
+namespace async::details
+{
+    template <typename T>
+    inline bool broadcast_receive_operation<T>::await_ready() const noexcept
+    {
+        return m_subscriber.ready();
+    }
+
+    template <typename T>
+    inline bool broadcast_receive_operation<T>::await_suspend(std::coroutine_handle<> handle)
+    {
+        m_waiter.handle = handle;
+        return m_subscriber.m_channel->try_enqueue(m_waiter, m_subscriber.m_position);
+    }
+
+    template <typename T>
+    inline std::optional<T> broadcast_receive_operation<T>::await_resume()
+    {
+        return m_subscriber.read();
+    }
+}
@@ -0,0 +1,351 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <bit>
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include "atomic_acq_rel.h"
+#include "mpmc_channel.h"
+
+namespace async
+{
+    struct buffer_channel;
+    struct buffer_slab;
+    struct buffer_view;
+}
+
+namespace async::details
+{
+    struct buffer_channel_slab_header final
+    {
+        // The number of buffer_views sharing the slab (or 1 while a buffer_slab owns it).
+        atomic_acq_rel<std::uint32_t> references{ 0 };
+        std::size_t size{};
+    };
+
+    struct buffer_channel_acquire_operation final
+    {
+        explicit buffer_channel_acquire_operation(buffer_channel& channel) noexcept;
+
+        [[nodiscard]] bool await_ready() { return m_receive.await_ready(); }
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle) { return m_receive.await_suspend(handle); }
+
+        [[nodiscard]] buffer_slab await_resume();
+
+    private:
+        buffer_channel& m_channel;
+        mpmc_channel_receive_operation<std::uint32_t> m_receive;
+    };
+
+    struct buffer_channel_receive_operation final
+    {
+        explicit buffer_channel_receive_operation(buffer_channel& channel) noexcept;
+
+        [[nodiscard]] bool await_ready() { return m_receive.await_ready(); }
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle) { return m_receive.await_suspend(handle); }
+
+        // Returns a view of the next committed slab, or nullopt if the channel was closed and every committed slab has
+        // been received.
+        [[nodiscard]] std::optional<buffer_view> await_resume();
+
+    private:
+        buffer_channel& m_channel;
+        mpmc_channel_receive_operation<std::uint32_t> m_receive;
+    };
+}
+
+namespace async
+{
+    // A writable slab from a buffer_channel's pool; see buffer_channel. Returned to the pool if destroyed without being
+    // committed.
+    struct buffer_slab final
+    {
+        buffer_slab(const buffer_slab&) = delete;
+
+        buffer_slab(buffer_slab&& other) noexcept :
+            m_channel{ std::exchange(other.m_channel, nullptr) }, m_index{ other.m_index }
+        {
+        }
+
+        ~buffer_slab() noexcept { reset(); }
+
+        buffer_slab& operator=(const buffer_slab&) = delete;
+
+        buffer_slab& operator=(buffer_slab&& other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                m_channel = std::exchange(other.m_channel, nullptr);
+                m_index = other.m_index;
+            }
+
+            return *this;
+        }
+
+        // The whole slab (slab_size() bytes); commit() says how much of it was filled.
+        [[nodiscard]] std::span<std::byte> data() const noexcept;
+
+    private:
+        friend struct buffer_channel;
+        friend struct details::buffer_channel_acquire_operation;
+
+        buffer_slab(buffer_channel& channel, std::uint32_t index) noexcept : m_channel{ &channel }, m_index{ index } {}
+
+        void reset() noexcept;
+
+        buffer_channel* m_channel;
+        std::uint32_t m_index;
+    };
+
+    // A read-only, reference-counted view of a committed slab; see buffer_channel. Copying a view shares the slab; the
+    // slab returns to the pool when the last view of it is destroyed.
+    struct buffer_view final
+    {
+        buffer_view(const buffer_view& other) noexcept;
+
+        buffer_view(buffer_view&& other) noexcept :
+            m_channel{ std::exchange(other.m_channel, nullptr) }, m_index{ other.m_index }
+        {
+        }
+
+        ~buffer_view() noexcept { reset(); }
+
+        buffer_view& operator=(const buffer_view& other) noexcept
+        {
+            if (this != &other)
+            {
+                buffer_view copy{ other };
+                *this = std::move(copy);
+            }
+
+            return *this;
+        }
+
+        buffer_view& operator=(buffer_view&& other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                m_channel = std::exchange(other.m_channel, nullptr);
+                m_index = other.m_index;
+            }
+
+            return *this;
+        }
+
+        // The committed bytes.
+        [[nodiscard]] std::span<const std::byte> data() const noexcept;
+
+        [[nodiscard]] std::size_t size() const noexcept { return data().size(); }
+
+    private:
+        friend struct details::buffer_channel_receive_operation;
+
+        // Takes over the reference the committing buffer_slab held.
+        buffer_view(buffer_channel& channel, std::uint32_t index) noexcept : m_channel{ &channel }, m_index{ index } {}
+
+        void reset() noexcept;
+
+        buffer_channel* m_channel;
+        std::uint32_t m_index;
+    };
+
+    // A channel of byte buffers that are written and read in place, for pipelines passing large buffers between stages
+    // without copying them. The channel owns a pool of slabCount slabs of slabSize bytes each, allocated once when it
+    // is constructed. A producer co_awaits acquire() for a writable buffer_slab (suspending while every slab is in use,
+    // which applies backpressure), fills it in place, and commit()s it with the number of bytes written. A consumer
+    // co_awaits receive() for a buffer_view of the next committed slab; views may be copied (to share the slab, for
+    // example with a later stage), and the slab returns to the pool, resuming a waiting producer, when the last view of
+    // it is destroyed. No bytes are copied and nothing is allocated per buffer.
+    // Slab indices move through two mpmc_channels (free and committed), so any number of producers and consumers may
+    // use the channel concurrently, with the same resumption behavior as mpmc_channel. After close(), commit() returns
+    // false, and receive() returns the slabs already committed and then nullopt. Every slab and view must be destroyed
+    // before the channel.
+    struct buffer_channel final
+    {
+        buffer_channel(std::size_t slabSize, std::size_t slabCount) :
+            m_slabSize{ slabSize },
+            m_headers{},
+            m_storage{},
+            m_free{ queue_capacity(slabCount) },
+            m_committed{ queue_capacity(slabCount) }
+        {
+            if (slabSize == 0 || slabCount == 0 || slabCount > std::numeric_limits<std::uint32_t>::max())
+            {
+                throw std::invalid_argument{
+                    "The slab size and count must be nonzero, and the count must fit in 32 bits." };
+            }
+
+            m_headers = std::make_unique<details::buffer_channel_slab_header[]>(slabCount);
+            m_storage = std::make_unique_for_overwrite<std::byte[]>(slabSize * slabCount);
+
+            for (std::uint32_t index = 0; index != slabCount; ++index)
+            {
+                [[maybe_unused]] const bool added{ m_free.try_send(index) };
+                assert(added);
+            }
+        }
+
+        buffer_channel(const buffer_channel&) = delete;
+        buffer_channel(buffer_channel&&) noexcept = delete;
+
+        ~buffer_channel() noexcept = default;
+
+        buffer_channel& operator=(const buffer_channel&) = delete;
+        buffer_channel& operator=(buffer_channel&&) noexcept = delete;
+
+        [[nodiscard]] std::size_t slab_size() const noexcept { return m_slabSize; }
+
+        // co_await acquire() returns a writable slab from the pool, waiting until one is free.
+        [[nodiscard]] details::buffer_channel_acquire_operation acquire() noexcept
+        {
+            return details::buffer_channel_acquire_operation{ *this };
+        }
+
+        // Sends the first size bytes of the slab to a consumer. Never waits (there is always room for every slab).
+        // Returns false if the channel has been closed, in which case the slab returns to the pool.
+        bool commit(buffer_slab&& slab, std::size_t size)
+        {
+            if (slab.m_channel != this || size > m_slabSize)
+            {
+                throw std::invalid_argument{ "The slab must come from this channel and the size must fit in it." };
+            }
+
+            buffer_slab committing{ std::move(slab) };
+            m_headers[committing.m_index].size = size;
+
+            if (!m_committed.try_send(committing.m_index))
+            {
+                return false;
+            }
+
+            // The consumer's buffer_view takes over the slab's reference.
+            committing.m_channel = nullptr;
+            return true;
+        }
+
+        // co_await receive() returns a view of the next committed slab, or nullopt if the channel was closed and every
+        // committed slab has been received.
+        [[nodiscard]] details::buffer_channel_receive_operation receive() noexcept
+        {
+            return details::buffer_channel_receive_operation{ *this };
+        }
+
+        void close() { m_committed.close(); }
+
+    private:
+        friend struct buffer_slab;
+        friend struct buffer_view;
+        friend struct details::buffer_channel_acquire_operation;
+        friend struct details::buffer_channel_receive_operation;
+
+        // Each queue holds at most every slab, so neither commit() nor returning a slab ever finds it full.
+        [[nodiscard]] static std::size_t queue_capacity(std::size_t slabCount)
+        {
+            return std::bit_ceil(slabCount < 2 ? std::size_t{ 2 } : slabCount);
+        }
+
+        [[nodiscard]] std::byte* slab_data(std::uint32_t index) const noexcept
+        {
+            return m_storage.get() + static_cast<std::size_t>(index) * m_slabSize;
+        }
+
+        void add_reference(std::uint32_t index) noexcept { m_headers[index].references.fetch_add(1); }
+
+        void release(std::uint32_t index) noexcept
+        {
+            if (m_headers[index].references.fetch_sub(1) == 1)
+            {
+                // The free queue is never closed, and always has room (see queue_capacity).
+                [[maybe_unused]] const bool returned{ m_free.try_send(index) };
+                assert(returned);
+            }
+        }
+
+        const std::size_t m_slabSize;
+        std::unique_ptr<details::buffer_channel_slab_header[]> m_headers;
+        std::unique_ptr<std::byte[]> m_storage;
+        mpmc_channel<std::uint32_t> m_free;
+        mpmc_channel<std::uint32_t> m_committed;
+    };
+
+    inline std::span<std::byte> buffer_slab::data() const noexcept
+    {
+        return std::span<std::byte>{ m_channel->slab_data(m_index), m_channel->m_slabSize };
+    }
+
+    inline void buffer_slab::reset() noexcept
+    {
+        if (m_channel != nullptr)
+        {
+            std::exchange(m_channel, nullptr)->release(m_index);
+        }
+    }
+
+    inline buffer_view::buffer_view(const buffer_view& other) noexcept :
+        m_channel{ other.m_channel }, m_index{ other.m_index }
+    {
+        if (m_channel != nullptr)
+        {
+            m_channel->add_reference(m_index);
+        }
+    }
+
+    inline std::span<const std::byte> buffer_view::data() const noexcept
+    {
+        return std::span<const std::byte>{ m_channel->slab_data(m_index), m_channel->m_headers[m_index].size };
+    }
+
+    inline void buffer_view::reset() noexcept
+    {
+        if (m_channel != nullptr)
+        {
+            std::exchange(m_channel, nullptr)->release(m_index);
+        }
+    }
+}
+
+namespace async::details
+{
+    inline buffer_channel_acquire_operation::buffer_channel_acquire_operation(buffer_channel& channel) noexcept :
+        m_channel{ channel }, m_receive{ channel.m_free.receive() }
+    {
+    }
+
+    inline buffer_slab buffer_channel_acquire_operation::await_resume()
+    {
+        // The free queue is never closed, so an index is always received.
+        const std::uint32_t index{ *m_receive.await_resume() };
+        m_channel.m_headers[index].references = 1;
+        return buffer_slab{ m_channel, index };
+    }
+
+    inline buffer_channel_receive_operation::buffer_channel_receive_operation(buffer_channel& channel) noexcept :
+        m_channel{ channel }, m_receive{ channel.m_committed.receive() }
+    {
+    }
+
+    inline std::optional<buffer_view> buffer_channel_receive_operation::await_resume()
+    {
+        const std::optional<std::uint32_t> index{ m_receive.await_resume() };
+
+        if (!index)
+        {
+            return std::nullopt;
+        }
+
+        return buffer_view{ m_channel, *index };
+    }
+}
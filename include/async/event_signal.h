@@ -10,13 +10,20 @@
 
 namespace async
 {
+#ifdef _MSC_VER
+#pragma warning(push)
+// structure was padded due to alignment specifier
+#pragma warning(disable : 4324)
+#endif
+
     struct event_signal final
     {
         event_signal() noexcept : m_signaled{ false } {}
 
         bool is_set() const
         {
-            std::lock_guard<std::mutex> mutexGuard{ m_mutex };
+            // m_signaled is only written under m_mutex, but reading it does not require the mutex; avoid contending
+            // with set() and waiters for it.
             return m_signaled.load();
         }
 
@@ -59,6 +66,11 @@ namespace async
     private:
         mutable std::condition_variable m_condition;
         mutable std::mutex m_mutex;
-        details::atomic_acq_rel<bool> m_signaled;
+        // Kept on its own cache line so polling is_set() does not contend with the mutex and condition variable.
+        details::padded_atomic_acq_rel<bool> m_signaled;
     };
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
 }
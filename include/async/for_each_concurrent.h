@@ -0,0 +1,189 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "atomic_acq_rel.h"
+#include "awaitable_resume_t.h"
+#include "task.h"
+#include "when_all.h"
+
+namespace async::details
+{
+    // State shared by the workers of for_each_concurrent and transform_concurrent. Workers claim elements by
+    // incrementing a single shared index, so no scheduling work is done (or allocated) per element.
+    struct concurrent_state final
+    {
+        concurrent_state() noexcept : m_next{ 0 }, m_failed{ false }, m_exception{}, m_stopSource{} {}
+
+        concurrent_state(const concurrent_state&) = delete;
+        concurrent_state(concurrent_state&&) noexcept = delete;
+
+        ~concurrent_state() noexcept = default;
+
+        concurrent_state& operator=(const concurrent_state&) = delete;
+        concurrent_state& operator=(concurrent_state&&) noexcept = delete;
+
+        // Returns false once every element has been claimed or another worker has failed.
+        [[nodiscard]] bool try_claim(std::size_t count, std::size_t& index) noexcept
+        {
+            if (m_stopSource.stop_requested())
+            {
+                return false;
+            }
+
+            index = m_next.fetch_add(1);
+            return index < count;
+        }
+
+        [[nodiscard]] std::stop_token get_token() const noexcept { return m_stopSource.get_token(); }
+
+        // Records the first exception and stops the remaining elements from being started.
+        void fail(const std::exception_ptr& exception) noexcept
+        {
+            bool expected{ false };
+
+            if (m_failed.compare_exchange_strong(expected, true))
+            {
+                m_exception = exception;
+                m_stopSource.request_stop();
+            }
+        }
+
+        // Called only after every worker has completed.
+        void rethrow_if_failed() const
+        {
+            if (m_exception)
+            {
+                std::rethrow_exception(m_exception);
+            }
+        }
+
+    private:
+        atomic_acq_rel<std::size_t> m_next;
+        atomic_acq_rel<bool> m_failed;
+        std::exception_ptr m_exception;
+        std::stop_source m_stopSource;
+    };
+
+    // Calls fn(element, stopToken) if fn accepts a std::stop_token, and fn(element) otherwise.
+    template <typename Fn, typename Element>
+    decltype(auto) invoke_concurrent(Fn& fn, Element&& element, const std::stop_token& stopToken)
+    {
+        if constexpr (std::is_invocable_v<Fn&, Element, const std::stop_token&>)
+        {
+            return std::invoke(fn, std::forward<Element>(element), stopToken);
+        }
+        else
+        {
+            return std::invoke(fn, std::forward<Element>(element));
+        }
+    }
+
+    template <typename Fn, typename Element>
+    using concurrent_awaitable_t =
+        decltype(invoke_concurrent(std::declval<Fn&>(), std::declval<Element>(), std::declval<std::stop_token>()));
+
+    // Runs fn on claimed elements one at a time until none remain; sink(index, result) stores each non-void result.
+    template <typename Iterator, typename Fn, typename Sink>
+    task<void> run_concurrent_worker(concurrent_state& state, Iterator first, std::size_t count, Fn& fn, Sink& sink)
+    {
+        using T = awaitable_resume_t<concurrent_awaitable_t<Fn, decltype(*first)>>;
+        std::size_t index{};
+
+        while (state.try_claim(count, index))
+        {
+            try
+            {
+                if constexpr (std::is_void_v<T>)
+                {
+                    co_await invoke_concurrent(fn, first[index], state.get_token());
+                }
+                else
+                {
+                    sink(index, co_await invoke_concurrent(fn, first[index], state.get_token()));
+                }
+            }
+            catch (...)
+            {
+                state.fail(std::current_exception());
+            }
+        }
+    }
+
+    template <typename Iterator, typename Fn, typename Sink>
+    task<void> run_concurrent(Iterator first, Iterator last, std::size_t limit, Fn& fn, Sink& sink)
+    {
+        static_assert(std::is_base_of_v<std::random_access_iterator_tag,
+                          typename std::iterator_traits<Iterator>::iterator_category>,
+            "The range must be a random access range.");
+
+        if (limit == 0)
+        {
+            throw std::invalid_argument{ "The limit must not be zero." };
+        }
+
+        const std::size_t count{ static_cast<std::size_t>(std::distance(first, last)) };
+        concurrent_state state{};
+        std::vector<task<void>> workers{};
+        workers.reserve(std::min(limit, count));
+
+        for (std::size_t worker = 0; worker != std::min(limit, count); ++worker)
+        {
+            workers.push_back(run_concurrent_worker(state, first, count, fn, sink));
+        }
+
+        co_await when_all(std::move(workers));
+        state.rethrow_if_failed();
+    }
+}
+
+namespace async
+{
+    // Calls fn on every element of range, with at most limit calls in flight at once, and completes once they have all
+    // completed. fn returns an awaitable, and may optionally take a std::stop_token as its second argument; fn may be
+    // called concurrently from several threads. If any call throws, no further elements are started, stop is requested
+    // on the token passed to calls already in flight, and (once they complete) the first exception is rethrown. range
+    // must be a random access range that outlives the returned task.
+    template <typename Range, typename Fn>
+    task<void> for_each_concurrent(Range&& range, std::size_t limit, Fn fn)
+    {
+        auto sink{ [](std::size_t, auto&&) noexcept {} };
+        co_await details::run_concurrent(std::begin(range), std::end(range), limit, fn, sink);
+    }
+
+    // Like for_each_concurrent, but collects the result of each call, in the order of range.
+    template <typename Range, typename Fn>
+    auto transform_concurrent(Range&& range, std::size_t limit, Fn fn)
+        -> task<std::vector<awaitable_resume_t<details::concurrent_awaitable_t<Fn, decltype(*std::begin(range))>>>>
+    {
+        using T = awaitable_resume_t<details::concurrent_awaitable_t<Fn, decltype(*std::begin(range))>>;
+        static_assert(!std::is_void_v<T> && !std::is_reference_v<T>,
+            "transform_concurrent requires non-void, non-reference results.");
+
+        const std::size_t count{ static_cast<std::size_t>(std::distance(std::begin(range), std::end(range))) };
+        std::vector<std::optional<T>> slots(count);
+        auto sink{ [&slots](std::size_t index, T&& value) { slots[index].emplace(std::move(value)); } };
+        co_await details::run_concurrent(std::begin(range), std::end(range), limit, fn, sink);
+
+        std::vector<T> results{};
+        results.reserve(slots.size());
+
+        for (std::optional<T>& slot : slots)
+        {
+            results.push_back(std::move(*slot));
+        }
+
+        co_return results;
+    }
+}
@@ -0,0 +1,394 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+
+namespace async
+{
+    template <typename T>
+    struct generator;
+
+    // co_yield elements_of(nested) in a generator<T> yields every element of nested (another generator<T>) in turn.
+    template <typename Range>
+    struct elements_of final
+    {
+        Range range;
+    };
+
+    template <typename Range>
+    elements_of(Range&&) -> elements_of<Range&&>;
+}
+
+namespace async::details
+{
+    // Allocates coroutine frames through a caller-supplied allocator. A pointer to the matching deallocation function
+    // (followed by a copy of the allocator) is stored just past the end of the frame, so the allocator's type is not
+    // part of the generator's type.
+    struct generator_frame_allocation final
+    {
+        using deallocate_function = void (*)(void* frame, std::size_t size) noexcept;
+
+        template <typename Allocator>
+        [[nodiscard]] static void* allocate(std::size_t size, const Allocator& allocator)
+        {
+            using block_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<block>;
+            static_assert(alignof(block_allocator) <= alignof(block), "The allocator's alignment is not supported.");
+
+            block_allocator blockAllocator{ allocator };
+            void* const frame{ std::allocator_traits<block_allocator>::allocate(
+                blockAllocator, block_count<block_allocator>(size)) };
+            ::new (static_cast<void*>(function_address(frame, size))) deallocate_function{
+                &deallocate<block_allocator>
+            };
+            ::new (allocator_address(frame, size)) block_allocator{ std::move(blockAllocator) };
+            return frame;
+        }
+
+        static void deallocate(void* frame, std::size_t size) noexcept
+        {
+            (*std::launder(function_address(frame, size)))(frame, size);
+        }
+
+    private:
+        struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) block final
+        {
+            std::byte bytes[__STDCPP_DEFAULT_NEW_ALIGNMENT__];
+        };
+
+        [[nodiscard]] static constexpr std::size_t round_up(std::size_t size) noexcept
+        {
+            return (size + sizeof(block) - 1) / sizeof(block) * sizeof(block);
+        }
+
+        template <typename BlockAllocator>
+        [[nodiscard]] static constexpr std::size_t block_count(std::size_t size) noexcept
+        {
+            return round_up(allocator_offset(size) + sizeof(BlockAllocator)) / sizeof(block);
+        }
+
+        [[nodiscard]] static constexpr std::size_t allocator_offset(std::size_t size) noexcept
+        {
+            return round_up(round_up(size) + sizeof(deallocate_function));
+        }
+
+        [[nodiscard]] static deallocate_function* function_address(void* frame, std::size_t size) noexcept
+        {
+            return reinterpret_cast<deallocate_function*>(static_cast<std::byte*>(frame) + round_up(size));
+        }
+
+        [[nodiscard]] static void* allocator_address(void* frame, std::size_t size) noexcept
+        {
+            return static_cast<std::byte*>(frame) + allocator_offset(size);
+        }
+
+        template <typename BlockAllocator>
+        static void deallocate(void* frame, std::size_t size) noexcept
+        {
+            BlockAllocator& stored{ *std::launder(static_cast<BlockAllocator*>(allocator_address(frame, size))) };
+            BlockAllocator allocator{ std::move(stored) };
+            stored.~BlockAllocator();
+            std::allocator_traits<BlockAllocator>::deallocate(
+                allocator, static_cast<block*>(frame), block_count<BlockAllocator>(size));
+        }
+    };
+
+    template <typename T>
+    struct generator_promise;
+
+    // Holds a copy of a value yielded as a const lvalue (when T is not const), which lives in the generator's
+    // coroutine frame until the generator is resumed.
+    template <typename T>
+    struct generator_yield_copy_operation final
+    {
+        explicit generator_yield_copy_operation(const T& value) : m_value{ value } {}
+
+        [[nodiscard]] constexpr bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<generator_promise<T>> handle) noexcept
+        {
+            handle.promise().root->current = std::addressof(m_value);
+        }
+
+        constexpr void await_resume() const noexcept {}
+
+    private:
+        T m_value;
+    };
+
+    // Starts a nested generator, making it the root's active generator (so the consumer resumes it directly).
+    template <typename T>
+    struct generator_nested_operation final
+    {
+        explicit generator_nested_operation(std::coroutine_handle<generator_promise<T>> nested) noexcept :
+            m_nested{ nested }
+        {
+        }
+
+        [[nodiscard]] bool await_ready() const noexcept { return m_nested.done(); }
+
+        [[nodiscard]] std::coroutine_handle<> await_suspend(
+            std::coroutine_handle<generator_promise<T>> handle) const noexcept
+        {
+            generator_promise<T>& nested{ m_nested.promise() };
+            nested.root = handle.promise().root;
+            nested.parent = handle;
+            nested.root->active = m_nested;
+            return m_nested;
+        }
+
+        // Rethrows any exception thrown by the nested generator in the generator that yielded it.
+        void await_resume() const
+        {
+            generator_promise<T>& nested{ m_nested.promise() };
+
+            if (nested.exception)
+            {
+                std::rethrow_exception(std::exchange(nested.exception, nullptr));
+            }
+        }
+
+    private:
+        std::coroutine_handle<generator_promise<T>> m_nested;
+    };
+
+    template <typename T>
+    struct generator_promise final
+    {
+        struct final_awaiter final
+        {
+            [[nodiscard]] constexpr bool await_ready() const noexcept { return false; }
+
+            // A nested generator transfers back to the generator that yielded it, which becomes the active one again.
+            [[nodiscard]] std::coroutine_handle<> await_suspend(
+                std::coroutine_handle<generator_promise> handle) const noexcept
+            {
+                generator_promise& promise{ handle.promise() };
+
+                if (!promise.parent)
+                {
+                    return std::noop_coroutine();
+                }
+
+                promise.root->active = promise.parent;
+                return promise.parent;
+            }
+
+            constexpr void await_resume() const noexcept {}
+        };
+
+        static void* operator new(std::size_t size)
+        {
+            return generator_frame_allocation::allocate(size, std::allocator<std::byte>{});
+        }
+
+        template <typename Allocator, typename... Args>
+        static void* operator new(std::size_t size, std::allocator_arg_t, const Allocator& allocator, const Args&...)
+        {
+            return generator_frame_allocation::allocate(size, allocator);
+        }
+
+        // For member functions, whose first argument is the object.
+        template <typename This, typename Allocator, typename... Args>
+        static void* operator new(
+            std::size_t size, const This&, std::allocator_arg_t, const Allocator& allocator, const Args&...)
+        {
+            return generator_frame_allocation::allocate(size, allocator);
+        }
+
+        static void operator delete(void* frame, std::size_t size) noexcept
+        {
+            generator_frame_allocation::deallocate(frame, size);
+        }
+
+        generator<T> get_return_object() noexcept;
+
+        constexpr std::suspend_always initial_suspend() const noexcept { return {}; }
+
+        constexpr final_awaiter final_suspend() const noexcept { return {}; }
+
+        // A yielded value lives in the generator's coroutine frame until the generator is resumed (a temporary lasts
+        // until the end of its co_yield expression), so only its address is stored.
+        std::suspend_always yield_value(T& value) noexcept
+        {
+            root->current = std::addressof(value);
+            return {};
+        }
+
+        std::suspend_always yield_value(T&& value) noexcept
+        {
+            root->current = std::addressof(value);
+            return {};
+        }
+
+        template <typename U = T, typename = std::enable_if_t<!std::is_const_v<U>>>
+        generator_yield_copy_operation<T> yield_value(const U& value)
+        {
+            return generator_yield_copy_operation<T>{ value };
+        }
+
+        generator_nested_operation<T> yield_value(elements_of<generator<T>&&> nested) noexcept;
+
+        generator_nested_operation<T> yield_value(elements_of<generator<T>&> nested) noexcept;
+
+        constexpr void return_void() const noexcept {}
+
+        void unhandled_exception() noexcept { exception = std::current_exception(); }
+
+        // The outermost generator (the one being iterated); this promise, unless it belongs to a nested generator.
+        generator_promise* root{ this };
+
+        // Used only in the root: the innermost running generator, which the consumer resumes directly.
+        std::coroutine_handle<> active{};
+
+        // Used only in the root: the value most recently yielded by any generator in the chain.
+        T* current{};
+
+        // Used only in nested generators: the generator that yielded this one.
+        std::coroutine_handle<> parent{};
+
+        std::exception_ptr exception{};
+    };
+
+    template <typename T>
+    struct generator_iterator final
+    {
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = std::remove_cv_t<T>;
+        using difference_type = std::ptrdiff_t;
+
+        generator_iterator() noexcept : m_handle{} {}
+
+        explicit generator_iterator(std::coroutine_handle<generator_promise<T>> handle) noexcept : m_handle{ handle }
+        {
+        }
+
+        generator_iterator(const generator_iterator&) = delete;
+        generator_iterator(generator_iterator&&) noexcept = default;
+
+        ~generator_iterator() noexcept = default;
+
+        generator_iterator& operator=(const generator_iterator&) = delete;
+        generator_iterator& operator=(generator_iterator&&) noexcept = default;
+
+        [[nodiscard]] T& operator*() const noexcept { return *m_handle.promise().current; }
+
+        generator_iterator& operator++()
+        {
+            resume(m_handle);
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        [[nodiscard]] friend bool operator==(const generator_iterator& iterator, std::default_sentinel_t) noexcept
+        {
+            return iterator.m_handle.done();
+        }
+
+        // Resumes the innermost active generator and rethrows any exception that reached the root.
+        static void resume(std::coroutine_handle<generator_promise<T>> handle)
+        {
+            generator_promise<T>& root{ handle.promise() };
+            root.active.resume();
+
+            if (root.exception)
+            {
+                std::rethrow_exception(std::exchange(root.exception, nullptr));
+            }
+        }
+
+    private:
+        std::coroutine_handle<generator_promise<T>> m_handle;
+    };
+}
+
+namespace async
+{
+    // A coroutine return type for producing a sequence of values lazily and synchronously; a generator<T> is a
+    // std::ranges::input_range (and view) whose elements are T& referring to each value as it is yielded, so yielded
+    // values are not copied (except for const lvalues when T is not const; use generator<const T> to yield references
+    // to existing values).
+    // co_yield elements_of(nested) yields every element of another generator<T>. Nested generators are resumed
+    // directly by the consumer (rather than through each enclosing generator), so each increment costs the same
+    // regardless of nesting depth; an exception thrown by a nested generator propagates out of its co_yield.
+    // To allocate the coroutine frame with an allocator, pass std::allocator_arg and the allocator as the coroutine's
+    // first two arguments (after the object, for a member function).
+    template <typename T>
+    struct generator final : std::ranges::view_interface<generator<T>>
+    {
+        static_assert(!std::is_reference_v<T>, "generator<T> requires a non-reference value type.");
+
+        using promise_type = details::generator_promise<T>;
+
+        explicit generator(std::coroutine_handle<promise_type> handle) noexcept : m_handle{ handle } {}
+
+        generator(const generator&) = delete;
+
+        generator(generator&& other) noexcept : m_handle{ std::exchange(other.m_handle, {}) } {}
+
+        ~generator() noexcept
+        {
+            if (m_handle)
+            {
+                m_handle.destroy();
+            }
+        }
+
+        generator& operator=(const generator&) = delete;
+
+        generator& operator=(generator&& other) noexcept
+        {
+            std::swap(m_handle, other.m_handle);
+            return *this;
+        }
+
+        // Starts the generator, running it until its first co_yield. May be called only once.
+        [[nodiscard]] details::generator_iterator<T> begin()
+        {
+            details::generator_iterator<T>::resume(m_handle);
+            return details::generator_iterator<T>{ m_handle };
+        }
+
+        [[nodiscard]] std::default_sentinel_t end() const noexcept { return std::default_sentinel; }
+
+    private:
+        friend struct details::generator_promise<T>;
+
+        std::coroutine_handle<promise_type> m_handle;
+    };
+}
+
+namespace async::details
+{
+    template <typename T>
+    inline generator<T> generator_promise<T>::get_return_object() noexcept
+    {
+        const std::coroutine_handle<generator_promise<T>> handle{
+            std::coroutine_handle<generator_promise<T>>::from_promise(*this)
+        };
+        active = handle;
+        return generator<T>{ handle };
+    }
+
+    template <typename T>
+    inline generator_nested_operation<T> generator_promise<T>::yield_value(
+        elements_of<generator<T>&&> nested) noexcept
+    {
+        return generator_nested_operation<T>{ nested.range.m_handle };
+    }
+
+    template <typename T>
+    inline generator_nested_operation<T> generator_promise<T>::yield_value(elements_of<generator<T>&> nested) noexcept
+    {
+        return generator_nested_operation<T>{ nested.range.m_handle };
+    }
+}
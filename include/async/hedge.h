@@ -0,0 +1,374 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "async_wait_group.h"
+#include "atomic_acq_rel.h"
+#include "awaitable_resume_t.h"
+#include "awaitable_result.h"
+#include "awaitable_then.h"
+#include "task.h"
+#include "task_canceled.h"
+#include "timer_service.h"
+
+namespace async
+{
+    // Counts how often hedge() fired and won, and tracks a percentile of recent request latencies (over a sliding
+    // window of windowSize requests) for use as an adaptive hedging delay. Until enough requests have been recorded,
+    // delay() returns initialDelay. May be shared by concurrent calls to hedge().
+    struct hedge_statistics final
+    {
+        explicit hedge_statistics(
+            std::chrono::microseconds initialDelay, double percentile = 0.95, std::size_t windowSize = 1024) :
+            m_percentile{ percentile },
+            m_windowSize{ windowSize },
+            m_updateInterval{ std::max<std::size_t>(windowSize / 16, 1) },
+            m_requests{ 0 },
+            m_hedgesFired{ 0 },
+            m_hedgesWon{ 0 },
+            m_mutex{},
+            m_samples{},
+            m_nextSample{},
+            m_sinceUpdate{},
+            m_delay{ initialDelay }
+        {
+            if (!(percentile > 0.0 && percentile <= 1.0))
+            {
+                throw std::invalid_argument{ "The percentile must be greater than zero and at most one." };
+            }
+
+            if (windowSize == 0)
+            {
+                throw std::invalid_argument{ "The window size must not be zero." };
+            }
+
+            m_samples.reserve(windowSize);
+        }
+
+        hedge_statistics(const hedge_statistics&) = delete;
+        hedge_statistics(hedge_statistics&&) noexcept = delete;
+
+        ~hedge_statistics() noexcept = default;
+
+        hedge_statistics& operator=(const hedge_statistics&) = delete;
+        hedge_statistics& operator=(hedge_statistics&&) noexcept = delete;
+
+        // The delay after which hedge() starts another attempt.
+        [[nodiscard]] std::chrono::microseconds delay() const
+        {
+            std::lock_guard<std::mutex> mutexLock{ m_mutex };
+            return m_delay;
+        }
+
+        // The number of completed calls to hedge().
+        [[nodiscard]] std::uint64_t requests() const noexcept { return m_requests.load(); }
+
+        // The number of attempts started after the first one.
+        [[nodiscard]] std::uint64_t hedges_fired() const noexcept { return m_hedgesFired.load(); }
+
+        // The number of calls to hedge() completed by an attempt other than the first one.
+        [[nodiscard]] std::uint64_t hedges_won() const noexcept { return m_hedgesWon.load(); }
+
+        void record(std::chrono::microseconds latency, std::size_t hedgesFired, bool hedgeWon)
+        {
+            m_requests.fetch_add(1);
+            m_hedgesFired.fetch_add(hedgesFired);
+
+            if (hedgeWon)
+            {
+                m_hedgesWon.fetch_add(1);
+            }
+
+            std::lock_guard<std::mutex> mutexLock{ m_mutex };
+
+            if (m_samples.size() < m_windowSize)
+            {
+                m_samples.push_back(latency);
+            }
+            else
+            {
+                m_samples[m_nextSample] = latency;
+                m_nextSample = (m_nextSample + 1) % m_windowSize;
+            }
+
+            // Selecting the percentile is linear in the window size, so it is only done periodically.
+            if (++m_sinceUpdate == m_updateInterval)
+            {
+                m_sinceUpdate = 0;
+                update_delay();
+            }
+        }
+
+    private:
+        // Called with m_mutex held.
+        void update_delay()
+        {
+            std::vector<std::chrono::microseconds> sorted{ m_samples };
+            const std::size_t rank{ static_cast<std::size_t>(
+                std::ceil(m_percentile * static_cast<double>(sorted.size()))) };
+            const auto selected{ sorted.begin() + static_cast<std::ptrdiff_t>(std::max<std::size_t>(rank, 1) - 1) };
+            std::nth_element(sorted.begin(), selected, sorted.end());
+            m_delay = *selected;
+        }
+
+        const double m_percentile;
+        const std::size_t m_windowSize;
+        const std::size_t m_updateInterval;
+        details::atomic_acq_rel<std::uint64_t> m_requests;
+        details::atomic_acq_rel<std::uint64_t> m_hedgesFired;
+        details::atomic_acq_rel<std::uint64_t> m_hedgesWon;
+        mutable std::mutex m_mutex;
+        std::vector<std::chrono::microseconds> m_samples;
+        std::size_t m_nextSample;
+        std::size_t m_sinceUpdate;
+        std::chrono::microseconds m_delay;
+    };
+}
+
+namespace async::details
+{
+    // Shared by hedge() and its attempts, so losing attempts may finish after hedge() has returned. The first attempt
+    // to succeed completes the hedge; a failure completes it only once no attempt remains running or may be started.
+    template <typename T>
+    struct hedge_state final
+    {
+        hedge_state() :
+            m_outstanding{ 1 },
+            m_completed{ false },
+            m_failed{ false },
+            m_winner{},
+            m_failedAttempt{},
+            m_exception{},
+            m_result{},
+            m_stopSource{},
+            m_waitGroup{}
+        {
+            m_waitGroup.add();
+        }
+
+        hedge_state(const hedge_state&) = delete;
+        hedge_state(hedge_state&&) noexcept = delete;
+
+        ~hedge_state() noexcept = default;
+
+        hedge_state& operator=(const hedge_state&) = delete;
+        hedge_state& operator=(hedge_state&&) noexcept = delete;
+
+        // Stop is requested on this token once the hedge completes.
+        [[nodiscard]] std::stop_token get_token() const noexcept { return m_stopSource.get_token(); }
+
+        [[nodiscard]] bool is_completed() const noexcept { return m_completed.load(); }
+
+        // Called only after the hedge has completed.
+        [[nodiscard]] std::size_t winner() const noexcept { return m_winner; }
+
+        [[nodiscard]] T result() { return m_result(); }
+
+        [[nodiscard]] async_wait_group_operation wait_async() noexcept { return m_waitGroup.wait_async(); }
+
+        // Called before each attempt is started.
+        void add_attempt() noexcept { m_outstanding.fetch_add(1); }
+
+        // Called once no further attempts will be started.
+        void stop_adding_attempts() { release(); }
+
+        template <typename... Value>
+        void set_value(std::size_t attempt, Value&&... value)
+        {
+            if (try_complete(attempt))
+            {
+                m_result.set_value(std::forward<Value>(value)...);
+                complete();
+            }
+
+            release();
+        }
+
+        void set_exception(std::size_t attempt, const std::exception_ptr& exception)
+        {
+            bool expected{ false };
+
+            if (m_failed.compare_exchange_strong(expected, true))
+            {
+                m_failedAttempt = attempt;
+                m_exception = exception;
+            }
+
+            release();
+        }
+
+    private:
+        [[nodiscard]] bool try_complete(std::size_t attempt) noexcept
+        {
+            bool expected{ false };
+
+            if (!m_completed.compare_exchange_strong(expected, true))
+            {
+                return false;
+            }
+
+            m_winner = attempt;
+            return true;
+        }
+
+        void complete()
+        {
+            // Cancels the losing attempts, and hedge()'s wait before starting another attempt.
+            m_stopSource.request_stop();
+            m_waitGroup.done();
+        }
+
+        void release()
+        {
+            // Once nothing is outstanding, every attempt has failed; complete with the first failure.
+            if (m_outstanding.fetch_sub(1) == 1 && try_complete(m_failedAttempt))
+            {
+                m_result.set_exception(m_exception);
+                complete();
+            }
+        }
+
+        atomic_acq_rel<std::size_t> m_outstanding;
+        atomic_acq_rel<bool> m_completed;
+        atomic_acq_rel<bool> m_failed;
+        std::size_t m_winner;
+        std::size_t m_failedAttempt;
+        std::exception_ptr m_exception;
+        awaitable_result<T> m_result;
+        std::stop_source m_stopSource;
+        async_wait_group m_waitGroup;
+    };
+
+    // Calls factory(stopToken) if factory accepts a std::stop_token, and factory() otherwise.
+    template <typename Factory>
+    decltype(auto) invoke_hedge_factory(Factory& factory, const std::stop_token& stopToken)
+    {
+        if constexpr (std::is_invocable_v<Factory&, const std::stop_token&>)
+        {
+            return std::invoke(factory, stopToken);
+        }
+        else
+        {
+            return std::invoke(factory);
+        }
+    }
+
+    template <typename Factory>
+    using hedge_result_t = awaitable_resume_t<decltype(invoke_hedge_factory(
+        std::declval<Factory&>(), std::declval<const std::stop_token&>()))>;
+
+    // factory is called before this coroutine first suspends, while the caller's reference is still valid.
+    template <typename T, typename Factory>
+    then_task run_hedge_attempt(std::shared_ptr<hedge_state<T>> state, Factory& factory, std::size_t attempt)
+    {
+        try
+        {
+            if constexpr (std::is_void_v<T>)
+            {
+                co_await invoke_hedge_factory(factory, state->get_token());
+                state->set_value(attempt);
+            }
+            else
+            {
+                state->set_value(attempt, co_await invoke_hedge_factory(factory, state->get_token()));
+            }
+        }
+        catch (...)
+        {
+            state->set_exception(attempt, std::current_exception());
+        }
+    }
+
+    template <typename Factory>
+    task<hedge_result_t<Factory>> run_hedge(Factory factory, std::chrono::microseconds delay, std::size_t maxAttempts,
+        hedge_statistics* statistics, timer_service& timers)
+    {
+        using T = hedge_result_t<Factory>;
+
+        if (maxAttempts == 0)
+        {
+            throw std::invalid_argument{ "The maximum number of attempts must not be zero." };
+        }
+
+        const std::chrono::steady_clock::time_point start{ std::chrono::steady_clock::now() };
+        const std::shared_ptr<hedge_state<T>> state{ std::make_shared<hedge_state<T>>() };
+        std::size_t started{};
+
+        while (true)
+        {
+            state->add_attempt();
+            run_hedge_attempt(state, factory, started++);
+
+            if (started == maxAttempts || state->is_completed())
+            {
+                break;
+            }
+
+            try
+            {
+                // Stop is requested on the state's token as soon as an attempt completes the hedge.
+                co_await timers.wait_for(delay, state->get_token());
+            }
+            catch (const task_canceled&)
+            {
+                break;
+            }
+
+            if (state->is_completed())
+            {
+                break;
+            }
+        }
+
+        state->stop_adding_attempts();
+        co_await state->wait_async();
+
+        if (statistics != nullptr)
+        {
+            statistics->record(std::chrono::duration_cast<std::chrono::microseconds>(
+                                   std::chrono::steady_clock::now() - start),
+                started - 1, state->winner() != 0);
+        }
+
+        co_return state->result();
+    }
+}
+
+namespace async
+{
+    // Awaits the awaitable returned by factory, and if it has not completed after delay, calls factory again and
+    // awaits both, and so on (waiting delay between each) for up to maxAttempts attempts in total. The first attempt to
+    // succeed provides the result, and stop is requested on the std::stop_token passed to the others (if factory
+    // accepts one) so that they may abort; if every attempt fails, the first failure is rethrown. The delays are
+    // tracked by timers, without blocking a thread. Hedging trades extra load for lower tail latency, so delay is
+    // usually a high percentile of the operation's latency; see the hedge_statistics overload below.
+    template <typename Factory>
+    task<details::hedge_result_t<Factory>> hedge(Factory factory, std::chrono::microseconds delay,
+        std::size_t maxAttempts, timer_service& timers = timer_service::shared())
+    {
+        return details::run_hedge(std::move(factory), delay, maxAttempts, nullptr, timers);
+    }
+
+    // Like hedge(factory, delay, maxAttempts), using statistics.delay() (a percentile of recent latencies) as the
+    // delay, and recording this call's latency and whether a hedge fired or won in statistics.
+    template <typename Factory>
+    task<details::hedge_result_t<Factory>> hedge(Factory factory, hedge_statistics& statistics,
+        std::size_t maxAttempts, timer_service& timers = timer_service::shared())
+    {
+        return details::run_hedge(std::move(factory), statistics.delay(), maxAttempts, &statistics, timers);
+    }
+}
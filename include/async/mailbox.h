@@ -0,0 +1,379 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "atomic_acq_rel.h"
+
+namespace async
+{
+    template <typename T>
+    struct mailbox;
+
+    // The hook a message type derives from to be posted to a mailbox. A message may be in at most one mailbox (or
+    // mailbox_batch) at a time; it may be posted again once received.
+    struct mailbox_node
+    {
+        mailbox_node() noexcept : m_next{ nullptr } {}
+
+        mailbox_node(const mailbox_node&) noexcept : m_next{ nullptr } {}
+
+        ~mailbox_node() noexcept = default;
+
+        mailbox_node& operator=(const mailbox_node&) noexcept { return *this; }
+
+    private:
+        template <typename T>
+        friend struct mailbox;
+
+        template <typename T>
+        friend struct mailbox_batch;
+
+        details::atomic_acq_rel<mailbox_node*> m_next;
+    };
+
+    // The messages a mailbox's receive_batch() drained, in the order they were posted. pop() unlinks each message
+    // before returning it, so a message may be destroyed or posted again as soon as it is popped. Destroying a batch
+    // does not touch the messages left in it.
+    template <typename T>
+    struct mailbox_batch final
+    {
+        mailbox_batch() noexcept : m_first{ nullptr }, m_last{ nullptr }, m_size{ 0 } {}
+
+        mailbox_batch(const mailbox_batch&) = delete;
+
+        mailbox_batch(mailbox_batch&& other) noexcept :
+            m_first{ std::exchange(other.m_first, nullptr) },
+            m_last{ std::exchange(other.m_last, nullptr) },
+            m_size{ std::exchange(other.m_size, 0) }
+        {
+        }
+
+        ~mailbox_batch() noexcept = default;
+
+        mailbox_batch& operator=(const mailbox_batch&) = delete;
+
+        mailbox_batch& operator=(mailbox_batch&& other) noexcept
+        {
+            if (this != &other)
+            {
+                m_first = std::exchange(other.m_first, nullptr);
+                m_last = std::exchange(other.m_last, nullptr);
+                m_size = std::exchange(other.m_size, 0);
+            }
+
+            return *this;
+        }
+
+        [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+
+        [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+
+        // Returns the next message, or nullptr once every message has been popped.
+        [[nodiscard]] T* pop() noexcept
+        {
+            mailbox_node* const first{ m_first };
+
+            if (first == nullptr)
+            {
+                return nullptr;
+            }
+
+            m_first = first->m_next.load();
+            first->m_next = nullptr;
+            --m_size;
+
+            if (m_first == nullptr)
+            {
+                m_last = nullptr;
+            }
+
+            return static_cast<T*>(first);
+        }
+
+    private:
+        friend struct mailbox<T>;
+
+        // Only called on nodes the consumer has taken out of the queue, which no producer writes to any more.
+        void push(mailbox_node* node) noexcept
+        {
+            node->m_next = nullptr;
+
+            if (m_last == nullptr)
+            {
+                m_first = node;
+            }
+            else
+            {
+                m_last->m_next = node;
+            }
+
+            m_last = node;
+            ++m_size;
+        }
+
+        mailbox_node* m_first;
+        mailbox_node* m_last;
+        std::size_t m_size;
+    };
+}
+
+namespace async::details
+{
+    // Counts the end of receive_batch's await_suspend plus the producer that found the consumer asleep, so whichever
+    // happens last resumes the consumer (never from within its own await_suspend).
+    struct mailbox_waiter final
+    {
+        mailbox_waiter() noexcept : m_awaiting{}, m_remaining{ 2 } {}
+
+        mailbox_waiter(const mailbox_waiter&) = delete;
+        mailbox_waiter(mailbox_waiter&&) noexcept = delete;
+
+        ~mailbox_waiter() noexcept = default;
+
+        mailbox_waiter& operator=(const mailbox_waiter&) = delete;
+        mailbox_waiter& operator=(mailbox_waiter&&) noexcept = delete;
+
+        void set_awaiting(std::coroutine_handle<> awaiting) noexcept { m_awaiting = awaiting; }
+
+        // Called at the end of await_suspend; returns true if the consumer must stay suspended.
+        [[nodiscard]] bool try_await() noexcept { return m_remaining.fetch_sub(1) != 1; }
+
+        // Called by the producer that posted the first message after the consumer went to sleep.
+        void complete() noexcept
+        {
+            if (m_remaining.fetch_sub(1) == 1)
+            {
+                m_awaiting.resume();
+            }
+        }
+
+    private:
+        std::coroutine_handle<> m_awaiting;
+        atomic_acq_rel<int> m_remaining;
+    };
+
+    template <typename T>
+    struct mailbox_receive_batch_operation final
+    {
+        explicit mailbox_receive_batch_operation(mailbox<T>& owner) noexcept :
+            m_mailbox{ owner }, m_waiter{}, m_batch{}
+        {
+        }
+
+        [[nodiscard]] bool await_ready() noexcept;
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle) noexcept;
+
+        [[nodiscard]] mailbox_batch<T> await_resume() noexcept;
+
+    private:
+        mailbox<T>& m_mailbox;
+        mailbox_waiter m_waiter;
+        mailbox_batch<T> m_batch;
+    };
+}
+
+namespace async
+{
+#ifdef _MSC_VER
+#pragma warning(push)
+// structure was padded due to alignment specifier
+#pragma warning(disable : 4324)
+#endif
+
+    // An unbounded mailbox for an actor-style consumer coroutine that processes messages one at a time, posted by any
+    // number of producers. Messages are intrusive (T derives from mailbox_node), so posting allocates nothing and is
+    // lock-free: post() is a single atomic exchange of the tail plus a store linking the message to its predecessor
+    // (Vyukov's MPSC queue). co_await receive_batch() drains every message available into a mailbox_batch, suspending
+    // only while the mailbox is empty; the consumer is resumed inline by the one post() that finds it asleep (the
+    // empty to non-empty transition), so other posts never touch the consumer's state.
+    // A message whose producer has exchanged the tail but not yet linked it (a window of two instructions) is not yet
+    // available; if it is the only message, receive_batch() yields the thread until it is linked.
+    // At most one receive_batch() may be outstanding at a time (one consumer), and the mailbox must not be destroyed
+    // while it is. Messages still in the mailbox when it is destroyed are not touched.
+    template <typename T>
+    struct mailbox final
+    {
+        static_assert(std::is_base_of_v<mailbox_node, T>, "The message type must derive from mailbox_node.");
+
+        mailbox() noexcept : m_head{ &m_stub }, m_stub{}, m_tail{ &m_stub }, m_asleep{}, m_waiter{ nullptr } {}
+
+        mailbox(const mailbox&) = delete;
+        mailbox(mailbox&&) noexcept = delete;
+
+        ~mailbox() noexcept
+        {
+            // The mailbox must not be destroyed while the consumer is waiting.
+            assert(m_tail.load() != &m_asleep);
+        }
+
+        mailbox& operator=(const mailbox&) = delete;
+        mailbox& operator=(mailbox&&) noexcept = delete;
+
+        // Posts a message, which stays owned by the caller but must stay alive (and not be posted elsewhere) until the
+        // consumer pops it from a batch. May be called from any thread.
+        void post(T& message) noexcept
+        {
+            mailbox_node* const node{ &message };
+            node->m_next = nullptr;
+            mailbox_node* const previous{ m_tail.exchange(node) };
+
+            if (previous != &m_asleep)
+            {
+                previous->m_next = node;
+                return;
+            }
+
+            // The consumer went to sleep on the empty mailbox (with the stub as the last node), and this is the first
+            // message since. Nothing may be read from this mailbox after resuming the consumer.
+            mailbox_waiter* const waiter{ m_waiter };
+            m_stub.m_next = node;
+            waiter->complete();
+        }
+
+        [[nodiscard]] details::mailbox_receive_batch_operation<T> receive_batch() noexcept
+        {
+            return details::mailbox_receive_batch_operation<T>{ *this };
+        }
+
+    private:
+        using mailbox_waiter = details::mailbox_waiter;
+
+        friend struct details::mailbox_receive_batch_operation<T>;
+
+        // Called only by the consumer. Returns the oldest message, or nullptr if the mailbox is empty or its oldest
+        // message is not linked yet.
+        [[nodiscard]] mailbox_node* try_pop() noexcept
+        {
+            mailbox_node* head{ m_head };
+            mailbox_node* next{ head->m_next.load() };
+
+            if (head == &m_stub)
+            {
+                if (next == nullptr)
+                {
+                    return nullptr;
+                }
+
+                m_head = next;
+                head = next;
+                next = next->m_next.load();
+            }
+
+            if (next != nullptr)
+            {
+                m_head = next;
+                return head;
+            }
+
+            if (m_tail.load() != head)
+            {
+                // A producer has exchanged the tail but not yet linked its message after head.
+                return nullptr;
+            }
+
+            // head is the last message, and its successor is written by whichever producer exchanges the tail next;
+            // post the stub behind it so head can be handed out.
+            push_stub();
+            next = head->m_next.load();
+
+            if (next != nullptr)
+            {
+                m_head = next;
+                return head;
+            }
+
+            return nullptr;
+        }
+
+        void push_stub() noexcept
+        {
+            m_stub.m_next = nullptr;
+            mailbox_node* const previous{ m_tail.exchange(&m_stub) };
+            previous->m_next = &m_stub;
+        }
+
+        // Called only by the consumer.
+        void drain(mailbox_batch<T>& batch) noexcept
+        {
+            while (mailbox_node* const node{ try_pop() })
+            {
+                batch.push(node);
+            }
+        }
+
+        // Called only by the consumer, after drain() found nothing. Returns false if a message was posted before the
+        // consumer could go to sleep (so it should not suspend).
+        [[nodiscard]] bool try_sleep(mailbox_waiter& waiter, std::coroutine_handle<> handle) noexcept
+        {
+            if (m_head != &m_stub || m_stub.m_next.load() != nullptr)
+            {
+                return false;
+            }
+
+            waiter.set_awaiting(handle);
+            m_waiter = &waiter;
+            mailbox_node* expected{ &m_stub };
+
+            // Publishes m_waiter to the producer whose exchange returns m_asleep.
+            if (!m_tail.compare_exchange_strong(expected, &m_asleep))
+            {
+                return false;
+            }
+
+            return waiter.try_await();
+        }
+
+        // Written by the consumer.
+        alignas(details::cache_line_size) mailbox_node* m_head;
+        mailbox_node m_stub;
+
+        // Exchanged by producers (and by the consumer, to post the stub or go to sleep).
+        alignas(details::cache_line_size) details::atomic_acq_rel<mailbox_node*> m_tail;
+
+        // Never linked; its address in m_tail means the consumer is asleep, waiting on m_waiter.
+        mailbox_node m_asleep;
+        mailbox_waiter* m_waiter;
+    };
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+namespace async::details
+{
+    template <typename T>
+    inline bool mailbox_receive_batch_operation<T>::await_ready() noexcept
+    {
+        m_mailbox.drain(m_batch);
+        return !m_batch.empty();
+    }
+
+    template <typename T>
+    inline bool mailbox_receive_batch_operation<T>::await_suspend(std::coroutine_handle<> handle) noexcept
+    {
+        return m_mailbox.try_sleep(m_waiter, handle);
+    }
+
+    template <typename T>
+    inline mailbox_batch<T> mailbox_receive_batch_operation<T>::await_resume() noexcept
+    {
+        m_mailbox.drain(m_batch);
+
+        // Not asleep, or woken, so a message has been posted; it may not be linked yet.
+        while (m_batch.empty())
+        {
+            std::this_thread::yield();
+            m_mailbox.drain(m_batch);
+        }
+
+        return std::move(m_batch);
+    }
+}
@@ -0,0 +1,783 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include "atomic_acq_rel.h"
+#include "select_state.h"
+
+namespace async
+{
+    template <typename T>
+    struct mpmc_channel;
+}
+
+namespace async::details
+{
+    // A sequence number tells producers and consumers whether the slot is ready for them: a slot for position p is free
+    // when its sequence is p and holds an item when its sequence is p + 1.
+    template <typename T>
+    struct mpmc_channel_slot final
+    {
+        atomic_acq_rel<std::uint64_t> sequence;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    template <typename T>
+    struct mpmc_channel_send_waiter final
+    {
+        T* value{};
+        bool sent{};
+        mpmc_channel_send_waiter* next{};
+        std::coroutine_handle<> handle{};
+
+        void resume() const { handle.resume(); }
+    };
+
+    // Waits for a single item (single is set) or for up to items.size() items. A waiter that is one alternative of a
+    // select (select is set) must claim the select before taking an item, and completes the select instead of resuming
+    // a coroutine.
+    template <typename T>
+    struct mpmc_channel_receive_waiter final
+    {
+        std::optional<T>* single{};
+        std::span<T> items{};
+        std::size_t received{};
+        select_state* select{};
+        std::size_t selectIndex{};
+        mpmc_channel_receive_waiter* next{};
+        std::coroutine_handle<> handle{};
+
+        void resume() const
+        {
+            if (select != nullptr)
+            {
+                select->complete();
+            }
+            else
+            {
+                handle.resume();
+            }
+        }
+    };
+
+    template <typename T>
+    struct mpmc_channel_send_operation final
+    {
+        mpmc_channel_send_operation(mpmc_channel<T>& channel, T&& value) :
+            m_channel{ channel }, m_value{ std::move(value) }, m_waiter{}
+        {
+        }
+
+        [[nodiscard]] bool await_ready();
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle);
+
+        // Returns true if the item was sent, or false if the channel was closed first.
+        [[nodiscard]] bool await_resume() const noexcept { return m_waiter.sent; }
+
+    private:
+        mpmc_channel<T>& m_channel;
+        T m_value;
+        mpmc_channel_send_waiter<T> m_waiter;
+    };
+
+    template <typename T>
+    struct mpmc_channel_receive_operation final
+    {
+        explicit mpmc_channel_receive_operation(mpmc_channel<T>& channel) noexcept :
+            m_channel{ channel }, m_value{}, m_waiter{}
+        {
+        }
+
+        [[nodiscard]] bool await_ready();
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle);
+
+        // Returns the item received, or nullopt if the channel was closed and is empty.
+        [[nodiscard]] std::optional<T> await_resume();
+
+        // Used by select instead of await_suspend; returns false if the waiter did not need to be queued (because this
+        // or another alternative completed the select).
+        [[nodiscard]] bool select_suspend(select_state& state, std::size_t index);
+
+        // Used by select to remove the waiter from the channel if it is still queued.
+        void select_cancel() noexcept;
+
+    private:
+        mpmc_channel<T>& m_channel;
+        std::optional<T> m_value;
+        mpmc_channel_receive_waiter<T> m_waiter;
+    };
+
+    template <typename T>
+    struct mpmc_channel_receive_many_operation final
+    {
+        mpmc_channel_receive_many_operation(mpmc_channel<T>& channel, std::span<T> items) noexcept :
+            m_channel{ channel }, m_waiter{}
+        {
+            m_waiter.items = items;
+        }
+
+        [[nodiscard]] bool await_ready();
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle);
+
+        // Returns the number of items received (at the start of the span), or zero if the channel was closed and is
+        // empty.
+        [[nodiscard]] std::size_t await_resume();
+
+    private:
+        mpmc_channel<T>& m_channel;
+        mpmc_channel_receive_waiter<T> m_waiter;
+    };
+}
+
+namespace async
+{
+#ifdef _MSC_VER
+#pragma warning(push)
+// structure was padded due to alignment specifier
+#pragma warning(disable : 4324)
+#endif
+
+    // A bounded channel between any number of producers and consumers, stored in a ring buffer of slots that each
+    // carry a sequence number (as in Dmitry Vyukov's bounded MPMC queue), so sending and receiving take a single
+    // compare-and-swap when the channel is neither full nor empty. co_await send(value) suspends while the channel is
+    // full (applying backpressure to producers), and co_await receive() suspends while it is empty. Waiting coroutines
+    // are resumed in FIFO order, inline on the thread that makes room or sends an item; the item (or slot) is handed
+    // to the waiter before it is resumed, so a resumed coroutine never needs to retry.
+    // close() resumes every waiting coroutine: waiting and later sends return false, and receives return the items
+    // still in the channel and then nullopt. Items sent concurrently with close() might not be received.
+    template <typename T>
+    struct mpmc_channel final
+    {
+        explicit mpmc_channel(std::size_t capacity) :
+            m_mask{ capacity - 1 }, m_slots{}, m_enqueuePosition{ 0 }, m_dequeuePosition{ 0 }, m_waitingSenders{ 0 },
+            m_waitingReceivers{ 0 }, m_mutex{}, m_closed{ false }, m_senders{}, m_lastSender{}, m_receivers{},
+            m_lastReceiver{}
+        {
+            // With a single slot, a full slot's sequence number would be indistinguishable from the next free one.
+            if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+            {
+                throw std::invalid_argument{ "The capacity must be a power of two greater than one." };
+            }
+
+            m_slots = std::make_unique<details::mpmc_channel_slot<T>[]>(capacity);
+
+            for (std::size_t index = 0; index != capacity; ++index)
+            {
+                m_slots[index].sequence = index;
+            }
+        }
+
+        mpmc_channel(const mpmc_channel&) = delete;
+        mpmc_channel(mpmc_channel&&) noexcept = delete;
+
+        ~mpmc_channel() noexcept
+        {
+            // The channel must not be destroyed while any coroutines are waiting.
+            assert(m_senders == nullptr);
+            assert(m_receivers == nullptr);
+
+            for (std::uint64_t position = m_dequeuePosition.load(); position != m_enqueuePosition.load(); ++position)
+            {
+                details::mpmc_channel_slot<T>& slot{ slot_at(position) };
+
+                if (slot.sequence.load() == position + 1)
+                {
+                    item(slot).~T();
+                }
+            }
+        }
+
+        mpmc_channel& operator=(const mpmc_channel&) = delete;
+        mpmc_channel& operator=(mpmc_channel&&) noexcept = delete;
+
+        [[nodiscard]] std::size_t capacity() const noexcept { return m_mask + 1; }
+
+        [[nodiscard]] details::mpmc_channel_send_operation<T> send(T value)
+        {
+            return details::mpmc_channel_send_operation<T>{ *this, std::move(value) };
+        }
+
+        [[nodiscard]] details::mpmc_channel_receive_operation<T> receive() noexcept
+        {
+            return details::mpmc_channel_receive_operation<T>{ *this };
+        }
+
+        // Waits until at least one item is available, then receives as many as are available (up to items.size()),
+        // claiming consecutive items with a single compare-and-swap where possible.
+        [[nodiscard]] details::mpmc_channel_receive_many_operation<T> receive_many(std::span<T> items)
+        {
+            if (items.empty())
+            {
+                throw std::invalid_argument{ "The span must not be empty." };
+            }
+
+            return details::mpmc_channel_receive_many_operation<T>{ *this, items };
+        }
+
+        // Sends without waiting (for callers that cannot suspend) if there is room and the channel is not closed;
+        // otherwise returns false and leaves value unchanged.
+        [[nodiscard]] bool try_send(T& value)
+        {
+            if (closed() || !try_push(value))
+            {
+                return false;
+            }
+
+            resume_receivers();
+            return true;
+        }
+
+        void close()
+        {
+            send_waiter* senders{};
+            receive_waiter* receivers{};
+
+            {
+                std::lock_guard<std::mutex> mutexLock{ m_mutex };
+                m_closed = true;
+                senders = std::exchange(m_senders, nullptr);
+                m_lastSender = nullptr;
+                m_waitingSenders = 0;
+                m_waitingReceivers = 0;
+                receive_waiter* last{};
+
+                // Select waiters that lost to another alternative must be dropped while the lock still keeps them
+                // alive.
+                while (m_receivers != nullptr)
+                {
+                    receive_waiter& receiver{ unlink_first(m_receivers, m_lastReceiver) };
+
+                    if (receiver.select == nullptr || receiver.select->try_claim(receiver.selectIndex))
+                    {
+                        append(receivers, last, receiver);
+                    }
+                }
+            }
+
+            resume_all(senders);
+            resume_all(receivers);
+        }
+
+    private:
+        using send_waiter = details::mpmc_channel_send_waiter<T>;
+        using receive_waiter = details::mpmc_channel_receive_waiter<T>;
+
+        friend struct details::mpmc_channel_send_operation<T>;
+        friend struct details::mpmc_channel_receive_operation<T>;
+        friend struct details::mpmc_channel_receive_many_operation<T>;
+
+        [[nodiscard]] bool closed() const noexcept { return m_closed.load(); }
+
+        [[nodiscard]] details::mpmc_channel_slot<T>& slot_at(std::uint64_t position) const noexcept
+        {
+            return m_slots[static_cast<std::size_t>(position & m_mask)];
+        }
+
+        [[nodiscard]] static T& item(details::mpmc_channel_slot<T>& slot) noexcept
+        {
+            return *std::launder(reinterpret_cast<T*>(slot.storage));
+        }
+
+        // Moves value into the channel unless it is full. Does not resume waiting receivers.
+        [[nodiscard]] bool try_push(T& value)
+        {
+            std::uint64_t position{ m_enqueuePosition.load() };
+
+            while (true)
+            {
+                details::mpmc_channel_slot<T>& slot{ slot_at(position) };
+                const std::uint64_t sequence{ slot.sequence.load() };
+
+                if (sequence == position)
+                {
+                    if (m_enqueuePosition.compare_exchange_weak(position, position + 1))
+                    {
+                        ::new (static_cast<void*>(slot.storage)) T{ std::move(value) };
+                        slot.sequence = position + 1;
+                        return true;
+                    }
+                }
+                else if (sequence < position)
+                {
+                    // The slot still holds the item from the previous lap.
+                    return false;
+                }
+                else
+                {
+                    position = m_enqueuePosition.load();
+                }
+            }
+        }
+
+        // Moves up to maxCount consecutive items out of the channel (claiming them with a single compare-and-swap),
+        // passing each with its index to sink; returns the number of items moved. Does not resume waiting senders.
+        template <typename Sink>
+        [[nodiscard]] std::size_t try_pop(std::size_t maxCount, Sink sink)
+        {
+            std::uint64_t position{ m_dequeuePosition.load() };
+            std::size_t count{};
+
+            while (true)
+            {
+                count = 0;
+
+                while (count != maxCount && slot_at(position + count).sequence.load() == position + count + 1)
+                {
+                    ++count;
+                }
+
+                if (count == 0)
+                {
+                    if (slot_at(position).sequence.load() < position + 1)
+                    {
+                        return 0;
+                    }
+
+                    position = m_dequeuePosition.load();
+                }
+                else if (m_dequeuePosition.compare_exchange_weak(position, position + count))
+                {
+                    break;
+                }
+            }
+
+            for (std::size_t index = 0; index != count; ++index)
+            {
+                details::mpmc_channel_slot<T>& slot{ slot_at(position + index) };
+                T& stored{ item(slot) };
+                sink(index, std::move(stored));
+                stored.~T();
+                slot.sequence = position + index + m_mask + 1;
+            }
+
+            return count;
+        }
+
+        [[nodiscard]] bool try_pop(std::optional<T>& value)
+        {
+            return try_pop(1, [&value](std::size_t, T&& received) { value.emplace(std::move(received)); }) != 0;
+        }
+
+        [[nodiscard]] bool try_pop(receive_waiter& waiter)
+        {
+            if (waiter.single != nullptr)
+            {
+                return try_pop(*waiter.single);
+            }
+
+            const std::span<T> items{ waiter.items.subspan(waiter.received) };
+            waiter.received += try_pop(items.size(),
+                [items](std::size_t index, T&& received) { items[index] = std::move(received); });
+            return waiter.received != 0;
+        }
+
+        enum class select_pop_result
+        {
+            received,
+            empty,
+
+            // Another alternative of the select won, so the waiter must be dropped.
+            lost
+        };
+
+        // Takes an item for a select waiter only if the waiter can claim its select, holding the claim tentatively
+        // while taking the item so the select is never completed without one.
+        [[nodiscard]] select_pop_result try_pop_for_select(receive_waiter& waiter)
+        {
+            if (!waiter.select->begin_claim())
+            {
+                return select_pop_result::lost;
+            }
+
+            const bool received{ try_pop(1,
+                [&waiter](std::size_t, T&& item) { waiter.single->emplace(std::move(item)); }) != 0 };
+            waiter.select->end_claim(waiter.selectIndex, received);
+            return received ? select_pop_result::received : select_pop_result::empty;
+        }
+
+        // Receives without waiting if any items are available; otherwise returns false.
+        template <typename Destination>
+        [[nodiscard]] bool try_receive(Destination& destination)
+        {
+            if (!try_pop(destination))
+            {
+                return false;
+            }
+
+            resume_senders();
+            return true;
+        }
+
+        // Returns false if the waiter did not need to be queued (because the item was sent or the channel was
+        // closed).
+        [[nodiscard]] bool try_enqueue(send_waiter& waiter)
+        {
+            {
+                std::lock_guard<std::mutex> mutexLock{ m_mutex };
+
+                if (m_closed.load())
+                {
+                    return false;
+                }
+
+                // A receiver frees a slot before checking m_waitingSenders, and this sender counted itself before
+                // trying again, so at least one side sees the other; the mutex then orders the handoff.
+                m_waitingSenders.fetch_add(1);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                if (!try_push(*waiter.value))
+                {
+                    append(m_senders, m_lastSender, waiter);
+                    return true;
+                }
+
+                m_waitingSenders.fetch_sub(1);
+                waiter.sent = true;
+            }
+
+            resume_receivers();
+            return false;
+        }
+
+        // Returns false if the waiter did not need to be queued (because an item was received or the channel was
+        // closed).
+        [[nodiscard]] bool try_enqueue(receive_waiter& waiter)
+        {
+            {
+                std::lock_guard<std::mutex> mutexLock{ m_mutex };
+
+                if (m_closed.load())
+                {
+                    // A closed channel completes a select (with any items that remain, or nullopt).
+                    if (waiter.select != nullptr && waiter.select->try_claim(waiter.selectIndex))
+                    {
+                        waiter.select->complete();
+                    }
+
+                    return false;
+                }
+
+                // See the sending overload.
+                m_waitingReceivers.fetch_add(1);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                if (waiter.select != nullptr)
+                {
+                    const select_pop_result result{ try_pop_for_select(waiter) };
+
+                    if (result == select_pop_result::empty)
+                    {
+                        append(m_receivers, m_lastReceiver, waiter);
+                        return true;
+                    }
+
+                    m_waitingReceivers.fetch_sub(1);
+
+                    if (result == select_pop_result::lost)
+                    {
+                        return false;
+                    }
+
+                    waiter.select->complete();
+                }
+                else if (!try_pop(waiter))
+                {
+                    append(m_receivers, m_lastReceiver, waiter);
+                    return true;
+                }
+                else
+                {
+                    m_waitingReceivers.fetch_sub(1);
+                }
+            }
+
+            resume_senders();
+            return false;
+        }
+
+        // Removes a select waiter that is still queued (one that lost was either dropped already or is dropped here).
+        void try_dequeue(receive_waiter& waiter) noexcept
+        {
+            std::lock_guard<std::mutex> mutexLock{ m_mutex };
+            receive_waiter* previous{};
+
+            for (receive_waiter* current = m_receivers; current != nullptr; current = current->next)
+            {
+                if (current == &waiter)
+                {
+                    (previous == nullptr ? m_receivers : previous->next) = waiter.next;
+
+                    if (m_lastReceiver == &waiter)
+                    {
+                        m_lastReceiver = previous;
+                    }
+
+                    m_waitingReceivers.fetch_sub(1);
+                    return;
+                }
+
+                previous = current;
+            }
+        }
+
+        // Hands newly freed slots to waiting senders, in FIFO order. The mutex is released before resuming them (and
+        // before resuming any receivers waiting for the items just sent on their behalf).
+        void resume_senders()
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (m_waitingSenders.load() == 0)
+            {
+                return;
+            }
+
+            send_waiter* ready{};
+
+            {
+                std::lock_guard<std::mutex> mutexLock{ m_mutex };
+                send_waiter* last{};
+
+                while (m_senders != nullptr && try_push(*m_senders->value))
+                {
+                    send_waiter& sender{ unlink_first(m_senders, m_lastSender) };
+                    m_waitingSenders.fetch_sub(1);
+                    sender.sent = true;
+                    append(ready, last, sender);
+                }
+            }
+
+            if (ready != nullptr)
+            {
+                resume_receivers();
+                resume_all(ready);
+            }
+        }
+
+        // Hands newly sent items to waiting receivers, in FIFO order. The mutex is released before resuming them (and
+        // before resuming any senders waiting for the slots just freed on their behalf).
+        void resume_receivers()
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (m_waitingReceivers.load() == 0)
+            {
+                return;
+            }
+
+            receive_waiter* ready{};
+
+            {
+                std::lock_guard<std::mutex> mutexLock{ m_mutex };
+                receive_waiter* last{};
+
+                while (m_receivers != nullptr)
+                {
+                    if (m_receivers->select != nullptr)
+                    {
+                        const select_pop_result result{ try_pop_for_select(*m_receivers) };
+
+                        if (result == select_pop_result::empty)
+                        {
+                            break;
+                        }
+
+                        receive_waiter& receiver{ unlink_first(m_receivers, m_lastReceiver) };
+                        m_waitingReceivers.fetch_sub(1);
+
+                        if (result == select_pop_result::received)
+                        {
+                            append(ready, last, receiver);
+                        }
+                    }
+                    else if (try_pop(*m_receivers))
+                    {
+                        receive_waiter& receiver{ unlink_first(m_receivers, m_lastReceiver) };
+                        m_waitingReceivers.fetch_sub(1);
+                        append(ready, last, receiver);
+                    }
+                    else
+                    {
+                        break;
+                    }
+                }
+            }
+
+            if (ready != nullptr)
+            {
+                resume_senders();
+                resume_all(ready);
+            }
+        }
+
+        template <typename Waiter>
+        static void append(Waiter*& first, Waiter*& last, Waiter& waiter) noexcept
+        {
+            waiter.next = nullptr;
+
+            if (last == nullptr)
+            {
+                first = &waiter;
+            }
+            else
+            {
+                last->next = &waiter;
+            }
+
+            last = &waiter;
+        }
+
+        template <typename Waiter>
+        [[nodiscard]] static Waiter& unlink_first(Waiter*& first, Waiter*& last) noexcept
+        {
+            Waiter& waiter{ *first };
+            first = waiter.next;
+
+            if (first == nullptr)
+            {
+                last = nullptr;
+            }
+
+            return waiter;
+        }
+
+        template <typename Waiter>
+        static void resume_all(Waiter* waiter) noexcept
+        {
+            while (waiter != nullptr)
+            {
+                // Read next before resuming; the resumed coroutine may destroy the waiter.
+                Waiter* const following{ waiter->next };
+                waiter->resume();
+                waiter = following;
+            }
+        }
+
+        const std::size_t m_mask;
+        std::unique_ptr<details::mpmc_channel_slot<T>[]> m_slots;
+
+        // Positions increase without wrapping in practice (they are 64-bit) and are masked to find a slot. Each is
+        // kept on its own cache line, as are the waiter counts that every send and receive polls.
+        details::padded_atomic_acq_rel<std::uint64_t> m_enqueuePosition;
+        details::padded_atomic_acq_rel<std::uint64_t> m_dequeuePosition;
+        details::padded_atomic_acq_rel<std::size_t> m_waitingSenders;
+        details::padded_atomic_acq_rel<std::size_t> m_waitingReceivers;
+
+        // Guards the waiter queues, which are used only when the channel is full or empty (or when closing).
+        std::mutex m_mutex;
+        details::atomic_acq_rel<bool> m_closed;
+        details::mpmc_channel_send_waiter<T>* m_senders;
+        details::mpmc_channel_send_waiter<T>* m_lastSender;
+        details::mpmc_channel_receive_waiter<T>* m_receivers;
+        details::mpmc_channel_receive_waiter<T>* m_lastReceiver;
+    };
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+namespace async::details
+{
+    template <typename T>
+    inline bool mpmc_channel_send_operation<T>::await_ready()
+    {
+        if (m_channel.closed())
+        {
+            return true;
+        }
+
+        m_waiter.sent = m_channel.try_send(m_value);
+        return m_waiter.sent;
+    }
+
+    template <typename T>
+    inline bool mpmc_channel_send_operation<T>::await_suspend(std::coroutine_handle<> handle)
+    {
+        m_waiter.value = std::addressof(m_value);
+        m_waiter.handle = handle;
+        return m_channel.try_enqueue(m_waiter);
+    }
+
+    template <typename T>
+    inline bool mpmc_channel_receive_operation<T>::await_ready()
+    {
+        return m_channel.try_receive(m_value) || m_channel.closed();
+    }
+
+    template <typename T>
+    inline bool mpmc_channel_receive_operation<T>::await_suspend(std::coroutine_handle<> handle)
+    {
+        m_waiter.single = std::addressof(m_value);
+        m_waiter.handle = handle;
+        return m_channel.try_enqueue(m_waiter);
+    }
+
+    template <typename T>
+    inline std::optional<T> mpmc_channel_receive_operation<T>::await_resume()
+    {
+        // Without an item, the channel was closed; receive any items that remain.
+        if (!m_value.has_value())
+        {
+            std::ignore = m_channel.try_receive(m_value);
+        }
+
+        return std::move(m_value);
+    }
+
+    template <typename T>
+    inline bool mpmc_channel_receive_operation<T>::select_suspend(select_state& state, std::size_t index)
+    {
+        m_waiter.single = std::addressof(m_value);
+        m_waiter.select = std::addressof(state);
+        m_waiter.selectIndex = index;
+        return m_channel.try_enqueue(m_waiter);
+    }
+
+    template <typename T>
+    inline void mpmc_channel_receive_operation<T>::select_cancel() noexcept
+    {
+        m_channel.try_dequeue(m_waiter);
+    }
+
+    template <typename T>
+    inline bool mpmc_channel_receive_many_operation<T>::await_ready()
+    {
+        return m_channel.try_receive(m_waiter) || m_channel.closed();
+    }
+
+    template <typename T>
+    inline bool mpmc_channel_receive_many_operation<T>::await_suspend(std::coroutine_handle<> handle)
+    {
+        m_waiter.handle = handle;
+        return m_channel.try_enqueue(m_waiter);
+    }
+
+    template <typename T>
+    inline std::size_t mpmc_channel_receive_many_operation<T>::await_resume()
+    {
+        // A waiter is handed only the items available when it is resumed; fill the rest of the span with any items
+        // sent since (or, if the channel was closed, with any items that remain).
+        if (m_waiter.received != m_waiter.items.size())
+        {
+            std::ignore = m_channel.try_receive(m_waiter);
+        }
+
+        return m_waiter.received;
+    }
+}
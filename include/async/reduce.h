@@ -0,0 +1,399 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "atomic_acq_rel.h"
+#include "awaitable_resume_t.h"
+#include "task.h"
+#include "thread_pool.h"
+
+namespace async::details
+{
+    // A bump allocator for coroutine frames that are all allocated on one thread before any of them runs, and are
+    // freed together when the arena is destroyed. The first allocation reserves room for expectedCount frames of its
+    // size, so a batch of identical frames needs a single heap allocation.
+    struct frame_arena final
+    {
+        explicit frame_arena(std::size_t expectedCount) noexcept :
+            m_expectedCount{ std::max<std::size_t>(expectedCount, 1) }, m_blocks{}, m_next{}, m_end{}
+        {
+        }
+
+        frame_arena(const frame_arena&) = delete;
+        frame_arena(frame_arena&&) noexcept = delete;
+
+        ~frame_arena() noexcept = default;
+
+        frame_arena& operator=(const frame_arena&) = delete;
+        frame_arena& operator=(frame_arena&&) noexcept = delete;
+
+        [[nodiscard]] void* allocate(std::size_t size)
+        {
+            constexpr std::size_t alignment{ __STDCPP_DEFAULT_NEW_ALIGNMENT__ };
+            size = (size + alignment - 1) / alignment * alignment;
+
+            if (static_cast<std::size_t>(m_end - m_next) < size)
+            {
+                const std::size_t blockSize{ size * m_expectedCount };
+                m_blocks.emplace_back(new std::byte[blockSize]);
+                m_next = m_blocks.back().get();
+                m_end = m_next + blockSize;
+            }
+
+            void* frame{ m_next };
+            m_next += size;
+            return frame;
+        }
+
+    private:
+        const std::size_t m_expectedCount;
+        std::vector<std::unique_ptr<std::byte[]>> m_blocks;
+        std::byte* m_next;
+        std::byte* m_end;
+    };
+
+    template <typename State>
+    struct reduce_leaf;
+
+    // Runs one chunk. Frames come from the reduce's arena, so freeing one does nothing; when the chunk finishes, the
+    // final awaiter reports it to the state (which may resume the awaiting coroutine) after the frame has suspended.
+    template <typename State>
+    struct reduce_leaf_promise final
+    {
+        struct final_awaiter final
+        {
+            [[nodiscard]] constexpr bool await_ready() const noexcept { return false; }
+
+            void await_suspend(std::coroutine_handle<reduce_leaf_promise> handle) const noexcept
+            {
+                handle.promise().state.complete_leaf(handle.promise().node);
+            }
+
+            constexpr void await_resume() const noexcept {}
+        };
+
+        reduce_leaf_promise(frame_arena&, State& owner, std::size_t, std::size_t leafNode) noexcept :
+            state{ owner }, node{ leafNode }
+        {
+        }
+
+        [[nodiscard]] static void* operator new(std::size_t size, frame_arena& arena, State&, std::size_t, std::size_t)
+        {
+            return arena.allocate(size);
+        }
+
+        static void operator delete(void*, std::size_t) noexcept {}
+
+        reduce_leaf<State> get_return_object() noexcept;
+
+        constexpr std::suspend_always initial_suspend() const noexcept { return {}; }
+
+        constexpr final_awaiter final_suspend() const noexcept { return {}; }
+
+        constexpr void return_void() const noexcept {}
+
+        void unhandled_exception() const noexcept { state.fail(std::current_exception()); }
+
+        State& state;
+        const std::size_t node;
+    };
+
+    template <typename State>
+    struct reduce_leaf final
+    {
+        using promise_type = reduce_leaf_promise<State>;
+
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    template <typename State>
+    inline reduce_leaf<State> reduce_leaf_promise<State>::get_return_object() noexcept
+    {
+        return reduce_leaf<State>{ std::coroutine_handle<reduce_leaf_promise>::from_promise(*this) };
+    }
+
+    template <typename MapFn, typename Iterator>
+    using reduce_map_result_t = std::invoke_result_t<MapFn&, Iterator, Iterator>;
+
+    template <typename MapFn, typename Iterator, typename = void>
+    struct reduce_result final
+    {
+        using type = reduce_map_result_t<MapFn, Iterator>;
+    };
+
+    template <typename MapFn, typename Iterator>
+    struct reduce_result<MapFn, Iterator, std::enable_if_t<is_awaitable_v<reduce_map_result_t<MapFn, Iterator>>>> final
+    {
+        using type = awaitable_resume_t<reduce_map_result_t<MapFn, Iterator>>;
+    };
+
+    template <typename MapFn, typename Iterator>
+    using reduce_result_t = typename reduce_result<MapFn, Iterator>::type;
+
+    // Partial results are combined in a binary tree whose leaves are the chunks in order, so combining takes
+    // O(log chunks) steps after the last chunk finishes and runs in parallel across subtrees. Whichever child of a
+    // node finishes second combines both and continues toward the root, on its own thread.
+    template <typename T, typename Iterator, typename MapFn, typename CombineFn, typename Executor>
+    struct reduce_state final
+    {
+        reduce_state(Iterator first, std::size_t count, std::size_t chunkSize, MapFn mapFn, CombineFn combineFn,
+            Executor executor) :
+            m_first{ first },
+            m_count{ count },
+            m_chunkSize{ chunkSize },
+            m_chunkCount{ (count + chunkSize - 1) / chunkSize },
+            m_mapFn{ std::move(mapFn) },
+            m_combineFn{ std::move(combineFn) },
+            m_executor{ std::move(executor) },
+            m_nodes{ new node[m_chunkCount * 2 - 1] },
+            m_leafNodes{},
+            m_arena{ m_chunkCount },
+            m_leaves{},
+            m_failed{ false },
+            m_exception{},
+            m_remaining{ 2 },
+            m_awaiting{}
+        {
+            std::size_t nextNode{};
+            m_leafNodes.reserve(m_chunkCount);
+            build(0, m_chunkCount, 0, nextNode);
+        }
+
+        reduce_state(const reduce_state&) = delete;
+        reduce_state(reduce_state&&) noexcept = delete;
+
+        ~reduce_state() noexcept
+        {
+            for (std::coroutine_handle<> leaf : m_leaves)
+            {
+                leaf.destroy();
+            }
+        }
+
+        reduce_state& operator=(const reduce_state&) = delete;
+        reduce_state& operator=(reduce_state&&) noexcept = delete;
+
+        // Returns true if the awaiting coroutine must suspend.
+        [[nodiscard]] bool start(std::coroutine_handle<> awaiting)
+        {
+            m_awaiting = awaiting;
+            m_leaves.reserve(m_chunkCount);
+
+            // Every frame is allocated before any chunk runs, so the arena is only ever used on this thread.
+            for (std::size_t chunk = 0; chunk != m_chunkCount; ++chunk)
+            {
+                m_leaves.push_back(run_leaf(m_arena, *this, chunk, m_leafNodes[chunk]).handle);
+            }
+
+            for (std::coroutine_handle<> leaf : m_leaves)
+            {
+                std::invoke(m_executor, leaf);
+            }
+
+            return m_remaining.fetch_sub(1) > 1;
+        }
+
+        void fail(const std::exception_ptr& exception) noexcept
+        {
+            bool expected{ false };
+
+            if (m_failed.compare_exchange_strong(expected, true))
+            {
+                m_exception = exception;
+            }
+        }
+
+        void complete_leaf(std::size_t index) noexcept
+        {
+            while (index != 0)
+            {
+                node& parent{ m_nodes[m_nodes[index].parent] };
+
+                // The first child to finish leaves the combining to its sibling.
+                if (parent.arrived.fetch_add(1) == 0)
+                {
+                    return;
+                }
+
+                node& left{ m_nodes[parent.left] };
+                node& right{ m_nodes[parent.right] };
+
+                if (left.value && right.value)
+                {
+                    try
+                    {
+                        parent.value.emplace(std::invoke(m_combineFn, std::move(*left.value), std::move(*right.value)));
+                    }
+                    catch (...)
+                    {
+                        fail(std::current_exception());
+                    }
+                }
+
+                left.value.reset();
+                right.value.reset();
+                index = m_nodes[index].parent;
+            }
+
+            if (m_remaining.fetch_sub(1) == 1)
+            {
+                m_awaiting.resume();
+            }
+        }
+
+        // Called only after every chunk has finished.
+        [[nodiscard]] T take_result()
+        {
+            if (m_exception)
+            {
+                std::rethrow_exception(m_exception);
+            }
+
+            return std::move(*m_nodes[0].value);
+        }
+
+    private:
+        struct node final
+        {
+            std::size_t parent{};
+            std::size_t left{};
+            std::size_t right{};
+            atomic_acq_rel<int> arrived{ 0 };
+            std::optional<T> value{};
+        };
+
+        // Numbers the nodes for chunks [first, last) in preorder, recording each chunk's leaf node.
+        std::size_t build(std::size_t first, std::size_t last, std::size_t parent, std::size_t& nextNode)
+        {
+            const std::size_t index{ nextNode++ };
+            m_nodes[index].parent = parent;
+
+            if (last - first == 1)
+            {
+                m_leafNodes.push_back(index);
+            }
+            else
+            {
+                const std::size_t middle{ first + (last - first) / 2 };
+                m_nodes[index].left = build(first, middle, index, nextNode);
+                m_nodes[index].right = build(middle, last, index, nextNode);
+            }
+
+            return index;
+        }
+
+        static reduce_leaf<reduce_state> run_leaf(frame_arena&, reduce_state& state, std::size_t chunk, std::size_t)
+        {
+            // Once any chunk has failed, the remaining chunks are skipped.
+            if (state.m_failed.load())
+            {
+                co_return;
+            }
+
+            const std::size_t begin{ chunk * state.m_chunkSize };
+            const std::size_t end{ std::min(state.m_count, begin + state.m_chunkSize) };
+            const Iterator first{ state.m_first + static_cast<std::ptrdiff_t>(begin) };
+            const Iterator last{ state.m_first + static_cast<std::ptrdiff_t>(end) };
+            node& leaf{ state.m_nodes[state.m_leafNodes[chunk]] };
+
+            if constexpr (is_awaitable_v<reduce_map_result_t<MapFn, Iterator>>)
+            {
+                leaf.value.emplace(co_await std::invoke(state.m_mapFn, first, last));
+            }
+            else
+            {
+                leaf.value.emplace(std::invoke(state.m_mapFn, first, last));
+            }
+        }
+
+        const Iterator m_first;
+        const std::size_t m_count;
+        const std::size_t m_chunkSize;
+        const std::size_t m_chunkCount;
+        MapFn m_mapFn;
+        CombineFn m_combineFn;
+        Executor m_executor;
+        std::unique_ptr<node[]> m_nodes;
+        std::vector<std::size_t> m_leafNodes;
+        frame_arena m_arena;
+        std::vector<std::coroutine_handle<>> m_leaves;
+        atomic_acq_rel<bool> m_failed;
+        std::exception_ptr m_exception;
+        atomic_acq_rel<int> m_remaining;
+        std::coroutine_handle<> m_awaiting;
+    };
+
+    template <typename State>
+    struct reduce_operation final
+    {
+        explicit reduce_operation(State& state) noexcept : m_state{ state } {}
+
+        [[nodiscard]] constexpr bool await_ready() const noexcept { return false; }
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle) { return m_state.start(handle); }
+
+        constexpr void await_resume() const noexcept {}
+
+    private:
+        State& m_state;
+    };
+}
+
+namespace async
+{
+    // Splits range into chunks of chunkSize elements, calls mapFn(first, last) for each chunk on executor (see
+    // awaitable_then), and combines the partial results with combineFn(left, right) in a binary tree, preserving chunk
+    // order (so combineFn must be associative, but need not be commutative). mapFn may return a value or an awaitable;
+    // mapFn and combineFn may be called concurrently from several threads. Chunk coroutine frames are placed in a
+    // single arena allocation, so nothing is allocated per chunk. If any call throws, chunks not yet started are
+    // skipped and the first exception is rethrown once every chunk has finished. range must be a non-empty random
+    // access range that outlives the returned task.
+    template <typename Range, typename MapFn, typename CombineFn, typename Executor>
+    auto reduce(Range&& range, std::size_t chunkSize, MapFn mapFn, CombineFn combineFn, Executor executor)
+        -> task<details::reduce_result_t<MapFn, decltype(std::begin(range))>>
+    {
+        using Iterator = decltype(std::begin(range));
+        using T = details::reduce_result_t<MapFn, Iterator>;
+        static_assert(std::is_base_of_v<std::random_access_iterator_tag,
+                          typename std::iterator_traits<Iterator>::iterator_category>,
+            "The range must be a random access range.");
+
+        if (chunkSize == 0)
+        {
+            throw std::invalid_argument{ "The chunk size must not be zero." };
+        }
+
+        const std::size_t count{ static_cast<std::size_t>(std::distance(std::begin(range), std::end(range))) };
+
+        if (count == 0)
+        {
+            throw std::invalid_argument{ "The range must not be empty." };
+        }
+
+        details::reduce_state<T, Iterator, MapFn, CombineFn, Executor> state{ std::begin(range), count, chunkSize,
+            std::move(mapFn), std::move(combineFn), std::move(executor) };
+        co_await details::reduce_operation<decltype(state)>{ state };
+        co_return state.take_result();
+    }
+
+    // Like reduce(range, chunkSize, mapFn, combineFn, executor), running chunks on thread_pool::shared().
+    template <typename Range, typename MapFn, typename CombineFn>
+    auto reduce(Range&& range, std::size_t chunkSize, MapFn mapFn, CombineFn combineFn)
+        -> task<details::reduce_result_t<MapFn, decltype(std::begin(range))>>
+    {
+        return reduce(std::forward<Range>(range), chunkSize, std::move(mapFn), std::move(combineFn),
+            thread_pool::shared().executor());
+    }
+}
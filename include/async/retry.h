@@ -0,0 +1,149 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+#include "awaitable_resume_t.h"
+#include "task.h"
+#include "task_canceled.h"
+#include "timer_service.h"
+
+namespace async
+{
+    // Controls how retry() re-invokes a failed operation. Before attempt n + 1, retry() waits for
+    // min(initialDelay * multiplier^(n - 1), maxDelay), reduced by a random fraction of up to jitter (so that many
+    // callers failing at once do not all retry at once).
+    struct retry_policy final
+    {
+        // The total number of attempts, including the first.
+        std::size_t maxAttempts{ 3 };
+        std::chrono::microseconds initialDelay{ std::chrono::milliseconds{ 100 } };
+        std::chrono::microseconds maxDelay{ std::chrono::seconds{ 10 } };
+        double multiplier{ 2.0 };
+
+        // The fraction (from 0 to 1) of each delay that may be randomly removed.
+        double jitter{ 0.5 };
+
+        // Decides whether a failure may be retried. If empty, every exception except task_canceled is retried.
+        std::function<bool(const std::exception_ptr&)> retryable{};
+    };
+}
+
+namespace async::details
+{
+    inline void validate_retry_policy(const retry_policy& policy)
+    {
+        if (policy.maxAttempts == 0)
+        {
+            throw std::invalid_argument{ "The maximum number of attempts must not be zero." };
+        }
+
+        if (policy.multiplier < 1.0)
+        {
+            throw std::invalid_argument{ "The multiplier must not be less than one." };
+        }
+
+        if (policy.jitter < 0.0 || policy.jitter > 1.0)
+        {
+            throw std::invalid_argument{ "The jitter must be between zero and one." };
+        }
+    }
+
+    [[nodiscard]] inline bool is_retryable(const retry_policy& policy, const std::exception_ptr& exception)
+    {
+        if (policy.retryable)
+        {
+            return policy.retryable(exception);
+        }
+
+        try
+        {
+            std::rethrow_exception(exception);
+        }
+        catch (const task_canceled&)
+        {
+            return false;
+        }
+        catch (...)
+        {
+            return true;
+        }
+    }
+
+    // Returns the delay to wait after the given (one-based) failed attempt.
+    [[nodiscard]] inline std::chrono::microseconds retry_delay(const retry_policy& policy, std::size_t attempt)
+    {
+        thread_local std::minstd_rand engine{ std::random_device{}() };
+
+        const double exponential{ static_cast<double>(policy.initialDelay.count()) *
+                                  std::pow(policy.multiplier, static_cast<double>(attempt - 1)) };
+        const double capped{ std::min(exponential, static_cast<double>(policy.maxDelay.count())) };
+        const double jittered{ capped * (1.0 - policy.jitter * std::uniform_real_distribution<double>{}(engine)) };
+        return std::chrono::microseconds{ static_cast<std::chrono::microseconds::rep>(jittered) };
+    }
+
+    // Calls factory(stopToken) if factory accepts a std::stop_token, and factory() otherwise.
+    template <typename Factory>
+    decltype(auto) invoke_retry_factory(Factory& factory, const std::stop_token& stopToken)
+    {
+        if constexpr (std::is_invocable_v<Factory&, const std::stop_token&>)
+        {
+            return std::invoke(factory, stopToken);
+        }
+        else
+        {
+            return std::invoke(factory);
+        }
+    }
+
+    template <typename Factory>
+    using retry_result_t = awaitable_resume_t<decltype(invoke_retry_factory(
+        std::declval<Factory&>(), std::declval<const std::stop_token&>()))>;
+}
+
+namespace async
+{
+    // Awaits the awaitable returned by factory, calling factory again after each retryable failure (as decided by
+    // policy.retryable) until an attempt succeeds or policy.maxAttempts attempts have failed, in which case the last
+    // failure is rethrown. Between attempts, retry() waits for an exponentially increasing, jittered delay on timers,
+    // without blocking a thread. factory may optionally take a std::stop_token, which is passed stopToken; if stop is
+    // requested, no further attempts are started, and a pending delay ends by throwing task_canceled.
+    template <typename Factory>
+    task<details::retry_result_t<Factory>> retry(retry_policy policy, Factory factory, std::stop_token stopToken = {},
+        timer_service& timers = timer_service::shared())
+    {
+        details::validate_retry_policy(policy);
+
+        for (std::size_t attempt = 1;; ++attempt)
+        {
+            std::exception_ptr exception{};
+
+            try
+            {
+                co_return co_await details::invoke_retry_factory(factory, stopToken);
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+
+            if (attempt == policy.maxAttempts || stopToken.stop_requested() ||
+                !details::is_retryable(policy, exception))
+            {
+                std::rethrow_exception(exception);
+            }
+
+            co_await timers.wait_for(details::retry_delay(policy, attempt), stopToken);
+        }
+    }
+}
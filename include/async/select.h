@@ -0,0 +1,168 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include "awaitable_resume_t.h"
+#include "select_state.h"
+#include "when_any.h"
+
+namespace async::details
+{
+    template <typename T, typename = std::void_t<>>
+    struct is_selectable : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct is_selectable<T,
+        std::void_t<decltype(std::declval<T&>().await_ready()),
+            decltype(std::declval<T&>().select_suspend(std::declval<select_state&>(), std::size_t{})),
+            decltype(std::declval<T&>().select_cancel()), decltype(std::declval<T&>().await_resume())>>
+        : std::true_type
+    {
+    };
+
+    template <typename T>
+    inline constexpr bool is_selectable_v = is_selectable<T>::value;
+
+    template <typename... Operations>
+    struct select_awaitable final
+    {
+        using result_type = std::variant<when_any_variant_element_t<awaitable_resume_t<Operations>>...>;
+
+        explicit select_awaitable(Operations&&... operations) :
+            m_operations{ std::move(operations)... }, m_state{}, m_readyIndex{ no_index }, m_registeredCount{}
+        {
+        }
+
+        select_awaitable(const select_awaitable&) = delete;
+        select_awaitable(select_awaitable&&) noexcept = delete;
+
+        ~select_awaitable() noexcept = default;
+
+        select_awaitable& operator=(const select_awaitable&) = delete;
+        select_awaitable& operator=(select_awaitable&&) noexcept = delete;
+
+        // Checks the alternatives in order, stopping at the first that is ready (checking may take its item).
+        [[nodiscard]] bool await_ready()
+        {
+            return try_ready(std::index_sequence_for<Operations...>{});
+        }
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle)
+        {
+            m_state.set_awaiting(handle);
+            register_all(std::index_sequence_for<Operations...>{});
+            return m_state.try_await();
+        }
+
+        [[nodiscard]] result_type await_resume()
+        {
+            if (m_readyIndex != no_index)
+            {
+                return resume_at(m_readyIndex);
+            }
+
+            const std::size_t winner{ m_state.winner() };
+            cancel_losers(winner, std::index_sequence_for<Operations...>{});
+            return resume_at(winner);
+        }
+
+    private:
+        static constexpr std::size_t no_index{ sizeof...(Operations) };
+
+        template <std::size_t... Indexes>
+        [[nodiscard]] bool try_ready(std::index_sequence<Indexes...>)
+        {
+            return ((std::get<Indexes>(m_operations).await_ready() && (m_readyIndex = Indexes, true)) || ...);
+        }
+
+        // Registers each alternative in order, stopping once one has completed the select.
+        template <std::size_t... Indexes>
+        void register_all(std::index_sequence<Indexes...>)
+        {
+            std::ignore = (register_one<Indexes>() && ...);
+        }
+
+        template <std::size_t Index>
+        [[nodiscard]] bool register_one()
+        {
+            if (m_state.has_winner())
+            {
+                return false;
+            }
+
+            ++m_registeredCount;
+            return std::get<Index>(m_operations).select_suspend(m_state, Index);
+        }
+
+        // A losing alternative that was dropped by its source is not found there, so canceling it does nothing.
+        template <std::size_t... Indexes>
+        void cancel_losers(std::size_t winner, std::index_sequence<Indexes...>) noexcept
+        {
+            ((Indexes < m_registeredCount && Indexes != winner ? std::get<Indexes>(m_operations).select_cancel()
+                                                               : void()),
+                ...);
+        }
+
+        template <std::size_t Index>
+        [[nodiscard]] result_type resume()
+        {
+            if constexpr (std::is_void_v<awaitable_resume_t<std::tuple_element_t<Index, std::tuple<Operations...>>>>)
+            {
+                std::get<Index>(m_operations).await_resume();
+                return result_type{ std::in_place_index<Index> };
+            }
+            else
+            {
+                return result_type{ std::in_place_index<Index>, std::get<Index>(m_operations).await_resume() };
+            }
+        }
+
+        [[nodiscard]] result_type resume_at(std::size_t index)
+        {
+            return resume_at(index, std::index_sequence_for<Operations...>{});
+        }
+
+        template <std::size_t... Indexes>
+        [[nodiscard]] result_type resume_at(std::size_t index, std::index_sequence<Indexes...>)
+        {
+            using resume_function = result_type (select_awaitable::*)();
+            static constexpr resume_function resumes[]{ &select_awaitable::resume<Indexes>... };
+            return (this->*resumes[index])();
+        }
+
+        std::tuple<Operations...> m_operations;
+        select_state m_state;
+
+        // The alternative found ready by await_ready, if any (in which case none were registered).
+        std::size_t m_readyIndex;
+        std::size_t m_registeredCount;
+    };
+}
+
+namespace async
+{
+    // Returns an awaitable that waits for the first of several operations to complete, with a single waiter registered
+    // with every operation's source rather than a coroutine per operation. The supported operations are
+    // mpmc_channel<T>::receive() and timer_service::wait_until()/wait_for(). co_await first checks the operations in
+    // order without suspending; if none is ready, it registers with each source (stopping early if one completes
+    // meanwhile) and suspends until the first completes. The operations share a claim, so exactly one completes: a
+    // channel hands an item only to a waiter whose claim succeeds, so an item is never taken on behalf of an operation
+    // that lost. The others are deregistered before co_await returns.
+    // Produces a std::variant whose index() is the index of the operation that completed and whose alternative holds
+    // its result (std::monostate for a timer wait, which throws task_canceled if the timer service is destroyed). A
+    // closed channel completes its receive with std::nullopt, as for receive() alone.
+    template <typename... Operations, typename = std::enable_if_t<(details::is_selectable_v<Operations> && ...)>>
+    [[nodiscard]] details::select_awaitable<Operations...> select(Operations... operations)
+    {
+        static_assert(sizeof...(Operations) != 0, "select requires at least one operation.");
+        return details::select_awaitable<Operations...>{ std::move(operations)... };
+    }
+}
@@ -0,0 +1,100 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <limits>
+#include <thread>
+#include "atomic_acq_rel.h"
+
+namespace async::details
+{
+    // Shared by every alternative of a select (see select.h), so that exactly one of them completes it.
+    // An alternative that may or may not be able to complete (a channel receive that still has to take an item) claims
+    // the select tentatively with begin_claim(), which makes other alternatives wait briefly, and then either confirms
+    // or releases the claim with end_claim(). An alternative that loses must never touch the select again, and its
+    // source must drop it rather than hand it anything, so nothing is lost.
+    // The winning alternative and the awaiting coroutine (once it has finished registering every alternative) each
+    // count down once, so the awaiting coroutine is never resumed while it is still registering alternatives.
+    struct select_state final
+    {
+        select_state() noexcept : m_winner{ no_winner }, m_remaining{ 2 }, m_awaiting{} {}
+
+        select_state(const select_state&) = delete;
+        select_state(select_state&&) noexcept = delete;
+
+        ~select_state() noexcept = default;
+
+        select_state& operator=(const select_state&) = delete;
+        select_state& operator=(select_state&&) noexcept = delete;
+
+        [[nodiscard]] bool has_winner() const noexcept { return m_winner.load() < claiming; }
+
+        // Only valid once the select has completed.
+        [[nodiscard]] std::size_t winner() const noexcept { return m_winner.load(); }
+
+        // Returns false if another alternative has already won. Otherwise, the caller must call end_claim().
+        [[nodiscard]] bool begin_claim() noexcept
+        {
+            while (true)
+            {
+                std::size_t expected{ no_winner };
+
+                if (m_winner.compare_exchange_weak(expected, claiming))
+                {
+                    return true;
+                }
+
+                if (expected < claiming)
+                {
+                    return false;
+                }
+
+                // Another alternative is deciding; it holds the claim only while it tries to take a single item.
+                if (expected == claiming)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        // Confirms (if claimed is true) or releases a claim started with begin_claim().
+        void end_claim(std::size_t index, bool claimed) noexcept { m_winner = claimed ? index : no_winner; }
+
+        // Returns false if another alternative has already won.
+        [[nodiscard]] bool try_claim(std::size_t index) noexcept
+        {
+            if (!begin_claim())
+            {
+                return false;
+            }
+
+            end_claim(index, true);
+            return true;
+        }
+
+        void set_awaiting(std::coroutine_handle<> awaiting) noexcept { m_awaiting = awaiting; }
+
+        // Called by the awaiting coroutine after it has finished registering alternatives; returns true if it must
+        // suspend.
+        [[nodiscard]] bool try_await() noexcept { return m_remaining.fetch_sub(1) > 1; }
+
+        // Called by the winning alternative once its result is ready.
+        void complete() noexcept
+        {
+            if (m_remaining.fetch_sub(1) == 1)
+            {
+                m_awaiting.resume();
+            }
+        }
+
+    private:
+        static constexpr std::size_t no_winner{ std::numeric_limits<std::size_t>::max() };
+        static constexpr std::size_t claiming{ no_winner - 1 };
+
+        atomic_acq_rel<std::size_t> m_winner;
+        atomic_acq_rel<int> m_remaining;
+        std::coroutine_handle<> m_awaiting;
+    };
+}
@@ -0,0 +1,312 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <cassert>
+#include <coroutine>
+#include <cstdint>
+#include <stdexcept>
+#include "atomic_acq_rel.h"
+
+namespace async
+{
+    struct sequence_barrier;
+}
+
+namespace async::details
+{
+    struct sequence_barrier_operation final
+    {
+        sequence_barrier_operation(sequence_barrier& barrier, std::int64_t targetSequence) noexcept :
+            m_barrier{ barrier }, m_targetSequence{ targetSequence }, m_lastPublished{}, m_next{}, m_handle{}
+        {
+        }
+
+        [[nodiscard]] bool await_ready() noexcept;
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle) noexcept;
+
+        [[nodiscard]] constexpr std::int64_t await_resume() const noexcept { return m_lastPublished; }
+
+    private:
+        friend struct ::async::sequence_barrier;
+
+        sequence_barrier& m_barrier;
+        const std::int64_t m_targetSequence;
+        std::int64_t m_lastPublished;
+        sequence_barrier_operation* m_next;
+        std::coroutine_handle<> m_handle;
+    };
+}
+
+namespace async
+{
+#ifdef _MSC_VER
+#pragma warning(push)
+// structure was padded due to alignment specifier
+#pragma warning(disable : 4324)
+#endif
+
+    // Lets consumers wait for a single producer to publish a sequence number, as in a disruptor-style ring buffer
+    // pipeline. co_await wait_until_published(sequence) suspends until the published sequence reaches sequence and
+    // returns the last published sequence (which may be greater, allowing the consumer to process a batch).
+    // publish() may be called only by a single producer; it resumes satisfied waiters inline, in sequence order.
+    struct sequence_barrier final
+    {
+        explicit sequence_barrier(std::int64_t initialSequence = -1) noexcept :
+            m_lastPublished{ initialSequence }, m_incoming{ nullptr }, m_pending{}
+        {
+        }
+
+        sequence_barrier(const sequence_barrier&) = delete;
+        sequence_barrier(sequence_barrier&&) noexcept = delete;
+
+        ~sequence_barrier() noexcept
+        {
+            // The barrier must not be destroyed while any waiters remain.
+            assert(m_incoming.load() == nullptr);
+            assert(m_pending == nullptr);
+        }
+
+        sequence_barrier& operator=(const sequence_barrier&) = delete;
+        sequence_barrier& operator=(sequence_barrier&&) noexcept = delete;
+
+        [[nodiscard]] std::int64_t last_published() const noexcept { return m_lastPublished.load(); }
+
+        [[nodiscard]] details::sequence_barrier_operation wait_until_published(std::int64_t sequence) noexcept
+        {
+            return details::sequence_barrier_operation{ *this, sequence };
+        }
+
+        // Publishes every sequence number up to and including sequence.
+        void publish(std::int64_t sequence)
+        {
+            const std::int64_t lastPublished{ m_lastPublished.load() };
+
+            if (sequence < lastPublished)
+            {
+                throw std::invalid_argument{ "The sequence must not be less than the last published sequence." };
+            }
+
+            m_lastPublished = sequence;
+
+            // Only the producer touches m_pending, so move newly arrived waiters into it (keeping it sorted) and then
+            // resume its satisfied prefix.
+            void* incoming{ m_incoming.exchange(nullptr) };
+            merge_into_pending(reverse(static_cast<details::sequence_barrier_operation*>(incoming)));
+
+            details::sequence_barrier_operation* ready{ m_pending };
+            details::sequence_barrier_operation* lastReady{};
+
+            while (m_pending != nullptr && m_pending->m_targetSequence <= sequence)
+            {
+                lastReady = m_pending;
+                m_pending = m_pending->m_next;
+            }
+
+            if (lastReady != nullptr)
+            {
+                lastReady->m_next = nullptr;
+                resume_all(ready, sequence);
+            }
+        }
+
+    private:
+        friend struct details::sequence_barrier_operation;
+
+        // Returns false if the target sequence was published before this operation could be enqueued (so the awaiter
+        // should not suspend).
+        [[nodiscard]] bool try_enqueue(details::sequence_barrier_operation& operation) noexcept
+        {
+            const std::int64_t targetSequence{ operation.m_targetSequence };
+            push_incoming(&operation, &operation);
+
+            // The producer publishes before taking incoming waiters, and this consumer pushed before checking the
+            // published sequence, so at least one side sees the other. After this point the operation may already
+            // have been resumed (and destroyed) by the producer, so it is compared only by address.
+            std::int64_t lastPublished{ m_lastPublished.load() };
+
+            if (lastPublished < targetSequence)
+            {
+                return true;
+            }
+
+            bool foundSelf{ false };
+
+            while (true)
+            {
+                details::sequence_barrier_operation* ready{};
+                details::sequence_barrier_operation* notReady{};
+                details::sequence_barrier_operation* notReadyTail{};
+                details::sequence_barrier_operation* next{ static_cast<details::sequence_barrier_operation*>(
+                    m_incoming.exchange(nullptr)) };
+
+                while (next != nullptr)
+                {
+                    details::sequence_barrier_operation* following{ next->m_next };
+
+                    if (next == &operation)
+                    {
+                        foundSelf = true;
+                    }
+                    else if (next->m_targetSequence <= lastPublished)
+                    {
+                        ready = insert_sorted(ready, next);
+                    }
+                    else
+                    {
+                        next->m_next = notReady;
+                        notReady = next;
+
+                        if (notReadyTail == nullptr)
+                        {
+                            notReadyTail = next;
+                        }
+                    }
+
+                    next = following;
+                }
+
+                if (foundSelf)
+                {
+                    operation.m_lastPublished = lastPublished;
+                }
+
+                resume_all(ready, lastPublished);
+
+                if (notReady == nullptr)
+                {
+                    break;
+                }
+
+                push_incoming(notReady, notReadyTail);
+
+                // If the producer published again while the waiters above were taken, it may have missed them.
+                const std::int64_t latestPublished{ m_lastPublished.load() };
+
+                if (latestPublished == lastPublished)
+                {
+                    break;
+                }
+
+                lastPublished = latestPublished;
+            }
+
+            return !foundSelf;
+        }
+
+        void push_incoming(
+            details::sequence_barrier_operation* head, details::sequence_barrier_operation* tail) noexcept
+        {
+            void* currentHead{ m_incoming.load() };
+
+            do
+            {
+                tail->m_next = static_cast<details::sequence_barrier_operation*>(currentHead);
+            } while (!m_incoming.compare_exchange_weak(currentHead, head));
+        }
+
+        void merge_into_pending(details::sequence_barrier_operation* incoming) noexcept
+        {
+            // Waiters usually arrive in increasing sequence order, so resume the search from the previous insertion
+            // point when possible; that keeps merging an already sorted batch linear.
+            details::sequence_barrier_operation* previous{};
+
+            while (incoming != nullptr)
+            {
+                details::sequence_barrier_operation* following{ incoming->m_next };
+
+                if (previous == nullptr || incoming->m_targetSequence < previous->m_targetSequence)
+                {
+                    m_pending = insert_sorted(m_pending, incoming);
+                }
+                else
+                {
+                    std::ignore = insert_sorted(previous, incoming);
+                }
+
+                previous = incoming;
+                incoming = following;
+            }
+        }
+
+        // Inserts operation after any operations with an equal or smaller target sequence; returns the new head.
+        [[nodiscard]] static details::sequence_barrier_operation* insert_sorted(
+            details::sequence_barrier_operation* head, details::sequence_barrier_operation* operation) noexcept
+        {
+            if (head == nullptr || operation->m_targetSequence < head->m_targetSequence)
+            {
+                operation->m_next = head;
+                return operation;
+            }
+
+            details::sequence_barrier_operation* current{ head };
+
+            while (current->m_next != nullptr && current->m_next->m_targetSequence <= operation->m_targetSequence)
+            {
+                current = current->m_next;
+            }
+
+            operation->m_next = current->m_next;
+            current->m_next = operation;
+            return head;
+        }
+
+        [[nodiscard]] static details::sequence_barrier_operation* reverse(
+            details::sequence_barrier_operation* head) noexcept
+        {
+            details::sequence_barrier_operation* reversed{};
+
+            while (head != nullptr)
+            {
+                details::sequence_barrier_operation* following{ head->m_next };
+                head->m_next = reversed;
+                reversed = head;
+                head = following;
+            }
+
+            return reversed;
+        }
+
+        static void resume_all(details::sequence_barrier_operation* head, std::int64_t lastPublished) noexcept
+        {
+            while (head != nullptr)
+            {
+                // Read next before resuming; the resumed coroutine may destroy the operation.
+                details::sequence_barrier_operation* following{ head->m_next };
+                head->m_lastPublished = lastPublished;
+                head->m_handle.resume();
+                head = following;
+            }
+        }
+
+        // Written by the producer and polled by consumers; kept on a separate cache line from m_incoming (written by
+        // consumers) and m_pending (used only by the producer).
+        details::padded_atomic_acq_rel<std::int64_t> m_lastPublished;
+
+        // Waiters that have not yet been seen by the producer (in LIFO order).
+        details::padded_atomic_acq_rel<void*> m_incoming;
+
+        // Waiters seen by the producer, sorted by target sequence; accessed only by the producer.
+        details::sequence_barrier_operation* m_pending;
+    };
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+namespace async::details
+{
+    inline bool sequence_barrier_operation::await_ready() noexcept
+    {
+        m_lastPublished = m_barrier.last_published();
+        return m_lastPublished >= m_targetSequence;
+    }
+
+    inline bool sequence_barrier_operation::await_suspend(std::coroutine_handle<> handle) noexcept
+    {
+        m_handle = handle;
+        return m_barrier.try_enqueue(*this);
+    }
+}
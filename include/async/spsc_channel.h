@@ -0,0 +1,338 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include "atomic_acq_rel.h"
+
+namespace async
+{
+    template <typename T, std::size_t Capacity>
+    struct spsc_channel;
+}
+
+namespace async::details
+{
+    // Counts the end of the awaiting operation's await_suspend plus the other side handing it the item (or slot) it is
+    // waiting for, so whichever happens last resumes the awaiting coroutine (never from within its own await_suspend).
+    struct spsc_channel_waiter final
+    {
+        spsc_channel_waiter() noexcept : m_awaiting{}, m_remaining{ 2 } {}
+
+        spsc_channel_waiter(const spsc_channel_waiter&) = delete;
+        spsc_channel_waiter(spsc_channel_waiter&&) noexcept = delete;
+
+        ~spsc_channel_waiter() noexcept = default;
+
+        spsc_channel_waiter& operator=(const spsc_channel_waiter&) = delete;
+        spsc_channel_waiter& operator=(spsc_channel_waiter&&) noexcept = delete;
+
+        void set_awaiting(std::coroutine_handle<> awaiting) noexcept { m_awaiting = awaiting; }
+
+        // Called at the end of await_suspend; returns true if the awaiting coroutine must stay suspended.
+        [[nodiscard]] bool try_await() noexcept { return m_remaining.fetch_sub(1) != 1; }
+
+        // Called by the other side once the awaited item (or slot) is available.
+        void complete() noexcept
+        {
+            if (m_remaining.fetch_sub(1) == 1)
+            {
+                m_awaiting.resume();
+            }
+        }
+
+    private:
+        std::coroutine_handle<> m_awaiting;
+        atomic_acq_rel<int> m_remaining;
+    };
+
+    template <typename T, std::size_t Capacity>
+    struct spsc_channel_send_operation final
+    {
+        spsc_channel_send_operation(spsc_channel<T, Capacity>& channel, T&& value) :
+            m_channel{ channel }, m_value{ std::move(value) }, m_waiter{}
+        {
+        }
+
+        [[nodiscard]] bool await_ready() noexcept;
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle) noexcept;
+
+        void await_resume();
+
+    private:
+        spsc_channel<T, Capacity>& m_channel;
+        T m_value;
+        spsc_channel_waiter m_waiter;
+    };
+
+    template <typename T, std::size_t Capacity>
+    struct spsc_channel_receive_operation final
+    {
+        explicit spsc_channel_receive_operation(spsc_channel<T, Capacity>& channel) noexcept :
+            m_channel{ channel }, m_waiter{}
+        {
+        }
+
+        [[nodiscard]] bool await_ready() noexcept;
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle) noexcept;
+
+        [[nodiscard]] T await_resume();
+
+    private:
+        spsc_channel<T, Capacity>& m_channel;
+        spsc_channel_waiter m_waiter;
+    };
+}
+
+namespace async
+{
+#ifdef _MSC_VER
+#pragma warning(push)
+// structure was padded due to alignment specifier
+#pragma warning(disable : 4324)
+#endif
+
+    // A bounded channel between a single producer and a single consumer, stored in a ring buffer of Capacity items held
+    // inline (so no allocation occurs per item). co_await send(value) suspends only while the channel is full, and
+    // co_await receive() suspends only while it is empty; otherwise each is wait-free. A suspended side is resumed
+    // inline by the other side's next receive() or send().
+    // At most one send() and one receive() may be outstanding at a time (one producer and one consumer).
+    template <typename T, std::size_t Capacity>
+    struct spsc_channel final
+    {
+        static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "The capacity must be a power of two.");
+
+        spsc_channel() noexcept :
+            m_head{ 0 }, m_cachedTail{ 0 }, m_sendWaiter{ nullptr }, m_tail{ 0 }, m_cachedHead{ 0 },
+            m_receiveWaiter{ nullptr }
+        {
+        }
+
+        spsc_channel(const spsc_channel&) = delete;
+        spsc_channel(spsc_channel&&) noexcept = delete;
+
+        ~spsc_channel() noexcept
+        {
+            // The channel must not be destroyed while either side is waiting.
+            assert(m_sendWaiter.load() == nullptr);
+            assert(m_receiveWaiter.load() == nullptr);
+
+            for (std::uint64_t index = m_head.load(); index != m_tail.load(); ++index)
+            {
+                item(index).~T();
+            }
+        }
+
+        spsc_channel& operator=(const spsc_channel&) = delete;
+        spsc_channel& operator=(spsc_channel&&) noexcept = delete;
+
+        [[nodiscard]] static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+        [[nodiscard]] details::spsc_channel_send_operation<T, Capacity> send(T value)
+        {
+            return details::spsc_channel_send_operation<T, Capacity>{ *this, std::move(value) };
+        }
+
+        [[nodiscard]] details::spsc_channel_receive_operation<T, Capacity> receive() noexcept
+        {
+            return details::spsc_channel_receive_operation<T, Capacity>{ *this };
+        }
+
+    private:
+        friend struct details::spsc_channel_send_operation<T, Capacity>;
+        friend struct details::spsc_channel_receive_operation<T, Capacity>;
+
+        // Called only by the producer. Rereads the consumer's head only when the cached copy shows the channel full.
+        [[nodiscard]] bool can_send() noexcept
+        {
+            const std::uint64_t tail{ m_tail.load() };
+
+            if (tail - m_cachedHead < Capacity)
+            {
+                return true;
+            }
+
+            m_cachedHead = m_head.load();
+            return tail - m_cachedHead < Capacity;
+        }
+
+        // Called only by the consumer. Rereads the producer's tail only when the cached copy shows the channel empty.
+        [[nodiscard]] bool can_receive() noexcept
+        {
+            const std::uint64_t head{ m_head.load() };
+
+            if (head < m_cachedTail)
+            {
+                return true;
+            }
+
+            m_cachedTail = m_tail.load();
+            return head < m_cachedTail;
+        }
+
+        // Returns false if space became available before the waiter could be published (so the producer should not
+        // suspend).
+        [[nodiscard]] bool try_wait_to_send(
+            details::spsc_channel_waiter& waiter, std::coroutine_handle<> handle) noexcept
+        {
+            waiter.set_awaiting(handle);
+            m_sendWaiter = &waiter;
+
+            // The consumer advances m_head before checking m_sendWaiter, and this producer published m_sendWaiter
+            // before checking m_head, so at least one side sees the other. If both do, whichever clears m_sendWaiter
+            // first owns the wakeup.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (can_send() && m_sendWaiter.exchange(nullptr) != nullptr)
+            {
+                return false;
+            }
+
+            return waiter.try_await();
+        }
+
+        // Returns false if an item arrived before the waiter could be published (so the consumer should not suspend).
+        [[nodiscard]] bool try_wait_to_receive(
+            details::spsc_channel_waiter& waiter, std::coroutine_handle<> handle) noexcept
+        {
+            waiter.set_awaiting(handle);
+            m_receiveWaiter = &waiter;
+
+            // See try_wait_to_send.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            if (can_receive() && m_receiveWaiter.exchange(nullptr) != nullptr)
+            {
+                return false;
+            }
+
+            return waiter.try_await();
+        }
+
+        void push(T&& value)
+        {
+            const std::uint64_t tail{ m_tail.load() };
+            ::new (static_cast<void*>(slot(tail))) T{ std::move(value) };
+            m_tail = tail + 1;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            wake(m_receiveWaiter, [this, tail]() { return m_head.load() != tail + 1; });
+        }
+
+        [[nodiscard]] T pop()
+        {
+            const std::uint64_t head{ m_head.load() };
+            T& stored{ item(head) };
+            T value{ std::move(stored) };
+            stored.~T();
+            m_head = head + 1;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            wake(m_sendWaiter, [this, head]() { return m_tail.load() - (head + 1) != Capacity; });
+            return value;
+        }
+
+        // The waiter may have been published after the item (or slot) that prompted this call was already taken by the
+        // waiting side, so it is resumed only if ready() still holds (nothing else can change that while the other side
+        // is waiting); otherwise it is put back for the next call.
+        template <typename Ready>
+        static void wake(details::atomic_acq_rel<details::spsc_channel_waiter*>& waiter, Ready ready) noexcept
+        {
+            // Check before exchanging, so the common case (nobody waiting) does not write to the cache line.
+            if (waiter.load() == nullptr)
+            {
+                return;
+            }
+
+            details::spsc_channel_waiter* const waiting{ waiter.exchange(nullptr) };
+
+            if (waiting == nullptr)
+            {
+                return;
+            }
+
+            if (ready())
+            {
+                waiting->complete();
+            }
+            else
+            {
+                waiter = waiting;
+            }
+        }
+
+        [[nodiscard]] std::byte* slot(std::uint64_t index) noexcept
+        {
+            return m_storage + static_cast<std::size_t>(index & (Capacity - 1)) * sizeof(T);
+        }
+
+        [[nodiscard]] T& item(std::uint64_t index) noexcept { return *std::launder(reinterpret_cast<T*>(slot(index))); }
+
+        // Indices are 64-bit (so they never wrap in practice) and are masked to find a slot. Cached indices may lag
+        // behind (a waiting side resumed by the other side does not refresh its cache), so they are compared by order.
+        // Each side's fields are kept on its own cache line, including the waiter pointer that side polls after every
+        // operation, so neither side touches the other's cache line unless its cached index shows the channel full or
+        // empty.
+
+        // Written by the consumer.
+        alignas(details::cache_line_size) details::atomic_acq_rel<std::uint64_t> m_head;
+        std::uint64_t m_cachedTail;
+        details::atomic_acq_rel<details::spsc_channel_waiter*> m_sendWaiter;
+
+        // Written by the producer.
+        alignas(details::cache_line_size) details::atomic_acq_rel<std::uint64_t> m_tail;
+        std::uint64_t m_cachedHead;
+        details::atomic_acq_rel<details::spsc_channel_waiter*> m_receiveWaiter;
+
+        alignas(details::cache_line_size) alignas(T) std::byte m_storage[sizeof(T) * Capacity];
+    };
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+}
+
+namespace async::details
+{
+    template <typename T, std::size_t Capacity>
+    inline bool spsc_channel_send_operation<T, Capacity>::await_ready() noexcept
+    {
+        return m_channel.can_send();
+    }
+
+    template <typename T, std::size_t Capacity>
+    inline bool spsc_channel_send_operation<T, Capacity>::await_suspend(std::coroutine_handle<> handle) noexcept
+    {
+        return m_channel.try_wait_to_send(m_waiter, handle);
+    }
+
+    template <typename T, std::size_t Capacity>
+    inline void spsc_channel_send_operation<T, Capacity>::await_resume()
+    {
+        m_channel.push(std::move(m_value));
+    }
+
+    template <typename T, std::size_t Capacity>
+    inline bool spsc_channel_receive_operation<T, Capacity>::await_ready() noexcept
+    {
+        return m_channel.can_receive();
+    }
+
+    template <typename T, std::size_t Capacity>
+    inline bool spsc_channel_receive_operation<T, Capacity>::await_suspend(std::coroutine_handle<> handle) noexcept
+    {
+        return m_channel.try_wait_to_receive(m_waiter, handle);
+    }
+
+    template <typename T, std::size_t Capacity>
+    inline T spsc_channel_receive_operation<T, Capacity>::await_resume()
+    {
+        return m_channel.pop();
+    }
+}
@@ -0,0 +1,524 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "async_generator.h"
+#include "atomic_acq_rel.h"
+#include "awaitable_then.h"
+#include "mpmc_channel.h"
+
+namespace async::details
+{
+    // A synchronous stage bound to its input type In. process() receives each input and returns the stage's output for
+    // it, if any; once the upstream is exhausted (or any stage is stopped()), finish() is called until it returns
+    // nullopt, to flush any outputs the stage was holding back.
+    template <typename In, typename Fn>
+    struct stream_map_stage final
+    {
+        using output_type = std::remove_cvref_t<std::invoke_result_t<Fn&, In&&>>;
+
+        static_assert(!std::is_void_v<output_type>, "map requires a function that returns a value.");
+
+        [[nodiscard]] std::optional<output_type> process(In&& value) { return std::invoke(fn, std::move(value)); }
+
+        [[nodiscard]] constexpr std::optional<output_type> finish() const noexcept { return std::nullopt; }
+
+        [[nodiscard]] constexpr bool stopped() const noexcept { return false; }
+
+        Fn fn;
+    };
+
+    template <typename In, typename Predicate>
+    struct stream_filter_stage final
+    {
+        using output_type = In;
+
+        [[nodiscard]] std::optional<In> process(In&& value)
+        {
+            if (!std::invoke(predicate, std::as_const(value)))
+            {
+                return std::nullopt;
+            }
+
+            return std::optional<In>{ std::move(value) };
+        }
+
+        [[nodiscard]] constexpr std::optional<In> finish() const noexcept { return std::nullopt; }
+
+        [[nodiscard]] constexpr bool stopped() const noexcept { return false; }
+
+        Predicate predicate;
+    };
+
+    template <typename In>
+    struct stream_take_stage final
+    {
+        using output_type = In;
+
+        [[nodiscard]] std::optional<In> process(In&& value)
+        {
+            // Values flushed by earlier stages may still arrive once the limit is reached.
+            if (taken == limit)
+            {
+                return std::nullopt;
+            }
+
+            ++taken;
+            return std::optional<In>{ std::move(value) };
+        }
+
+        [[nodiscard]] constexpr std::optional<In> finish() const noexcept { return std::nullopt; }
+
+        [[nodiscard]] constexpr bool stopped() const noexcept { return taken == limit; }
+
+        std::size_t limit;
+        std::size_t taken;
+    };
+
+    template <typename In>
+    struct stream_chunk_stage final
+    {
+        using output_type = std::vector<In>;
+
+        [[nodiscard]] std::optional<std::vector<In>> process(In&& value)
+        {
+            if (items.empty())
+            {
+                items.reserve(size);
+            }
+
+            items.push_back(std::move(value));
+
+            if (items.size() != size)
+            {
+                return std::nullopt;
+            }
+
+            return std::optional<std::vector<In>>{ std::exchange(items, {}) };
+        }
+
+        [[nodiscard]] std::optional<std::vector<In>> finish()
+        {
+            if (items.empty())
+            {
+                return std::nullopt;
+            }
+
+            return std::optional<std::vector<In>>{ std::exchange(items, {}) };
+        }
+
+        [[nodiscard]] constexpr bool stopped() const noexcept { return false; }
+
+        std::size_t size;
+        std::vector<In> items;
+    };
+
+    // Runs two stages as one: First's outputs are Second's inputs.
+    template <typename In, typename First, typename Second>
+    struct stream_composed_stage final
+    {
+        using output_type = typename Second::output_type;
+
+        [[nodiscard]] std::optional<output_type> process(In&& value)
+        {
+            std::optional<typename First::output_type> intermediate{ first.process(std::move(value)) };
+
+            if (!intermediate)
+            {
+                return std::nullopt;
+            }
+
+            return second.process(std::move(*intermediate));
+        }
+
+        [[nodiscard]] std::optional<output_type> finish()
+        {
+            while (!firstFinished)
+            {
+                std::optional<typename First::output_type> intermediate{ first.finish() };
+
+                if (!intermediate)
+                {
+                    firstFinished = true;
+                    break;
+                }
+
+                if (std::optional<output_type> output{ second.process(std::move(*intermediate)) })
+                {
+                    return output;
+                }
+            }
+
+            return second.finish();
+        }
+
+        [[nodiscard]] bool stopped() const noexcept { return first.stopped() || second.stopped(); }
+
+        First first;
+        Second second;
+        bool firstFinished;
+    };
+
+    template <typename Fn>
+    struct stream_map_builder final
+    {
+        template <typename In>
+        [[nodiscard]] stream_map_stage<In, Fn> bind() &&
+        {
+            return stream_map_stage<In, Fn>{ std::move(fn) };
+        }
+
+        Fn fn;
+    };
+
+    template <typename Predicate>
+    struct stream_filter_builder final
+    {
+        template <typename In>
+        [[nodiscard]] stream_filter_stage<In, Predicate> bind() &&
+        {
+            return stream_filter_stage<In, Predicate>{ std::move(predicate) };
+        }
+
+        Predicate predicate;
+    };
+
+    struct stream_take_builder final
+    {
+        template <typename In>
+        [[nodiscard]] stream_take_stage<In> bind() &&
+        {
+            return stream_take_stage<In>{ limit, 0 };
+        }
+
+        std::size_t limit;
+    };
+
+    struct stream_chunk_builder final
+    {
+        template <typename In>
+        [[nodiscard]] stream_chunk_stage<In> bind() &&
+        {
+            return stream_chunk_stage<In>{ size, {} };
+        }
+
+        std::size_t size;
+    };
+
+    template <typename T>
+    struct is_stream_stage_builder : std::false_type
+    {
+    };
+
+    template <typename Fn>
+    struct is_stream_stage_builder<stream_map_builder<Fn>> : std::true_type
+    {
+    };
+
+    template <typename Predicate>
+    struct is_stream_stage_builder<stream_filter_builder<Predicate>> : std::true_type
+    {
+    };
+
+    template <>
+    struct is_stream_stage_builder<stream_take_builder> : std::true_type
+    {
+    };
+
+    template <>
+    struct is_stream_stage_builder<stream_chunk_builder> : std::true_type
+    {
+    };
+
+    template <typename T>
+    inline constexpr bool is_stream_stage_builder_v = is_stream_stage_builder<T>::value;
+
+    template <typename T, typename Stage>
+    async_generator<typename Stage::output_type> run_stream_stages(async_generator<T> source, Stage stage)
+    {
+        using input_type = std::remove_const_t<T>;
+
+        while (!stage.stopped())
+        {
+            T* const value{ co_await source.next() };
+
+            if (value == nullptr)
+            {
+                break;
+            }
+
+            std::optional<typename Stage::output_type> output{};
+
+            if constexpr (std::is_const_v<T>)
+            {
+                output = stage.process(input_type{ *value });
+            }
+            else
+            {
+                output = stage.process(std::move(*value));
+            }
+
+            if (output)
+            {
+                co_yield std::move(*output);
+            }
+        }
+
+        while (std::optional<typename Stage::output_type> output{ stage.finish() })
+        {
+            co_yield std::move(*output);
+        }
+    }
+}
+
+namespace async
+{
+    // The result of piping an async_generator<T> through synchronous stages (map, filter, take and chunk). Further
+    // synchronous stages are fused into the same object, and the whole chain runs in a single coroutine when the result
+    // is converted to an async_generator (explicitly, or by piping it into buffer()).
+    template <typename T, typename Stage>
+    struct fused_stream final
+    {
+        using value_type = typename Stage::output_type;
+
+        fused_stream(async_generator<T>&& source, Stage&& stage) noexcept :
+            m_source{ std::move(source) }, m_stage{ std::move(stage) }
+        {
+        }
+
+        [[nodiscard]] async_generator<value_type> generator() &&
+        {
+            return details::run_stream_stages(std::move(m_source), std::move(m_stage));
+        }
+
+        operator async_generator<value_type>() && { return std::move(*this).generator(); }
+
+        template <typename Builder, typename = std::enable_if_t<details::is_stream_stage_builder_v<Builder>>>
+        [[nodiscard]] friend auto operator|(fused_stream&& stream, Builder builder)
+        {
+            using Next = decltype(std::move(builder).template bind<value_type>());
+            using Composed = details::stream_composed_stage<std::remove_const_t<T>, Stage, Next>;
+            return fused_stream<T, Composed>{ std::move(stream.m_source),
+                Composed{ std::move(stream.m_stage), std::move(builder).template bind<value_type>(), false } };
+        }
+
+    private:
+        async_generator<T> m_source;
+        Stage m_stage;
+    };
+
+    // Starts a chain of fused stages.
+    template <typename T, typename Builder, typename = std::enable_if_t<details::is_stream_stage_builder_v<Builder>>>
+    [[nodiscard]] auto operator|(async_generator<T>&& source, Builder builder)
+    {
+        using Stage = decltype(std::move(builder).template bind<std::remove_const_t<T>>());
+        return fused_stream<T, Stage>{ std::move(source), std::move(builder).template bind<std::remove_const_t<T>>() };
+    }
+
+    // A stage producing fn(value) for each value.
+    template <typename Fn>
+    [[nodiscard]] details::stream_map_builder<Fn> map(Fn fn)
+    {
+        return details::stream_map_builder<Fn>{ std::move(fn) };
+    }
+
+    // A stage passing on only the values for which predicate(value) returns true.
+    template <typename Predicate>
+    [[nodiscard]] details::stream_filter_builder<Predicate> filter(Predicate predicate)
+    {
+        return details::stream_filter_builder<Predicate>{ std::move(predicate) };
+    }
+
+    // A stage passing on the first count values, and then no longer resuming the upstream.
+    [[nodiscard]] inline details::stream_take_builder take(std::size_t count) noexcept
+    {
+        return details::stream_take_builder{ count };
+    }
+
+    // A stage grouping values into std::vectors of size values each (the last may be smaller).
+    [[nodiscard]] inline details::stream_chunk_builder chunk(std::size_t size)
+    {
+        if (size == 0)
+        {
+            throw std::invalid_argument{ "The chunk size must not be zero." };
+        }
+
+        return details::stream_chunk_builder{ size };
+    }
+}
+
+namespace async::details
+{
+    // Shared by the coroutines pumping sources into the channel and the generator receiving from it. The last pump to
+    // finish (or the first to fail) closes the channel, as does the receiving generator if it is destroyed early, which
+    // makes the pumps stop at their next send.
+    template <typename T>
+    struct stream_pump_state final
+    {
+        stream_pump_state(std::size_t capacity, std::size_t pumpCount) :
+            channel{ std::bit_ceil(capacity < 2 ? std::size_t{ 2 } : capacity) },
+            remaining{ pumpCount },
+            failed{ false },
+            exception{}
+        {
+        }
+
+        void complete() noexcept
+        {
+            if (remaining.fetch_sub(1) == 1)
+            {
+                channel.close();
+            }
+        }
+
+        void fail(std::exception_ptr error) noexcept
+        {
+            if (!failed.exchange(true))
+            {
+                exception = std::move(error);
+            }
+
+            channel.close();
+        }
+
+        mpmc_channel<T> channel;
+        atomic_acq_rel<std::size_t> remaining;
+        atomic_acq_rel<bool> failed;
+
+        // Written only by the first pump to fail, before it closes the channel.
+        std::exception_ptr exception;
+    };
+
+    template <typename T>
+    struct stream_pump_close_guard final
+    {
+        ~stream_pump_close_guard() noexcept { state->channel.close(); }
+
+        stream_pump_state<std::remove_const_t<T>>* state;
+    };
+
+    template <typename T, typename Executor>
+    then_task pump_stream(
+        std::shared_ptr<stream_pump_state<std::remove_const_t<T>>> state, async_generator<T> source, Executor executor)
+    {
+        co_await executor_resume_operation<Executor>{ executor };
+
+        try
+        {
+            while (T* const value{ co_await source.next() })
+            {
+                std::remove_const_t<T> item{ std::move(*value) };
+
+                if (state->channel.try_send(item))
+                {
+                    continue;
+                }
+
+                if (!co_await state->channel.send(std::move(item)))
+                {
+                    co_return;
+                }
+
+                // A full channel resumes the pump on the thread of the receiver that made room; return to executor.
+                co_await executor_resume_operation<Executor>{ executor };
+            }
+
+            state->complete();
+        }
+        catch (...)
+        {
+            state->fail(std::current_exception());
+        }
+    }
+
+    // Starts a pump per source on executor, and yields the values they send until every pump has completed.
+    template <typename T, typename Executor, typename... Sources>
+    async_generator<std::remove_const_t<T>> pump_streams(std::size_t capacity, Executor executor, Sources... sources)
+    {
+        std::shared_ptr<stream_pump_state<std::remove_const_t<T>>> state{
+            std::make_shared<stream_pump_state<std::remove_const_t<T>>>(capacity, sizeof...(Sources))
+        };
+        stream_pump_close_guard<T> guard{ state.get() };
+        (pump_stream(state, std::move(sources), executor), ...);
+
+        while (std::optional<std::remove_const_t<T>> value{ co_await state->channel.receive() })
+        {
+            co_yield std::move(*value);
+        }
+
+        if (state->exception)
+        {
+            std::rethrow_exception(state->exception);
+        }
+    }
+
+    template <typename Executor>
+    struct stream_buffer_builder final
+    {
+        std::size_t capacity;
+        Executor executor;
+    };
+}
+
+namespace async
+{
+    // A stage that runs the upstream generator on executor (see awaitable_then), up to capacity values ahead of the
+    // consumer (capacity is rounded up to a power of two), so an I/O-bound stage and a CPU-bound stage overlap. Values
+    // pass through an mpmc_channel; a consumer waiting for one is resumed on the thread that produced it. If the
+    // upstream throws, the consumer receives the values produced before the exception and then the exception.
+    // Destroying the resulting generator stops the upstream the next time it yields.
+    template <typename Executor>
+    [[nodiscard]] details::stream_buffer_builder<Executor> buffer(std::size_t capacity, Executor executor)
+    {
+        if (capacity == 0)
+        {
+            throw std::invalid_argument{ "The capacity must not be zero." };
+        }
+
+        return details::stream_buffer_builder<Executor>{ capacity, std::move(executor) };
+    }
+
+    template <typename T, typename Executor>
+    [[nodiscard]] async_generator<std::remove_const_t<T>> operator|(
+        async_generator<T>&& source, details::stream_buffer_builder<Executor> builder)
+    {
+        return details::pump_streams<T>(builder.capacity, std::move(builder.executor), std::move(source));
+    }
+
+    template <typename T, typename Stage, typename Executor>
+    [[nodiscard]] async_generator<std::remove_const_t<typename Stage::output_type>> operator|(
+        fused_stream<T, Stage>&& stream, details::stream_buffer_builder<Executor> builder)
+    {
+        return std::move(stream).generator() | std::move(builder);
+    }
+
+    // Interleaves the values of several generators in the order they become available, running each source
+    // concurrently (inline, until it first suspends) and keeping up to capacity values (rounded up to a power of two)
+    // buffered. Completes once every source has completed; if any source throws, the others are stopped at their next
+    // yield and the consumer receives the exception after the values already buffered.
+    template <typename T, typename... Rest>
+    [[nodiscard]] async_generator<std::remove_const_t<T>> merge(
+        std::size_t capacity, async_generator<T> first, async_generator<Rest>... rest)
+    {
+        static_assert((std::is_same_v<std::remove_const_t<T>, std::remove_const_t<Rest>> && ...),
+            "merge requires generators of the same value type.");
+
+        if (capacity == 0)
+        {
+            throw std::invalid_argument{ "The capacity must not be zero." };
+        }
+
+        // Each pump runs inline until its source first suspends (or the channel fills).
+        return details::pump_streams<T>(capacity, details::inline_executor{}, std::move(first), std::move(rest)...);
+    }
+}
@@ -14,10 +14,19 @@ namespace async::details
     template <typename T>
     struct task_promise_type;
 
+#ifdef _MSC_VER
+#pragma warning(push)
+// structure was padded due to alignment specifier
+#pragma warning(disable : 4324)
+#endif
+
     template <typename T>
     struct task_state final
     {
-        atomic_acq_rel<void*> stateOrCompletion;
+        // The awaiting coroutine polls stateOrCompletion (in await_ready) while the completing coroutine writes result,
+        // and the shared_ptr control block (updated by both) immediately precedes this object. Keep stateOrCompletion
+        // on its own cache line so those accesses do not falsely share a line.
+        padded_atomic_acq_rel<void*> stateOrCompletion;
         awaitable_result<T> result;
 
         static std::shared_ptr<task_state> create_shared()
@@ -65,6 +74,10 @@ namespace async::details
         }
     };
 
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
     template <typename T>
     struct task_promise_type;
 }
@@ -154,8 +167,10 @@ namespace async::details
 
         std::coroutine_handle<> await_suspend(std::coroutine_handle<> handle) const noexcept
         {
+            // This awaiter lives in the coroutine frame, so copy the continuation out before destroying the frame.
+            const std::coroutine_handle<> continuation{ m_continuation };
             handle.destroy();
-            return m_continuation;
+            return continuation;
         }
 
         constexpr void await_resume() const noexcept {}
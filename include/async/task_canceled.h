@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include <exception>
+
 namespace async
 {
     struct task_canceled : std::exception
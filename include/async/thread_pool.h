@@ -0,0 +1,162 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace async
+{
+    struct thread_pool;
+}
+
+namespace async::details
+{
+    // An executor (see awaitable_then) that resumes coroutines on a thread_pool.
+    struct thread_pool_executor final
+    {
+        void operator()(std::coroutine_handle<> handle) const;
+
+        thread_pool* pool;
+    };
+
+    struct thread_pool_schedule_operation final
+    {
+        explicit thread_pool_schedule_operation(thread_pool& pool) noexcept : m_pool{ pool } {}
+
+        [[nodiscard]] constexpr bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle) const;
+
+        constexpr void await_resume() const noexcept {}
+
+    private:
+        thread_pool& m_pool;
+    };
+}
+
+namespace async
+{
+    // Runs a fixed number of threads that resume posted coroutines in FIFO order. Use executor() wherever an executor
+    // is accepted, or co_await schedule() to move the current coroutine onto the pool. Coroutines still queued when the
+    // pool is destroyed are resumed before its threads exit.
+    struct thread_pool final
+    {
+        explicit thread_pool(std::size_t threadCount = default_thread_count()) :
+            m_mutex{}, m_wake{}, m_queue{}, m_stopping{ false }, m_threads{}
+        {
+            if (threadCount == 0)
+            {
+                throw std::invalid_argument{ "The thread count must not be zero." };
+            }
+
+            m_threads.reserve(threadCount);
+
+            for (std::size_t index = 0; index != threadCount; ++index)
+            {
+                m_threads.emplace_back([this]() { run(); });
+            }
+        }
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool(thread_pool&&) noexcept = delete;
+
+        ~thread_pool() noexcept
+        {
+            {
+                std::lock_guard<std::mutex> mutexLock{ m_mutex };
+                m_stopping = true;
+            }
+
+            m_wake.notify_all();
+
+            for (std::thread& thread : m_threads)
+            {
+                thread.join();
+            }
+        }
+
+        thread_pool& operator=(const thread_pool&) = delete;
+        thread_pool& operator=(thread_pool&&) noexcept = delete;
+
+        // A pool shared by the whole process, with one thread per hardware thread, started on first use.
+        [[nodiscard]] static thread_pool& shared()
+        {
+            static thread_pool pool{};
+            return pool;
+        }
+
+        [[nodiscard]] std::size_t thread_count() const noexcept { return m_threads.size(); }
+
+        [[nodiscard]] details::thread_pool_executor executor() noexcept
+        {
+            return details::thread_pool_executor{ this };
+        }
+
+        // co_await schedule() resumes the awaiting coroutine on one of the pool's threads.
+        [[nodiscard]] details::thread_pool_schedule_operation schedule() noexcept
+        {
+            return details::thread_pool_schedule_operation{ *this };
+        }
+
+        void post(std::coroutine_handle<> handle)
+        {
+            {
+                std::lock_guard<std::mutex> mutexLock{ m_mutex };
+                m_queue.push_back(handle);
+            }
+
+            m_wake.notify_one();
+        }
+
+    private:
+        [[nodiscard]] static std::size_t default_thread_count() noexcept
+        {
+            return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        }
+
+        void run()
+        {
+            std::unique_lock<std::mutex> mutexLock{ m_mutex };
+
+            while (true)
+            {
+                m_wake.wait(mutexLock, [this]() { return m_stopping || !m_queue.empty(); });
+
+                if (m_queue.empty())
+                {
+                    return;
+                }
+
+                const std::coroutine_handle<> handle{ m_queue.front() };
+                m_queue.pop_front();
+                mutexLock.unlock();
+                handle.resume();
+                mutexLock.lock();
+            }
+        }
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::deque<std::coroutine_handle<>> m_queue;
+        bool m_stopping;
+        std::vector<std::thread> m_threads;
+    };
+}
+
+namespace async::details
+{
+    inline void thread_pool_executor::operator()(std::coroutine_handle<> handle) const { pool->post(handle); }
+
+    inline void thread_pool_schedule_operation::await_suspend(std::coroutine_handle<> handle) const
+    {
+        m_pool.post(handle);
+    }
+}
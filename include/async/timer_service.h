@@ -0,0 +1,423 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "atomic_acq_rel.h"
+#include "select_state.h"
+#include "task_canceled.h"
+
+namespace async
+{
+    struct timer_service;
+}
+
+namespace async::details
+{
+    struct timer_wait_operation final
+    {
+        timer_wait_operation(timer_service& service, std::chrono::steady_clock::time_point deadline,
+            std::stop_token stopToken) noexcept :
+            m_service{ service },
+            m_deadline{ deadline },
+            m_stopToken{ std::move(stopToken) },
+            m_heapIndex{},
+            m_remaining{ 2 },
+            m_canceled{ false },
+            m_handle{},
+            m_stopCallback{},
+            m_select{},
+            m_selectIndex{}
+        {
+        }
+
+        timer_wait_operation(const timer_wait_operation&) = delete;
+
+        // The operation may be moved (for example, into when_any) only before it is awaited.
+        timer_wait_operation(timer_wait_operation&& other) noexcept :
+            timer_wait_operation{ other.m_service, other.m_deadline, std::move(other.m_stopToken) }
+        {
+        }
+
+        ~timer_wait_operation() noexcept = default;
+
+        timer_wait_operation& operator=(const timer_wait_operation&) = delete;
+        timer_wait_operation& operator=(timer_wait_operation&&) noexcept = delete;
+
+        [[nodiscard]] bool await_ready() noexcept
+        {
+            m_canceled = m_stopToken.stop_requested();
+            return m_canceled || m_deadline <= std::chrono::steady_clock::now();
+        }
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle);
+
+        void await_resume() const
+        {
+            if (m_canceled)
+            {
+                throw task_canceled{};
+            }
+        }
+
+        // Used by select instead of await_suspend; returns false if the wait did not need to be queued (because the
+        // service is being destroyed). The stop token is not observed once the wait is queued.
+        [[nodiscard]] bool select_suspend(select_state& state, std::size_t index);
+
+        // Used by select to remove the wait from the timer heap if it is still pending.
+        void select_cancel() noexcept;
+
+    private:
+        friend struct ::async::timer_service;
+
+        struct cancel_callback final
+        {
+            void operator()() const noexcept;
+
+            timer_wait_operation* operation;
+        };
+
+        // Called with the timer service's lock held, when the operation has been removed from the timer heap; returns
+        // false if the operation is a select alternative that lost (so it must be dropped without being completed).
+        // The lock keeps a losing alternative alive until then, since select_cancel() takes the lock too.
+        [[nodiscard]] bool try_claim() noexcept { return m_select == nullptr || m_select->try_claim(m_selectIndex); }
+
+        // Called exactly once, by whichever of the timer thread or a stop request removed this operation from the
+        // timer heap. The awaiting coroutine counts down once as well, after it has finished await_suspend, so it is
+        // never resumed before then.
+        void complete(bool canceled) noexcept
+        {
+            m_canceled = canceled;
+
+            if (m_select != nullptr)
+            {
+                m_select->complete();
+            }
+            else if (m_remaining.fetch_sub(1) == 1)
+            {
+                m_handle.resume();
+            }
+        }
+
+        timer_service& m_service;
+        const std::chrono::steady_clock::time_point m_deadline;
+        std::stop_token m_stopToken;
+        std::size_t m_heapIndex;
+        atomic_acq_rel<int> m_remaining;
+        bool m_canceled;
+        std::coroutine_handle<> m_handle;
+        std::optional<std::stop_callback<cancel_callback>> m_stopCallback;
+        select_state* m_select;
+        std::size_t m_selectIndex;
+    };
+}
+
+namespace async
+{
+    // Runs a single background thread that resumes coroutines waiting for deadlines, so any number of pending waits
+    // (and timeouts; see with_timeout.h) share one thread that sleeps until the earliest deadline. Pending waits are
+    // kept in a binary heap, so adding or canceling a wait is O(log n). Waiting coroutines are resumed on the timer
+    // thread, which should therefore not be blocked by them for long.
+    struct timer_service final
+    {
+        timer_service() : m_mutex{}, m_wake{}, m_heap{}, m_stopping{ false }, m_thread{ [this]() { run(); } } {}
+
+        timer_service(const timer_service&) = delete;
+        timer_service(timer_service&&) noexcept = delete;
+
+        // Any waits still pending complete by throwing task_canceled.
+        ~timer_service() noexcept
+        {
+            {
+                std::lock_guard<std::mutex> mutexLock{ m_mutex };
+                m_stopping = true;
+            }
+
+            m_wake.notify_one();
+            m_thread.join();
+        }
+
+        timer_service& operator=(const timer_service&) = delete;
+        timer_service& operator=(timer_service&&) noexcept = delete;
+
+        // A timer service shared by the whole process, started on first use.
+        [[nodiscard]] static timer_service& shared()
+        {
+            static timer_service service{};
+            return service;
+        }
+
+        // co_await wait_until(deadline) suspends until the deadline passes. If stop is requested on stopToken first,
+        // the wait is removed from the timer heap and co_await throws task_canceled.
+        [[nodiscard]] details::timer_wait_operation wait_until(
+            std::chrono::steady_clock::time_point deadline, std::stop_token stopToken = {}) noexcept
+        {
+            return details::timer_wait_operation{ *this, deadline, std::move(stopToken) };
+        }
+
+        template <typename Rep, typename Period>
+        [[nodiscard]] details::timer_wait_operation wait_for(
+            const std::chrono::duration<Rep, Period>& duration, std::stop_token stopToken = {}) noexcept
+        {
+            return wait_until(std::chrono::steady_clock::now() +
+                                  std::chrono::duration_cast<std::chrono::steady_clock::duration>(duration),
+                std::move(stopToken));
+        }
+
+        [[nodiscard]] std::size_t pending_count() const
+        {
+            std::lock_guard<std::mutex> mutexLock{ m_mutex };
+            return m_heap.size();
+        }
+
+    private:
+        friend struct details::timer_wait_operation;
+
+        // Returns false if the service is being destroyed (so the operation was not inserted).
+        [[nodiscard]] bool try_insert(details::timer_wait_operation& operation)
+        {
+            bool earliest{};
+
+            {
+                std::lock_guard<std::mutex> mutexLock{ m_mutex };
+
+                if (m_stopping)
+                {
+                    return false;
+                }
+
+                operation.m_heapIndex = m_heap.size();
+                m_heap.push_back(&operation);
+                sift_up(operation.m_heapIndex);
+                earliest = operation.m_heapIndex == 0;
+            }
+
+            // The timer thread needs to wake up earlier only if this is now the earliest deadline.
+            if (earliest)
+            {
+                m_wake.notify_one();
+            }
+
+            return true;
+        }
+
+        // Returns false if the operation has already been removed (by the timer thread or an earlier call).
+        [[nodiscard]] bool try_remove(details::timer_wait_operation& operation) noexcept
+        {
+            std::lock_guard<std::mutex> mutexLock{ m_mutex };
+            const std::size_t index{ operation.m_heapIndex };
+
+            if (index >= m_heap.size() || m_heap[index] != &operation)
+            {
+                return false;
+            }
+
+            remove_at(index);
+            return true;
+        }
+
+        void run()
+        {
+            std::vector<details::timer_wait_operation*> expired{};
+            std::unique_lock<std::mutex> mutexLock{ m_mutex };
+
+            while (!m_stopping)
+            {
+                if (m_heap.empty())
+                {
+                    m_wake.wait(mutexLock);
+                    continue;
+                }
+
+                const std::chrono::steady_clock::time_point now{ std::chrono::steady_clock::now() };
+
+                if (m_heap.front()->m_deadline > now)
+                {
+                    m_wake.wait_until(mutexLock, m_heap.front()->m_deadline);
+                    continue;
+                }
+
+                while (!m_heap.empty() && m_heap.front()->m_deadline <= now)
+                {
+                    details::timer_wait_operation* const operation{ m_heap.front() };
+                    remove_at(0);
+
+                    if (operation->try_claim())
+                    {
+                        expired.push_back(operation);
+                    }
+                }
+
+                // Resume outside the lock; resumed coroutines may start new waits or cancel others.
+                mutexLock.unlock();
+                complete_all(expired, false);
+                mutexLock.lock();
+            }
+
+            while (!m_heap.empty())
+            {
+                details::timer_wait_operation* const operation{ m_heap.back() };
+                m_heap.pop_back();
+
+                if (operation->try_claim())
+                {
+                    expired.push_back(operation);
+                }
+            }
+
+            mutexLock.unlock();
+            complete_all(expired, true);
+        }
+
+        static void complete_all(std::vector<details::timer_wait_operation*>& operations, bool canceled) noexcept
+        {
+            for (details::timer_wait_operation* operation : operations)
+            {
+                operation->complete(canceled);
+            }
+
+            operations.clear();
+        }
+
+        void remove_at(std::size_t index) noexcept
+        {
+            const std::size_t last{ m_heap.size() - 1 };
+
+            if (index != last)
+            {
+                m_heap[index] = m_heap[last];
+                m_heap[index]->m_heapIndex = index;
+            }
+
+            m_heap.pop_back();
+
+            if (index != last)
+            {
+                sift_down(index);
+                sift_up(index);
+            }
+        }
+
+        void sift_up(std::size_t index) noexcept
+        {
+            while (index != 0)
+            {
+                const std::size_t parent{ (index - 1) / 2 };
+
+                if (m_heap[parent]->m_deadline <= m_heap[index]->m_deadline)
+                {
+                    break;
+                }
+
+                swap_at(index, parent);
+                index = parent;
+            }
+        }
+
+        void sift_down(std::size_t index) noexcept
+        {
+            while (true)
+            {
+                const std::size_t left{ index * 2 + 1 };
+                const std::size_t right{ left + 1 };
+                std::size_t smallest{ index };
+
+                if (left < m_heap.size() && m_heap[left]->m_deadline < m_heap[smallest]->m_deadline)
+                {
+                    smallest = left;
+                }
+
+                if (right < m_heap.size() && m_heap[right]->m_deadline < m_heap[smallest]->m_deadline)
+                {
+                    smallest = right;
+                }
+
+                if (smallest == index)
+                {
+                    break;
+                }
+
+                swap_at(index, smallest);
+                index = smallest;
+            }
+        }
+
+        void swap_at(std::size_t first, std::size_t second) noexcept
+        {
+            std::swap(m_heap[first], m_heap[second]);
+            m_heap[first]->m_heapIndex = first;
+            m_heap[second]->m_heapIndex = second;
+        }
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::vector<details::timer_wait_operation*> m_heap;
+        bool m_stopping;
+        std::thread m_thread;
+    };
+}
+
+namespace async::details
+{
+    inline bool timer_wait_operation::await_suspend(std::coroutine_handle<> handle)
+    {
+        m_handle = handle;
+
+        if (!m_service.try_insert(*this))
+        {
+            m_canceled = true;
+            return false;
+        }
+
+        if (m_stopToken.stop_possible())
+        {
+            // If stop has already been requested, this runs the callback (and removes the wait) immediately.
+            m_stopCallback.emplace(m_stopToken, cancel_callback{ this });
+        }
+
+        return m_remaining.fetch_sub(1) > 1;
+    }
+
+    inline bool timer_wait_operation::select_suspend(select_state& state, std::size_t index)
+    {
+        m_select = std::addressof(state);
+        m_selectIndex = index;
+
+        if (!m_service.try_insert(*this))
+        {
+            if (state.try_claim(index))
+            {
+                m_canceled = true;
+                state.complete();
+            }
+
+            return false;
+        }
+
+        return true;
+    }
+
+    inline void timer_wait_operation::select_cancel() noexcept
+    {
+        std::ignore = m_service.try_remove(*this);
+    }
+
+    inline void timer_wait_operation::cancel_callback::operator()() const noexcept
+    {
+        if (operation->m_service.try_remove(*operation))
+        {
+            operation->complete(true);
+        }
+    }
+}
@@ -0,0 +1,212 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <coroutine>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include "atomic_acq_rel.h"
+
+namespace async
+{
+    template <typename T>
+    struct watch;
+
+    // A value published to a watch<T>, and its version. Snapshots are immutable and shared by every reader.
+    template <typename T>
+    struct watch_value final
+    {
+        std::uint64_t version;
+        T value;
+    };
+}
+
+namespace async::details
+{
+    template <typename T>
+    struct watch_changed_operation final
+    {
+        watch_changed_operation(watch<T>& cell, std::uint64_t lastSeenVersion) noexcept :
+            m_cell{ cell }, m_lastSeenVersion{ lastSeenVersion }, m_next{}, m_handle{}
+        {
+        }
+
+        [[nodiscard]] bool await_ready() const noexcept { return m_cell.is_changed_or_closed(m_lastSeenVersion); }
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle)
+        {
+            m_handle = handle;
+            return m_cell.try_enqueue(*this);
+        }
+
+        // Returns the latest value, or nullptr if the watch was closed without a version newer than lastSeenVersion.
+        [[nodiscard]] std::shared_ptr<const watch_value<T>> await_resume() const
+        {
+            if (m_cell.m_version.load() <= m_lastSeenVersion)
+            {
+                return nullptr;
+            }
+
+            return m_cell.get();
+        }
+
+    private:
+        friend struct ::async::watch<T>;
+
+        watch<T>& m_cell;
+        const std::uint64_t m_lastSeenVersion;
+        watch_changed_operation* m_next;
+        std::coroutine_handle<> m_handle;
+    };
+}
+
+namespace async
+{
+    // A cell holding the most recently published value, for state (such as configuration or health) where only the
+    // latest value matters. Each publish() creates a new immutable snapshot with the next version (the initial value
+    // is version 0); readers share the current snapshot by reference count (as in RCU), so reading never blocks
+    // writers and never copies T. get() and version() are lock-free on the read side, and co_await changed(version)
+    // does not suspend (and costs two atomic loads) if a newer version already exists. Otherwise it suspends until the
+    // next publish() (or close()), which resumes waiting coroutines inline. A slow waiter receives only the latest
+    // version and never sees the intermediate ones.
+    // Concurrent publish() calls are serialized. The watch must not be destroyed while any coroutines are waiting.
+    template <typename T>
+    struct watch final
+    {
+        explicit watch(T initialValue) :
+            m_current{ std::make_shared<const watch_value<T>>(watch_value<T>{ 0, std::move(initialValue) }) },
+            m_version{ 0 },
+            m_mutex{},
+            m_closed{ false },
+            m_waiters{}
+        {
+        }
+
+        watch(const watch&) = delete;
+        watch(watch&&) noexcept = delete;
+
+        ~watch() noexcept
+        {
+            // The watch must not be destroyed while any coroutines are waiting.
+            assert(m_waiters == nullptr);
+        }
+
+        watch& operator=(const watch&) = delete;
+        watch& operator=(watch&&) noexcept = delete;
+
+        // Returns the current snapshot.
+        [[nodiscard]] std::shared_ptr<const watch_value<T>> get() const noexcept
+        {
+            return m_current.load(std::memory_order_acquire);
+        }
+
+        // Returns the current version, without accessing the value.
+        [[nodiscard]] std::uint64_t version() const noexcept { return m_version.load(); }
+
+        // co_await changed(lastSeenVersion) returns the current snapshot once its version is newer than
+        // lastSeenVersion, or nullptr if the watch is closed first.
+        [[nodiscard]] details::watch_changed_operation<T> changed(std::uint64_t lastSeenVersion) noexcept
+        {
+            return details::watch_changed_operation<T>{ *this, lastSeenVersion };
+        }
+
+        // Makes value the current value, resumes every waiting coroutine, and returns the new version. Must not be
+        // called after close().
+        std::uint64_t publish(T value)
+        {
+            details::watch_changed_operation<T>* waiters{};
+            std::uint64_t version{};
+
+            {
+                std::lock_guard<std::mutex> mutexLock{ m_mutex };
+                assert(!m_closed.load());
+                version = m_version.load() + 1;
+                m_current.store(std::make_shared<const watch_value<T>>(watch_value<T>{ version, std::move(value) }),
+                    std::memory_order_release);
+
+                // The snapshot is stored before the version, so a reader that sees the new version also sees the new
+                // snapshot (or a later one).
+                m_version = version;
+                waiters = std::exchange(m_waiters, nullptr);
+            }
+
+            resume_all(waiters);
+            return version;
+        }
+
+        // Resumes every waiting coroutine; changed() then returns nullptr unless a newer version already exists.
+        void close()
+        {
+            details::watch_changed_operation<T>* waiters{};
+
+            {
+                std::lock_guard<std::mutex> mutexLock{ m_mutex };
+                m_closed = true;
+                waiters = std::exchange(m_waiters, nullptr);
+            }
+
+            resume_all(waiters);
+        }
+
+    private:
+        friend struct details::watch_changed_operation<T>;
+
+        [[nodiscard]] bool is_changed_or_closed(std::uint64_t lastSeenVersion) const noexcept
+        {
+            return m_version.load() > lastSeenVersion || m_closed.load();
+        }
+
+        // Returns false if the operation did not need to be queued (because a newer version was published or the
+        // watch was closed).
+        [[nodiscard]] bool try_enqueue(details::watch_changed_operation<T>& operation)
+        {
+            std::lock_guard<std::mutex> mutexLock{ m_mutex };
+
+            // publish() and close() hold the same lock, so neither can complete between this check and the enqueue.
+            if (is_changed_or_closed(operation.m_lastSeenVersion))
+            {
+                return false;
+            }
+
+            operation.m_next = m_waiters;
+            m_waiters = &operation;
+            return true;
+        }
+
+        static void resume_all(details::watch_changed_operation<T>* waiters) noexcept
+        {
+            // Waiters were pushed in LIFO order; resume them in the order they arrived.
+            details::watch_changed_operation<T>* head{};
+
+            while (waiters != nullptr)
+            {
+                details::watch_changed_operation<T>* following{ waiters->m_next };
+                waiters->m_next = head;
+                head = waiters;
+                waiters = following;
+            }
+
+            while (head != nullptr)
+            {
+                // Read next before resuming; the resumed coroutine may destroy the operation.
+                details::watch_changed_operation<T>* following{ head->m_next };
+                head->m_handle.resume();
+                head = following;
+            }
+        }
+
+        std::atomic<std::shared_ptr<const watch_value<T>>> m_current;
+
+        // Polled by every reader; kept on its own cache line, away from the state writers modify under the lock.
+        details::padded_atomic_acq_rel<std::uint64_t> m_version;
+
+        // Serializes writers and guards the waiter list; readers never take it.
+        std::mutex m_mutex;
+        details::atomic_acq_rel<bool> m_closed;
+        details::watch_changed_operation<T>* m_waiters;
+    };
+}
@@ -0,0 +1,356 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "atomic_acq_rel.h"
+#include "awaitable_result.h"
+#include "awaitable_resume_t.h"
+
+namespace async::details
+{
+    // void results are represented as std::monostate in a when_all tuple.
+    template <typename T>
+    using when_all_tuple_element_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    // Counts outstanding children plus the awaiting coroutine itself, so whichever finishes last (a child completing or
+    // the awaiting coroutine finishing starting all children) is the one that resumes the awaiting coroutine.
+    struct when_all_counter final
+    {
+        explicit when_all_counter(std::size_t childCount) noexcept : m_count{ childCount + 1 }, m_awaiting{} {}
+
+        when_all_counter(const when_all_counter&) = delete;
+        when_all_counter(when_all_counter&&) noexcept = delete;
+
+        ~when_all_counter() noexcept = default;
+
+        when_all_counter& operator=(const when_all_counter&) = delete;
+        when_all_counter& operator=(when_all_counter&&) noexcept = delete;
+
+        void set_awaiting(std::coroutine_handle<> awaiting) noexcept { m_awaiting = awaiting; }
+
+        // Called by the awaiting coroutine after starting all children; returns true if it must suspend.
+        [[nodiscard]] bool try_await() noexcept { return m_count.fetch_sub(1) > 1; }
+
+        // Called by each child as it completes; returns the coroutine to run next.
+        [[nodiscard]] std::coroutine_handle<> complete() noexcept
+        {
+            return m_count.fetch_sub(1) == 1 ? m_awaiting : std::noop_coroutine();
+        }
+
+    private:
+        atomic_acq_rel<std::size_t> m_count;
+        std::coroutine_handle<> m_awaiting;
+    };
+
+    template <typename T>
+    struct when_all_child;
+
+    template <typename T>
+    struct when_all_child_promise_base
+    {
+        struct final_awaiter final
+        {
+            [[nodiscard]] constexpr bool await_ready() const noexcept { return false; }
+
+            template <typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+            {
+                return handle.promise().counter->complete();
+            }
+
+            constexpr void await_resume() const noexcept {}
+        };
+
+        constexpr std::suspend_always initial_suspend() const noexcept { return {}; }
+
+        constexpr final_awaiter final_suspend() const noexcept { return {}; }
+
+        void unhandled_exception() noexcept { result.set_exception(std::current_exception()); }
+
+        when_all_counter* counter{};
+
+        // The child's result is stored in place in its own coroutine frame until the awaiting coroutine collects it.
+        awaitable_result<T> result{};
+    };
+
+    template <typename T>
+    struct when_all_child_promise final : when_all_child_promise_base<T>
+    {
+        when_all_child<T> get_return_object() noexcept;
+
+        void return_value(T value) noexcept { this->result.set_value(std::forward<T>(value)); }
+    };
+
+    template <>
+    struct when_all_child_promise<void> final : when_all_child_promise_base<void>
+    {
+        when_all_child<void> get_return_object() noexcept;
+
+        constexpr void return_void() const noexcept {}
+    };
+
+    template <typename T>
+    struct when_all_child final
+    {
+        using promise_type = when_all_child_promise<T>;
+
+        explicit when_all_child(std::coroutine_handle<promise_type> handle) noexcept : m_handle{ handle } {}
+
+        when_all_child(const when_all_child&) = delete;
+
+        when_all_child(when_all_child&& other) noexcept : m_handle{ std::exchange(other.m_handle, {}) } {}
+
+        ~when_all_child() noexcept
+        {
+            if (m_handle)
+            {
+                m_handle.destroy();
+            }
+        }
+
+        when_all_child& operator=(const when_all_child&) = delete;
+        when_all_child& operator=(when_all_child&&) noexcept = delete;
+
+        void start(when_all_counter& counter) const
+        {
+            m_handle.promise().counter = &counter;
+            m_handle.resume();
+        }
+
+        // Moves out the child's result (or rethrows its exception).
+        [[nodiscard]] when_all_tuple_element_t<T> get() const
+        {
+            if constexpr (std::is_void_v<T>)
+            {
+                m_handle.promise().result();
+                return std::monostate{};
+            }
+            else
+            {
+                return m_handle.promise().result();
+            }
+        }
+
+        // Moves out the child's result without rethrowing its exception.
+        [[nodiscard]] awaitable_result<T> take_result() const noexcept { return std::move(m_handle.promise().result); }
+
+    private:
+        std::coroutine_handle<promise_type> m_handle;
+    };
+
+    template <typename T>
+    inline when_all_child<T> when_all_child_promise<T>::get_return_object() noexcept
+    {
+        return when_all_child<T>{ std::coroutine_handle<when_all_child_promise<T>>::from_promise(*this) };
+    }
+
+    inline when_all_child<void> when_all_child_promise<void>::get_return_object() noexcept
+    {
+        return when_all_child<void>{ std::coroutine_handle<when_all_child_promise<void>>::from_promise(*this) };
+    }
+
+    template <typename T, typename Awaitable>
+    struct when_all_child_factory final
+    {
+        static when_all_child<T> create(Awaitable awaitable)
+        {
+            Awaitable capturedAwaitable{ std::move(awaitable) };
+            co_return co_await std::move(capturedAwaitable);
+        }
+    };
+
+    template <typename Awaitable>
+    struct when_all_child_factory<void, Awaitable> final
+    {
+        static when_all_child<void> create(Awaitable awaitable)
+        {
+            Awaitable capturedAwaitable{ std::move(awaitable) };
+            co_await std::move(capturedAwaitable);
+        }
+    };
+
+    template <typename Awaitable>
+    [[nodiscard]] when_all_child<awaitable_resume_t<Awaitable>> make_when_all_child(Awaitable awaitable)
+    {
+        return when_all_child_factory<awaitable_resume_t<Awaitable>, Awaitable>::create(std::move(awaitable));
+    }
+
+    template <typename Range>
+    [[nodiscard]] auto make_when_all_children(Range& awaitables)
+    {
+        using Awaitable = std::remove_reference_t<decltype(*std::begin(awaitables))>;
+        std::vector<when_all_child<awaitable_resume_t<Awaitable>>> children{};
+
+        for (Awaitable& awaitable : awaitables)
+        {
+            children.push_back(make_when_all_child(std::move(awaitable)));
+        }
+
+        return children;
+    }
+
+    // When Settled is true, produces each child's awaitable_result rather than rethrowing exceptions.
+    template <bool Settled, typename... T>
+    struct when_all_tuple_awaitable final
+    {
+        explicit when_all_tuple_awaitable(when_all_child<T>&&... children) noexcept :
+            m_counter{ sizeof...(T) }, m_children{ std::move(children)... }
+        {
+        }
+
+        [[nodiscard]] constexpr bool await_ready() const noexcept { return sizeof...(T) == 0; }
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle)
+        {
+            m_counter.set_awaiting(handle);
+            std::apply([this](const when_all_child<T>&... children) { (children.start(m_counter), ...); }, m_children);
+            return m_counter.try_await();
+        }
+
+        // Collects results in argument order; unless Settled, if any child threw, rethrows the first such exception in
+        // that order.
+        [[nodiscard]] auto await_resume() const
+        {
+            if constexpr (Settled)
+            {
+                return std::apply([](const when_all_child<T>&... children)
+                    { return std::tuple<awaitable_result<T>...>{ children.take_result()... }; },
+                    m_children);
+            }
+            else
+            {
+                return std::apply([](const when_all_child<T>&... children)
+                    { return std::tuple<when_all_tuple_element_t<T>...>{ children.get()... }; },
+                    m_children);
+            }
+        }
+
+    private:
+        when_all_counter m_counter;
+        std::tuple<when_all_child<T>...> m_children;
+    };
+
+    template <bool Settled, typename T>
+    struct when_all_range_awaitable final
+    {
+        explicit when_all_range_awaitable(std::vector<when_all_child<T>>&& children) noexcept :
+            m_counter{ children.size() }, m_children{ std::move(children) }
+        {
+        }
+
+        [[nodiscard]] bool await_ready() const noexcept { return m_children.empty(); }
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle)
+        {
+            m_counter.set_awaiting(handle);
+
+            for (const when_all_child<T>& child : m_children)
+            {
+                child.start(m_counter);
+            }
+
+            return m_counter.try_await();
+        }
+
+        // Collects results in range order; unless Settled, if any child threw, rethrows the first such exception in
+        // that order.
+        auto await_resume() const
+        {
+            if constexpr (Settled)
+            {
+                std::vector<awaitable_result<T>> results{};
+                results.reserve(m_children.size());
+
+                for (const when_all_child<T>& child : m_children)
+                {
+                    results.push_back(child.take_result());
+                }
+
+                return results;
+            }
+            else if constexpr (std::is_void_v<T>)
+            {
+                for (const when_all_child<T>& child : m_children)
+                {
+                    std::ignore = child.get();
+                }
+            }
+            else
+            {
+                std::vector<T> results{};
+                results.reserve(m_children.size());
+
+                for (const when_all_child<T>& child : m_children)
+                {
+                    results.push_back(child.get());
+                }
+
+                return results;
+            }
+        }
+
+    private:
+        when_all_counter m_counter;
+        std::vector<when_all_child<T>> m_children;
+    };
+}
+
+namespace async
+{
+    // Returns an awaitable that starts every awaitable concurrently when co_awaited and completes when all of them
+    // have completed, producing a std::tuple of their results (std::monostate for void results). If any awaitable
+    // throws, co_await rethrows the first exception in argument order, but only after all awaitables have completed.
+    // Each awaitable runs in its own coroutine frame, which also holds its result until it is collected; completions
+    // are counted with a single shared atomic counter.
+    template <typename... Awaitables,
+        typename = std::enable_if_t<(details::is_awaitable_v<Awaitables> && ...)>>
+    [[nodiscard]] details::when_all_tuple_awaitable<false, awaitable_resume_t<Awaitables>...> when_all(
+        Awaitables... awaitables)
+    {
+        return details::when_all_tuple_awaitable<false, awaitable_resume_t<Awaitables>...>{
+            details::make_when_all_child(std::move(awaitables))...
+        };
+    }
+
+    // Like the variadic when_all, but for a range of awaitables of the same type; produces a std::vector of their
+    // results (or void, for void results). Result types must not be references.
+    template <typename Range, typename = std::enable_if_t<details::is_awaitable_range<Range>::value>>
+    [[nodiscard]] auto when_all(Range awaitables)
+    {
+        using Awaitable = std::remove_reference_t<decltype(*std::begin(awaitables))>;
+        using T = awaitable_resume_t<Awaitable>;
+        static_assert(!std::is_reference_v<T>, "when_all for a range requires non-reference results.");
+
+        return details::when_all_range_awaitable<false, T>{ details::make_when_all_children(awaitables) };
+    }
+
+    // Like the variadic when_all, but never throws: produces a std::tuple holding each awaitable's awaitable_result
+    // (its value or exception), for callers that need every outcome rather than just the first failure. Each result is
+    // moved out of its child's coroutine frame, so nothing is allocated beyond those frames.
+    template <typename... Awaitables,
+        typename = std::enable_if_t<(details::is_awaitable_v<Awaitables> && ...)>>
+    [[nodiscard]] details::when_all_tuple_awaitable<true, awaitable_resume_t<Awaitables>...> when_all_settled(
+        Awaitables... awaitables)
+    {
+        return details::when_all_tuple_awaitable<true, awaitable_resume_t<Awaitables>...>{
+            details::make_when_all_child(std::move(awaitables))...
+        };
+    }
+
+    // Like when_all_settled, but for a range of awaitables of the same type; produces a std::vector of their
+    // awaitable_results, in range order, stored contiguously in a single allocation.
+    template <typename Range, typename = std::enable_if_t<details::is_awaitable_range<Range>::value>>
+    [[nodiscard]] auto when_all_settled(Range awaitables)
+    {
+        using T = awaitable_resume_t<std::remove_reference_t<decltype(*std::begin(awaitables))>>;
+        return details::when_all_range_awaitable<true, T>{ details::make_when_all_children(awaitables) };
+    }
+}
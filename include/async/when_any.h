@@ -0,0 +1,314 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "atomic_acq_rel.h"
+#include "awaitable_result.h"
+#include "awaitable_resume_t.h"
+
+namespace async
+{
+    // The result of when_any for a range of awaitables: the index of the first awaitable to complete, and its result.
+    template <typename T>
+    struct when_any_result final
+    {
+        std::size_t index;
+        T value;
+    };
+
+    template <>
+    struct when_any_result<void> final
+    {
+        std::size_t index;
+    };
+}
+
+namespace async::details
+{
+    // A std::variant may not hold void or references, so void results are represented as std::monostate and
+    // reference results as std::reference_wrapper.
+    template <typename T>
+    using when_any_variant_element_t = std::conditional_t<std::is_void_v<T>, std::monostate,
+        std::conditional_t<std::is_reference_v<T>, std::reference_wrapper<std::remove_reference_t<T>>, T>>;
+
+    // A coroutine that starts suspended and destroys itself when it completes, so a loser that completes after the
+    // awaiting coroutine has resumed (and discarded the when_any awaitable) cleans up after itself.
+    struct when_any_child final
+    {
+        struct promise_type final
+        {
+            when_any_child get_return_object() noexcept
+            {
+                return when_any_child{ std::coroutine_handle<promise_type>::from_promise(*this) };
+            }
+
+            constexpr std::suspend_always initial_suspend() const noexcept { return {}; }
+            void unhandled_exception() const noexcept { std::terminate(); }
+            constexpr void return_void() const noexcept {}
+            constexpr std::suspend_never final_suspend() const noexcept { return {}; }
+        };
+
+        explicit when_any_child(std::coroutine_handle<> handle) noexcept : m_handle{ handle } {}
+
+        when_any_child(const when_any_child&) = delete;
+
+        when_any_child(when_any_child&& other) noexcept : m_handle{ std::exchange(other.m_handle, {}) } {}
+
+        ~when_any_child() noexcept
+        {
+            // Destroy the child only if it was never started; once started, it owns itself.
+            if (m_handle)
+            {
+                m_handle.destroy();
+            }
+        }
+
+        when_any_child& operator=(const when_any_child&) = delete;
+        when_any_child& operator=(when_any_child&&) noexcept = delete;
+
+        void start() noexcept { std::exchange(m_handle, {}).resume(); }
+
+    private:
+        std::coroutine_handle<> m_handle;
+    };
+
+    // Shared by the when_any awaitable and every started child, so it outlives the awaiting coroutine's interest in
+    // it until the last loser completes.
+    template <typename Result>
+    struct when_any_state final
+    {
+        explicit when_any_state(std::stop_source stopSource) noexcept :
+            m_won{ false }, m_remaining{ 2 }, m_awaiting{}, m_stopSource{ std::move(stopSource) }, m_result{}
+        {
+        }
+
+        when_any_state(const when_any_state&) = delete;
+        when_any_state(when_any_state&&) noexcept = delete;
+
+        ~when_any_state() noexcept = default;
+
+        when_any_state& operator=(const when_any_state&) = delete;
+        when_any_state& operator=(when_any_state&&) noexcept = delete;
+
+        [[nodiscard]] bool has_winner() const noexcept { return m_won.load(); }
+
+        template <typename... Args>
+        void set_value(Args&&... args) noexcept
+        {
+            if (try_win())
+            {
+                m_result.set_value(Result{ std::forward<Args>(args)... });
+                complete();
+            }
+        }
+
+        void set_exception(const std::exception_ptr& exception) noexcept
+        {
+            if (try_win())
+            {
+                m_result.set_exception(exception);
+                complete();
+            }
+        }
+
+        // Called by the awaiting coroutine after it has finished starting children; returns true if it must suspend.
+        [[nodiscard]] bool try_await(std::coroutine_handle<> awaiting) noexcept
+        {
+            m_awaiting = awaiting;
+            return m_remaining.fetch_sub(1) > 1;
+        }
+
+        [[nodiscard]] Result get() { return m_result(); }
+
+    private:
+        [[nodiscard]] bool try_win() noexcept
+        {
+            bool expected{ false };
+            return m_won.compare_exchange_strong(expected, true);
+        }
+
+        void complete() noexcept
+        {
+            m_stopSource.request_stop();
+
+            // The winner and the awaiting coroutine (once it has finished starting children) each count down once, so
+            // the awaiting coroutine is never resumed while it is still starting children.
+            if (m_remaining.fetch_sub(1) == 1)
+            {
+                m_awaiting.resume();
+            }
+        }
+
+        atomic_acq_rel<bool> m_won;
+        atomic_acq_rel<int> m_remaining;
+        std::coroutine_handle<> m_awaiting;
+        std::stop_source m_stopSource;
+        awaitable_result<Result> m_result;
+    };
+
+    template <typename T, typename Awaitable>
+    struct when_any_child_factory final
+    {
+        template <typename Result, typename... Tag>
+        static when_any_child create(std::shared_ptr<when_any_state<Result>> state, Awaitable awaitable, Tag... tag)
+        {
+            std::shared_ptr<when_any_state<Result>> capturedState{ std::move(state) };
+            Awaitable capturedAwaitable{ std::move(awaitable) };
+
+            try
+            {
+                capturedState->set_value(tag..., co_await std::move(capturedAwaitable));
+            }
+            catch (...)
+            {
+                capturedState->set_exception(std::current_exception());
+            }
+        }
+    };
+
+    template <typename Awaitable>
+    struct when_any_child_factory<void, Awaitable> final
+    {
+        template <typename Result, typename... Tag>
+        static when_any_child create(std::shared_ptr<when_any_state<Result>> state, Awaitable awaitable, Tag... tag)
+        {
+            std::shared_ptr<when_any_state<Result>> capturedState{ std::move(state) };
+            Awaitable capturedAwaitable{ std::move(awaitable) };
+
+            try
+            {
+                co_await std::move(capturedAwaitable);
+                capturedState->set_value(tag...);
+            }
+            catch (...)
+            {
+                capturedState->set_exception(std::current_exception());
+            }
+        }
+    };
+
+    template <typename Result>
+    struct when_any_awaitable final
+    {
+        when_any_awaitable(
+            std::shared_ptr<when_any_state<Result>> state, std::vector<when_any_child>&& children) noexcept :
+            m_state{ std::move(state) }, m_children{ std::move(children) }
+        {
+        }
+
+        [[nodiscard]] constexpr bool await_ready() const noexcept { return false; }
+
+        [[nodiscard]] bool await_suspend(std::coroutine_handle<> handle)
+        {
+            // Once a winner is known, do not start the remaining children; they are destroyed with this awaitable.
+            for (when_any_child& child : m_children)
+            {
+                if (m_state->has_winner())
+                {
+                    break;
+                }
+
+                child.start();
+            }
+
+            return m_state->try_await(handle);
+        }
+
+        [[nodiscard]] Result await_resume() const { return m_state->get(); }
+
+    private:
+        std::shared_ptr<when_any_state<Result>> m_state;
+        std::vector<when_any_child> m_children;
+    };
+
+    template <typename Result, typename Awaitable, typename... Tag>
+    [[nodiscard]] when_any_child make_when_any_child(
+        const std::shared_ptr<when_any_state<Result>>& state, Awaitable awaitable, Tag... tag)
+    {
+        return when_any_child_factory<awaitable_resume_t<Awaitable>, Awaitable>::create(
+            state, std::move(awaitable), tag...);
+    }
+
+    template <typename... Awaitables, std::size_t... Indexes>
+    [[nodiscard]] auto make_when_any(
+        std::stop_source stopSource, std::index_sequence<Indexes...>, Awaitables... awaitables)
+    {
+        using Result = std::variant<when_any_variant_element_t<awaitable_resume_t<Awaitables>>...>;
+        std::shared_ptr<when_any_state<Result>> state{ std::make_shared<when_any_state<Result>>(
+            std::move(stopSource)) };
+        std::vector<when_any_child> children{};
+        children.reserve(sizeof...(Awaitables));
+        (children.push_back(make_when_any_child(state, std::move(awaitables), std::in_place_index<Indexes>)), ...);
+        return when_any_awaitable<Result>{ std::move(state), std::move(children) };
+    }
+}
+
+namespace async
+{
+    // Returns an awaitable that starts the awaitables in order when co_awaited (stopping early if one completes while
+    // the others are being started) and completes as soon as the first of them completes, producing a std::variant
+    // whose index() is the index of that awaitable and whose alternative holds its result (std::monostate for void,
+    // std::reference_wrapper for references). If the first awaitable to complete throws, co_await rethrows that
+    // exception. When the first awaitable completes, stopSource.request_stop() is called so that the others (which
+    // should be created with stopSource.get_token()) can abort; they are neither awaited nor leaked, and clean up
+    // after themselves whenever they complete.
+    template <typename... Awaitables, typename = std::enable_if_t<(details::is_awaitable_v<Awaitables> && ...)>>
+    [[nodiscard]] auto when_any(std::stop_source stopSource, Awaitables... awaitables)
+    {
+        static_assert(sizeof...(Awaitables) != 0, "when_any requires at least one awaitable.");
+        return details::make_when_any(
+            std::move(stopSource), std::index_sequence_for<Awaitables...>{}, std::move(awaitables)...);
+    }
+
+    // Like when_any(stopSource, awaitables...), for awaitables that do not need to be told to stop.
+    template <typename... Awaitables, typename = std::enable_if_t<(details::is_awaitable_v<Awaitables> && ...)>>
+    [[nodiscard]] auto when_any(Awaitables... awaitables)
+    {
+        return when_any(std::stop_source{ std::nostopstate }, std::move(awaitables)...);
+    }
+
+    // Like when_any(stopSource, awaitables...), but for a non-empty range of awaitables of the same type; produces a
+    // when_any_result holding the index of the first awaitable to complete and its result.
+    template <typename Range, typename = std::enable_if_t<details::is_awaitable_range<Range>::value>>
+    [[nodiscard]] auto when_any(std::stop_source stopSource, Range awaitables)
+    {
+        using Awaitable = std::remove_reference_t<decltype(*std::begin(awaitables))>;
+        using Result = when_any_result<awaitable_resume_t<Awaitable>>;
+
+        if (std::begin(awaitables) == std::end(awaitables))
+        {
+            throw std::invalid_argument{ "when_any requires at least one awaitable." };
+        }
+
+        std::shared_ptr<details::when_any_state<Result>> state{ std::make_shared<details::when_any_state<Result>>(
+            std::move(stopSource)) };
+        std::vector<details::when_any_child> children{};
+        std::size_t index{};
+
+        for (Awaitable& awaitable : awaitables)
+        {
+            children.push_back(details::make_when_any_child(state, std::move(awaitable), index++));
+        }
+
+        return details::when_any_awaitable<Result>{ std::move(state), std::move(children) };
+    }
+
+    // Like when_any(stopSource, range), for awaitables that do not need to be told to stop.
+    template <typename Range, typename = std::enable_if_t<details::is_awaitable_range<Range>::value>>
+    [[nodiscard]] auto when_any(Range awaitables)
+    {
+        return when_any(std::stop_source{ std::nostopstate }, std::move(awaitables));
+    }
+}
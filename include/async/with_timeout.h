@@ -0,0 +1,74 @@
+// © Microsoft Corporation. All rights reserved.
+
+#pragma once
+
+#include <chrono>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include "awaitable_resume_t.h"
+#include "task.h"
+#include "task_canceled.h"
+#include "timer_service.h"
+#include "when_any.h"
+
+namespace async
+{
+    // Awaits awaitable, but throws task_canceled if it has not completed by deadline. The deadline is tracked by
+    // timerService (one shared thread for every pending deadline) rather than by blocking a thread per timeout. When
+    // either side finishes, stop is requested on stopSource; create awaitable with stopSource.get_token() so that it
+    // can abort when the deadline passes (otherwise it keeps running in the background until it completes, and its
+    // result is discarded).
+    template <typename Awaitable, typename Clock, typename Duration>
+    task<awaitable_resume_t<Awaitable>> with_deadline(std::stop_source stopSource, Awaitable awaitable,
+        std::chrono::time_point<Clock, Duration> deadline, timer_service& timerService = timer_service::shared())
+    {
+        static_assert(
+            std::is_same_v<Clock, std::chrono::steady_clock>, "Deadlines must use std::chrono::steady_clock.");
+
+        const std::stop_token stopToken{ stopSource.get_token() };
+        auto result = co_await when_any(std::move(stopSource), std::move(awaitable),
+            timerService.wait_until(
+                std::chrono::time_point_cast<std::chrono::steady_clock::duration>(deadline), stopToken));
+
+        if (result.index() != 0)
+        {
+            throw task_canceled{};
+        }
+
+        if constexpr (std::is_reference_v<awaitable_resume_t<Awaitable>>)
+        {
+            co_return std::get<0>(result).get();
+        }
+        else if constexpr (!std::is_void_v<awaitable_resume_t<Awaitable>>)
+        {
+            co_return std::get<0>(std::move(result));
+        }
+    }
+
+    // Like with_deadline(stopSource, awaitable, deadline), for an awaitable that cannot be told to stop.
+    template <typename Awaitable, typename Clock, typename Duration>
+    task<awaitable_resume_t<Awaitable>> with_deadline(Awaitable awaitable,
+        std::chrono::time_point<Clock, Duration> deadline, timer_service& timerService = timer_service::shared())
+    {
+        return with_deadline(std::stop_source{}, std::move(awaitable), deadline, timerService);
+    }
+
+    // Like with_deadline, for a deadline of timeout from now.
+    template <typename Awaitable, typename Rep, typename Period>
+    task<awaitable_resume_t<Awaitable>> with_timeout(std::stop_source stopSource, Awaitable awaitable,
+        std::chrono::duration<Rep, Period> timeout, timer_service& timerService = timer_service::shared())
+    {
+        return with_deadline(std::move(stopSource), std::move(awaitable),
+            std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout),
+            timerService);
+    }
+
+    template <typename Awaitable, typename Rep, typename Period>
+    task<awaitable_resume_t<Awaitable>> with_timeout(Awaitable awaitable, std::chrono::duration<Rep, Period> timeout,
+        timer_service& timerService = timer_service::shared())
+    {
+        return with_timeout(std::stop_source{}, std::move(awaitable), timeout, timerService);
+    }
+}
@@ -0,0 +1,229 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <deque>
+#include <stdexcept>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/async_condition_variable.h"
+#include "async/async_mutex.h"
+#include "async/awaitable_get.h"
+#include "async/task.h"
+#include "simplejthread.h"
+
+namespace
+{
+    async::task<void> wait_once(async::async_mutex& mutex, async::async_condition_variable& condition, int& wakeups)
+    {
+        async::async_mutex_lock lock{ co_await mutex.scoped_lock_async() };
+        co_await condition.wait(lock);
+        ++wakeups;
+    }
+}
+
+TEST_CASE("async_condition_variable.wait() suspends until notified")
+{
+    // Arrange
+    async::async_mutex mutex{};
+    async::async_condition_variable condition{};
+    int wakeups{};
+
+    // Act
+    async::task<void> task{ wait_once(mutex, condition, wakeups) };
+
+    // Assert
+    REQUIRE(!task.await_ready());
+    REQUIRE(wakeups == 0);
+    condition.notify_one();
+}
+
+TEST_CASE("async_condition_variable.wait() releases the mutex while waiting")
+{
+    // Arrange
+    async::async_mutex mutex{};
+    async::async_condition_variable condition{};
+    int wakeups{};
+    async::task<void> task{ wait_once(mutex, condition, wakeups) };
+
+    // Act
+    bool locked{ mutex.try_lock() };
+
+    // Assert
+    REQUIRE(locked);
+    mutex.unlock();
+    condition.notify_one();
+}
+
+TEST_CASE("async_condition_variable.notify_one() resumes a waiter when the mutex is not locked")
+{
+    // Arrange
+    async::async_mutex mutex{};
+    async::async_condition_variable condition{};
+    int wakeups{};
+    async::task<void> task{ wait_once(mutex, condition, wakeups) };
+
+    // Act
+    condition.notify_one();
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE(wakeups == 1);
+}
+
+TEST_CASE("async_condition_variable.notify_one() resumes the waiter only once the notifier unlocks")
+{
+    // Arrange
+    async::async_mutex mutex{};
+    async::async_condition_variable condition{};
+    int wakeups{};
+    async::task<void> task{ wait_once(mutex, condition, wakeups) };
+    std::ignore = mutex.try_lock();
+
+    // Act
+    condition.notify_one();
+    int wakeupsBeforeUnlock{ wakeups };
+    mutex.unlock();
+
+    // Assert
+    REQUIRE(wakeupsBeforeUnlock == 0);
+    REQUIRE(wakeups == 1);
+}
+
+TEST_CASE("async_condition_variable.notify_one() resumes only one waiter")
+{
+    // Arrange
+    async::async_mutex mutex{};
+    async::async_condition_variable condition{};
+    int wakeups{};
+    async::task<void> first{ wait_once(mutex, condition, wakeups) };
+    async::task<void> second{ wait_once(mutex, condition, wakeups) };
+
+    // Act
+    condition.notify_one();
+
+    // Assert
+    REQUIRE(wakeups == 1);
+    condition.notify_one();
+}
+
+TEST_CASE("async_condition_variable.notify_all() resumes all waiters")
+{
+    // Arrange
+    async::async_mutex mutex{};
+    async::async_condition_variable condition{};
+    int wakeups{};
+    async::task<void> first{ wait_once(mutex, condition, wakeups) };
+    async::task<void> second{ wait_once(mutex, condition, wakeups) };
+    async::task<void> third{ wait_once(mutex, condition, wakeups) };
+
+    // Act
+    condition.notify_all();
+
+    // Assert
+    REQUIRE(wakeups == 3);
+}
+
+TEST_CASE("async_condition_variable.wait() throws when the lock does not own its mutex")
+{
+    // Arrange
+    async::async_mutex mutex{};
+    async::async_condition_variable condition{};
+    std::ignore = mutex.try_lock();
+    async::async_mutex_lock lock{ mutex, std::adopt_lock };
+    lock.unlock();
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(condition.wait(lock), std::runtime_error,
+        Catch::Matchers::Message("async_condition_variable.wait() requires a lock that owns its mutex."));
+}
+
+namespace
+{
+    async::task<void> wait_until_ready(
+        async::async_mutex& mutex, async::async_condition_variable& condition, const bool& ready, int& wakeups)
+    {
+        async::async_mutex_lock lock{ co_await mutex.scoped_lock_async() };
+        co_await condition.wait(lock, [&ready]() { return ready; });
+        ++wakeups;
+    }
+}
+
+TEST_CASE("async_condition_variable.wait(predicate) does not suspend when predicate is true")
+{
+    // Arrange
+    async::async_mutex mutex{};
+    async::async_condition_variable condition{};
+    bool ready{ true };
+    int wakeups{};
+
+    // Act
+    async::task<void> task{ wait_until_ready(mutex, condition, ready, wakeups) };
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE(wakeups == 1);
+}
+
+TEST_CASE("async_condition_variable.wait(predicate) keeps waiting while predicate is false")
+{
+    // Arrange
+    async::async_mutex mutex{};
+    async::async_condition_variable condition{};
+    bool ready{ false };
+    int wakeups{};
+    async::task<void> task{ wait_until_ready(mutex, condition, ready, wakeups) };
+
+    // Act
+    condition.notify_all();
+    int wakeupsBeforeReady{ wakeups };
+    ready = true;
+    condition.notify_all();
+
+    // Assert
+    REQUIRE(wakeupsBeforeReady == 0);
+    REQUIRE(wakeups == 1);
+}
+
+namespace
+{
+    async::task<void> produce(async::async_mutex& mutex, async::async_condition_variable& condition,
+        std::deque<int>& queue, int count)
+    {
+        for (int i = 0; i != count; ++i)
+        {
+            async::async_mutex_lock lock{ co_await mutex.scoped_lock_async() };
+            queue.push_back(i);
+            condition.notify_one();
+        }
+    }
+
+    async::task<void> consume(async::async_mutex& mutex, async::async_condition_variable& condition,
+        std::deque<int>& queue, int count, long long& sum)
+    {
+        for (int i = 0; i != count; ++i)
+        {
+            async::async_mutex_lock lock{ co_await mutex.scoped_lock_async() };
+            co_await condition.wait(lock, [&queue]() { return !queue.empty(); });
+            sum += queue.front();
+            queue.pop_front();
+        }
+    }
+}
+
+TEST_CASE("async_condition_variable coordinates a producer and consumer on different threads")
+{
+    // Arrange
+    constexpr int count{ 10000 };
+    async::async_mutex mutex{};
+    async::async_condition_variable condition{};
+    std::deque<int> queue{};
+    long long sum{};
+
+    // Act
+    {
+        simplejthread consumer{ [&]() { async::awaitable_get(consume(mutex, condition, queue, count, sum)); } };
+        simplejthread producer{ [&]() { async::awaitable_get(produce(mutex, condition, queue, count)); } };
+    }
+
+    // Assert
+    REQUIRE(sum == static_cast<long long>(count) * (count - 1) / 2);
+}
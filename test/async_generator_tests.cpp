@@ -0,0 +1,210 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/async_generator.h"
+#include "async/awaitable_get.h"
+#include "async/task.h"
+#include "async/task_completion_source.h"
+
+namespace
+{
+    async::async_generator<int> count_to(int count, bool& started)
+    {
+        started = true;
+
+        for (int value = 1; value <= count; ++value)
+        {
+            co_yield value;
+        }
+    }
+
+    async::async_generator<int> yield_after(async::task<int> awaitable)
+    {
+        co_yield co_await std::move(awaitable);
+    }
+
+    async::async_generator<int> yield_then_throw()
+    {
+        co_yield 1;
+        throw std::runtime_error{ "generator failed" };
+    }
+
+    async::async_generator<std::string> yield_elements(const std::vector<std::string>& values)
+    {
+        for (const std::string& value : values)
+        {
+            co_yield value;
+        }
+    }
+
+    async::async_generator<const std::string> yield_const_elements(const std::vector<std::string>& values)
+    {
+        for (const std::string& value : values)
+        {
+            co_yield value;
+        }
+    }
+
+    async::async_generator<std::unique_ptr<int>> yield_move_only()
+    {
+        co_yield std::make_unique<int>(5);
+    }
+
+    async::async_generator<int> yield_forever(std::shared_ptr<int> resource)
+    {
+        while (true)
+        {
+            co_yield *resource;
+        }
+    }
+
+    template <typename T>
+    async::task<std::vector<T>> collect(const async::async_generator<T>& generator)
+    {
+        std::vector<T> values{};
+
+        while (T* value{ co_await generator.next() })
+        {
+            values.push_back(*value);
+        }
+
+        co_return values;
+    }
+
+    template <typename T>
+    async::task<T*> next_pointer(const async::async_generator<T>& generator)
+    {
+        co_return co_await generator.next();
+    }
+}
+
+TEST_CASE("async_generator does not start until next() is awaited")
+{
+    // Arrange
+    bool started{ false };
+
+    // Act
+    async::async_generator<int> generator{ count_to(3, started) };
+
+    // Assert
+    REQUIRE(!started);
+}
+
+TEST_CASE("async_generator.next() returns yielded values in order and then nullptr")
+{
+    // Arrange
+    bool started{ false };
+    async::async_generator<int> generator{ count_to(3, started) };
+
+    // Act
+    std::vector<int> values{ async::awaitable_get(collect(generator)) };
+
+    // Assert
+    REQUIRE(values == std::vector<int>{ 1, 2, 3 });
+    REQUIRE(async::awaitable_get(next_pointer(generator)) == nullptr);
+}
+
+TEST_CASE("async_generator.next() returns nullptr for an empty generator")
+{
+    // Arrange
+    bool started{ false };
+    async::async_generator<int> generator{ count_to(0, started) };
+
+    // Act
+    int* value{ async::awaitable_get(next_pointer(generator)) };
+
+    // Assert
+    REQUIRE(started);
+    REQUIRE(value == nullptr);
+}
+
+TEST_CASE("async_generator.next() waits for awaitables in the generator")
+{
+    // Arrange
+    async::task_completion_source<int> promise{};
+    async::async_generator<int> generator{ yield_after(promise.task()) };
+    async::task<int*> next{ next_pointer(generator) };
+    bool readyEarly{ next.await_ready() };
+
+    // Act
+    promise.set_value(42);
+
+    // Assert
+    REQUIRE(!readyEarly);
+    REQUIRE(next.await_ready());
+    REQUIRE(*next.await_resume() == 42);
+}
+
+TEST_CASE("async_generator.next() rethrows an exception thrown by the generator")
+{
+    // Arrange
+    async::async_generator<int> generator{ yield_then_throw() };
+    std::ignore = async::awaitable_get(next_pointer(generator));
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(async::awaitable_get(next_pointer(generator)), std::runtime_error,
+        Catch::Matchers::Message("generator failed"));
+    REQUIRE(async::awaitable_get(next_pointer(generator)) == nullptr);
+}
+
+TEST_CASE("async_generator copies const lvalues when the value type is not const")
+{
+    // Arrange
+    const std::vector<std::string> values{ "a", "b" };
+    async::async_generator<std::string> generator{ yield_elements(values) };
+
+    // Act
+    std::string* first{ async::awaitable_get(next_pointer(generator)) };
+
+    // Assert
+    REQUIRE(*first == "a");
+    REQUIRE(first != &values[0]);
+}
+
+TEST_CASE("async_generator yields references without copying when the value type is const")
+{
+    // Arrange
+    const std::vector<std::string> values{ "a", "b" };
+    async::async_generator<const std::string> generator{ yield_const_elements(values) };
+
+    // Act
+    const std::string* first{ async::awaitable_get(next_pointer(generator)) };
+    const std::string* second{ async::awaitable_get(next_pointer(generator)) };
+
+    // Assert
+    REQUIRE(first == &values[0]);
+    REQUIRE(second == &values[1]);
+}
+
+TEST_CASE("async_generator supports moving out move-only values")
+{
+    // Arrange
+    async::async_generator<std::unique_ptr<int>> generator{ yield_move_only() };
+
+    // Act
+    std::unique_ptr<int> value{ std::move(*async::awaitable_get(next_pointer(generator))) };
+
+    // Assert
+    REQUIRE(*value == 5);
+}
+
+TEST_CASE("async_generator destroys a suspended generator's frame")
+{
+    // Arrange
+    std::shared_ptr<int> resource{ std::make_shared<int>(1) };
+
+    // Act
+    {
+        async::async_generator<int> generator{ yield_forever(resource) };
+        std::ignore = async::awaitable_get(next_pointer(generator));
+    }
+
+    // Assert
+    REQUIRE(resource.use_count() == 1);
+}
@@ -0,0 +1,184 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/async_lazy.h"
+#include "async/atomic_acq_rel.h"
+#include "async/awaitable_get.h"
+#include "async/task.h"
+#include "async/task_completion_source.h"
+#include "simplejthread.h"
+
+namespace
+{
+    async::task<int> return_value_async(int value, int& calls)
+    {
+        ++calls;
+        co_return value;
+    }
+
+    template <typename T>
+    async::task<const T&> co_await_lazy(async::async_lazy<T>& lazy)
+    {
+        co_return co_await lazy;
+    }
+}
+
+TEST_CASE("async_lazy<T> does not run the factory before it is awaited")
+{
+    // Arrange
+    int calls{};
+
+    // Act
+    async::async_lazy<int> lazy{ [&calls]() { return return_value_async(123, calls); } };
+
+    // Assert
+    REQUIRE(calls == 0);
+    REQUIRE(!lazy.is_ready());
+}
+
+TEST_CASE("async_lazy<T> co_await returns the factory result")
+{
+    // Arrange
+    int calls{};
+    async::async_lazy<int> lazy{ [&calls]() { return return_value_async(123, calls); } };
+
+    // Act
+    int result{ async::awaitable_get(co_await_lazy(lazy)) };
+
+    // Assert
+    REQUIRE(result == 123);
+    REQUIRE(lazy.is_ready());
+}
+
+TEST_CASE("async_lazy<T> runs the factory only once")
+{
+    // Arrange
+    int calls{};
+    async::async_lazy<int> lazy{ [&calls]() { return return_value_async(123, calls); } };
+
+    // Act
+    std::ignore = async::awaitable_get(co_await_lazy(lazy));
+    std::ignore = async::awaitable_get(co_await_lazy(lazy));
+
+    // Assert
+    REQUIRE(calls == 1);
+}
+
+namespace
+{
+    async::task<void> await_and_record(async::async_lazy<std::string>& lazy, std::vector<const std::string*>& results)
+    {
+        const std::string& result{ co_await lazy };
+        results.push_back(&result);
+    }
+}
+
+TEST_CASE("async_lazy<T> resumes all awaiters that arrive while the factory is running")
+{
+    // Arrange
+    async::task_completion_source<std::string> promise{};
+    int calls{};
+    async::async_lazy<std::string> lazy{ [&promise, &calls]()
+        {
+            ++calls;
+            return promise.task();
+        } };
+    std::vector<const std::string*> results{};
+    async::task<void> first{ await_and_record(lazy, results) };
+    async::task<void> second{ await_and_record(lazy, results) };
+    async::task<void> third{ await_and_record(lazy, results) };
+
+    // Act
+    bool resumedEarly{ !results.empty() };
+    promise.set_value("value");
+
+    // Assert
+    REQUIRE(!resumedEarly);
+    REQUIRE(calls == 1);
+    REQUIRE(results.size() == 3);
+    REQUIRE(*results[0] == "value");
+    REQUIRE(results[0] == results[1]);
+    REQUIRE(results[1] == results[2]);
+}
+
+TEST_CASE("async_lazy<T> co_await does not suspend once ready")
+{
+    // Arrange
+    int calls{};
+    async::async_lazy<int> lazy{ [&calls]() { return return_value_async(123, calls); } };
+    std::ignore = async::awaitable_get(co_await_lazy(lazy));
+
+    // Act
+    bool ready{ lazy.operator co_await().await_ready() };
+
+    // Assert
+    REQUIRE(ready);
+}
+
+namespace
+{
+    async::task<int> throw_async()
+    {
+        throw std::runtime_error{ "expected" };
+        co_return 0;
+    }
+}
+
+TEST_CASE("async_lazy<T> co_await throws every time when the factory throws")
+{
+    // Arrange
+    async::async_lazy<int> lazy{ []() { return throw_async(); } };
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(
+        async::awaitable_get(co_await_lazy(lazy)), std::runtime_error, Catch::Matchers::Message("expected"));
+    REQUIRE_THROWS_MATCHES(
+        async::awaitable_get(co_await_lazy(lazy)), std::runtime_error, Catch::Matchers::Message("expected"));
+}
+
+TEST_CASE("async_lazy<T> supports move-only types")
+{
+    // Arrange
+    async::async_lazy<std::unique_ptr<int>> lazy{ []() -> async::task<std::unique_ptr<int>>
+        { co_return std::make_unique<int>(123); } };
+
+    // Act
+    const std::unique_ptr<int>& result{ async::awaitable_get(co_await_lazy(lazy)) };
+
+    // Assert
+    REQUIRE(*result == 123);
+}
+
+TEST_CASE("async_lazy<T> runs the factory once when awaited concurrently from many threads")
+{
+    // Arrange
+    constexpr int threadCount{ 8 };
+    async::task_completion_source<int> promise{};
+    async::details::atomic_acq_rel<int> calls{ 0 };
+    async::async_lazy<int> lazy{ [&promise, &calls]()
+        {
+            calls.exchange(calls.load() + 1);
+            return promise.task();
+        } };
+    std::vector<int> results(threadCount);
+
+    // Act
+    {
+        std::vector<simplejthread> threads{};
+
+        for (int i = 0; i != threadCount; ++i)
+        {
+            threads.emplace_back([&lazy, &results, i]() { results[i] = async::awaitable_get(co_await_lazy(lazy)); });
+        }
+
+        promise.set_value(123);
+    }
+
+    // Assert
+    REQUIRE(calls.load() == 1);
+    REQUIRE(results == std::vector<int>(threadCount, 123));
+}
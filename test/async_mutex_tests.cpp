@@ -0,0 +1,194 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/async_mutex.h"
+#include "async/awaitable_get.h"
+#include "async/task.h"
+#include "simplejthread.h"
+
+TEST_CASE("async_mutex.try_lock() returns true when not locked")
+{
+    // Arrange
+    async::async_mutex mutex{};
+
+    // Act
+    bool locked{ mutex.try_lock() };
+
+    // Assert
+    REQUIRE(locked);
+    mutex.unlock();
+}
+
+TEST_CASE("async_mutex.try_lock() returns false when locked")
+{
+    // Arrange
+    async::async_mutex mutex{};
+    std::ignore = mutex.try_lock();
+
+    // Act
+    bool locked{ mutex.try_lock() };
+
+    // Assert
+    REQUIRE(!locked);
+    mutex.unlock();
+}
+
+TEST_CASE("async_mutex.unlock() throws when not locked")
+{
+    // Arrange
+    async::async_mutex mutex{};
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(mutex.unlock(), std::runtime_error,
+        Catch::Matchers::Message("async_mutex.unlock() may be called only when the mutex is locked."));
+}
+
+namespace
+{
+    async::task<void> lock_and_record(async::async_mutex& mutex, std::vector<int>& order, int id)
+    {
+        co_await mutex.lock_async();
+        order.push_back(id);
+        mutex.unlock();
+    }
+}
+
+TEST_CASE("async_mutex.lock_async() does not suspend when not locked")
+{
+    // Arrange
+    async::async_mutex mutex{};
+    std::vector<int> order{};
+
+    // Act
+    async::task<void> task{ lock_and_record(mutex, order, 1) };
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE(order == std::vector<int>{ 1 });
+}
+
+TEST_CASE("async_mutex.lock_async() suspends when locked")
+{
+    // Arrange
+    async::async_mutex mutex{};
+    std::ignore = mutex.try_lock();
+    std::vector<int> order{};
+
+    // Act
+    async::task<void> task{ lock_and_record(mutex, order, 1) };
+
+    // Assert
+    REQUIRE(!task.await_ready());
+    REQUIRE(order.empty());
+    mutex.unlock();
+}
+
+TEST_CASE("async_mutex.unlock() resumes a waiter that owns the mutex")
+{
+    // Arrange
+    async::async_mutex mutex{};
+    std::ignore = mutex.try_lock();
+    std::vector<int> order{};
+    async::task<void> task{ lock_and_record(mutex, order, 1) };
+
+    // Act
+    mutex.unlock();
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE(order == std::vector<int>{ 1 });
+    REQUIRE(mutex.try_lock());
+    mutex.unlock();
+}
+
+TEST_CASE("async_mutex waiters acquire the mutex in FIFO order")
+{
+    // Arrange
+    async::async_mutex mutex{};
+    std::ignore = mutex.try_lock();
+    std::vector<int> order{};
+    async::task<void> first{ lock_and_record(mutex, order, 1) };
+    async::task<void> second{ lock_and_record(mutex, order, 2) };
+    async::task<void> third{ lock_and_record(mutex, order, 3) };
+
+    // Act
+    mutex.unlock();
+
+    // Assert
+    REQUIRE(order == std::vector<int>{ 1, 2, 3 });
+}
+
+namespace
+{
+    async::task<void> scoped_lock_and_record(async::async_mutex& mutex, std::vector<int>& order, int id)
+    {
+        async::async_mutex_lock lock{ co_await mutex.scoped_lock_async() };
+        order.push_back(id);
+    }
+}
+
+TEST_CASE("async_mutex.scoped_lock_async() unlocks when the lock is destroyed")
+{
+    // Arrange
+    async::async_mutex mutex{};
+    std::vector<int> order{};
+
+    // Act
+    async::task<void> task{ scoped_lock_and_record(mutex, order, 1) };
+
+    // Assert
+    REQUIRE(order == std::vector<int>{ 1 });
+    REQUIRE(mutex.try_lock());
+    mutex.unlock();
+}
+
+TEST_CASE("async_mutex_lock.unlock() throws when the lock is not owned")
+{
+    // Arrange
+    async::async_mutex mutex{};
+    std::ignore = mutex.try_lock();
+    async::async_mutex_lock lock{ mutex, std::adopt_lock };
+    lock.unlock();
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(lock.unlock(), std::runtime_error,
+        Catch::Matchers::Message("async_mutex_lock.unlock() may be called only when the lock is owned."));
+}
+
+namespace
+{
+    async::task<void> increment_under_lock(async::async_mutex& mutex, int& counter, int iterations)
+    {
+        for (int i = 0; i != iterations; ++i)
+        {
+            async::async_mutex_lock lock{ co_await mutex.scoped_lock_async() };
+            ++counter;
+        }
+    }
+}
+
+TEST_CASE("async_mutex provides mutual exclusion across threads")
+{
+    // Arrange
+    constexpr int threadCount{ 4 };
+    constexpr int iterations{ 10000 };
+    async::async_mutex mutex{};
+    int counter{};
+
+    // Act
+    {
+        std::vector<simplejthread> threads{};
+
+        for (int i = 0; i != threadCount; ++i)
+        {
+            threads.emplace_back([&mutex, &counter]()
+                { async::awaitable_get(increment_under_lock(mutex, counter, iterations)); });
+        }
+    }
+
+    // Assert
+    REQUIRE(counter == threadCount * iterations);
+}
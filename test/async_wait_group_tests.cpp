@@ -0,0 +1,178 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <stdexcept>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/async_wait_group.h"
+#include "async/atomic_acq_rel.h"
+#include "async/task.h"
+#include "async/task_completion_source.h"
+#include "simplejthread.h"
+
+namespace
+{
+    async::task<void> wait_and_count(async::async_wait_group& group, int& resumed)
+    {
+        co_await group.wait_async();
+        ++resumed;
+    }
+}
+
+TEST_CASE("async_wait_group.wait_async() does not suspend when the count is zero")
+{
+    // Arrange
+    async::async_wait_group group{};
+    int resumed{};
+
+    // Act
+    async::task<void> task{ wait_and_count(group, resumed) };
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE(resumed == 1);
+}
+
+TEST_CASE("async_wait_group.wait_async() suspends while the count is not zero")
+{
+    // Arrange
+    async::async_wait_group group{};
+    group.add();
+    int resumed{};
+
+    // Act
+    async::task<void> task{ wait_and_count(group, resumed) };
+
+    // Assert
+    REQUIRE(!task.await_ready());
+    REQUIRE(resumed == 0);
+    group.done();
+}
+
+TEST_CASE("async_wait_group.done() resumes all waiters when the count reaches zero")
+{
+    // Arrange
+    async::async_wait_group group{};
+    group.add(2);
+    int resumed{};
+    async::task<void> first{ wait_and_count(group, resumed) };
+    async::task<void> second{ wait_and_count(group, resumed) };
+
+    // Act
+    group.done();
+    int resumedBeforeZero{ resumed };
+    group.done();
+
+    // Assert
+    REQUIRE(resumedBeforeZero == 0);
+    REQUIRE(resumed == 2);
+}
+
+TEST_CASE("async_wait_group.done() throws when called more times than add()")
+{
+    // Arrange
+    async::async_wait_group group{};
+    group.add();
+    group.done();
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(group.done(), std::runtime_error,
+        Catch::Matchers::Message("async_wait_group.done() may not be called more times than add()."));
+    REQUIRE(group.count() == 0);
+}
+
+TEST_CASE("async_wait_group.add() throws when the count is negative")
+{
+    // Arrange
+    async::async_wait_group group{};
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(
+        group.add(-1), std::invalid_argument, Catch::Matchers::Message("The count must not be negative."));
+}
+
+TEST_CASE("async_wait_group can be waited on again after new work is added")
+{
+    // Arrange
+    async::async_wait_group group{};
+    group.add();
+    group.done();
+    group.add();
+    int resumed{};
+    async::task<void> task{ wait_and_count(group, resumed) };
+
+    // Act
+    group.done();
+
+    // Assert
+    REQUIRE(resumed == 1);
+}
+
+namespace
+{
+    async::task<void> detached_work(async::async_wait_group& group, async::task<void> work)
+    {
+        co_await std::move(work);
+        group.done();
+    }
+}
+
+TEST_CASE("async_wait_group.wait() blocks until detached coroutines complete on other threads")
+{
+    // Arrange
+    constexpr int coroutineCount{ 1000 };
+    async::async_wait_group group{};
+    std::vector<async::task_completion_source<void>> promises(coroutineCount);
+
+    for (async::task_completion_source<void>& promise : promises)
+    {
+        group.add();
+        std::ignore = detached_work(group, promise.task());
+    }
+
+    simplejthread completer{ [&promises]()
+        {
+            for (async::task_completion_source<void>& promise : promises)
+            {
+                promise.set_value();
+            }
+        } };
+
+    // Act
+    group.wait();
+
+    // Assert
+    REQUIRE(group.count() == 0);
+}
+
+TEST_CASE("async_wait_group resumes concurrent waiters exactly once")
+{
+    // Arrange
+    constexpr int threadCount{ 8 };
+    constexpr int iterations{ 1000 };
+    async::details::atomic_acq_rel<int> resumed{ 0 };
+
+    // Act
+    for (int i = 0; i != iterations; ++i)
+    {
+        async::async_wait_group group{};
+        group.add();
+
+        {
+            std::vector<simplejthread> threads{};
+
+            for (int j = 0; j != threadCount; ++j)
+            {
+                threads.emplace_back([&group, &resumed]()
+                    {
+                        group.wait();
+                        resumed.fetch_add(1);
+                    });
+            }
+
+            group.done();
+        }
+    }
+
+    // Assert
+    REQUIRE(resumed.load() == threadCount * iterations);
+}
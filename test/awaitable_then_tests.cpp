@@ -5,10 +5,15 @@
 #include <coroutine>
 #include <memory>
 #include <stdexcept>
+#include <string>
 #include <string_view>
+#include <vector>
+#include "async/awaitable_get.h"
 #include "async/awaitable_then.h"
 #include "async/atomic_acq_rel.h"
 #include "async/event_signal.h"
+#include "async/task.h"
+#include "async/task_completion_source.h"
 #include "awaitable_reference_value.h"
 #include "awaitable_value.h"
 #include "awaitable_value_member_operator_co_await.h"
@@ -335,3 +340,142 @@ TEST_CASE("awaitable_then<T w/non-member operator co_await> awaitable result ret
     // Assert
     REQUIRE(expected == actual);
 }
+
+namespace
+{
+    // Records the handles it is given, so a test can resume them later.
+    struct deferred_executor final
+    {
+        void operator()(std::coroutine_handle<> handle) const { handles->push_back(handle); }
+
+        std::vector<std::coroutine_handle<>>* handles;
+    };
+
+    template <typename Chain>
+    async::task<int> co_await_chain(Chain chain)
+    {
+        co_return co_await std::move(chain);
+    }
+}
+
+TEST_CASE("awaitable_then with an executor runs the continuation when the executor resumes it")
+{
+    // Arrange
+    std::vector<std::coroutine_handle<>> handles{};
+    int actual{};
+    auto continuation = [&actual](async::awaitable_result<int> result) { actual = result(); };
+
+    // Act
+    async::awaitable_then(awaitable_value<int>{ 123 }, deferred_executor{ &handles }, continuation);
+
+    // Assert
+    REQUIRE(handles.size() == 1);
+    REQUIRE(actual == 0);
+    handles[0].resume();
+    REQUIRE(actual == 123);
+}
+
+TEST_CASE("then() passes each step the result of the previous step")
+{
+    // Arrange
+    auto chain = async::then(awaitable_value<int>{ 1 }, [](int value) { return value + 1; })
+                     .then([](int value) { return value * 10; })
+                     .then([](int value) { return std::to_string(value); });
+
+    // Act
+    std::string actual{ async::awaitable_get(std::move(chain)) };
+
+    // Assert
+    REQUIRE(actual == "20");
+}
+
+TEST_CASE("then() supports an awaitable with a member operator co_await")
+{
+    // Arrange
+    auto chain = async::then(awaitable_value_member_operator_co_await{ 1 }, [](int value) { return value + 1; });
+
+    // Act
+    int actual{ async::awaitable_get(std::move(chain)) };
+
+    // Assert
+    REQUIRE(actual == 2);
+}
+
+TEST_CASE("then() runs its steps when a suspended awaitable completes")
+{
+    // Arrange
+    async::task_completion_source<int> promise{};
+    auto chain = async::then(promise.task(), [](int value) { return value + 1; })
+                     .then([](int value) { return value * 10; });
+    async::task<int> task{ co_await_chain(std::move(chain)) };
+    REQUIRE(!task.await_ready());
+
+    // Act
+    promise.set_value(1);
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE(task.await_resume() == 20);
+}
+
+TEST_CASE("then() calls the next step with no arguments after a void step")
+{
+    // Arrange
+    int calls{};
+    auto chain = async::then(awaitable_void{}, [&calls]() { ++calls; }).then([&calls]() { return ++calls; });
+
+    // Act
+    int actual{ async::awaitable_get(std::move(chain)) };
+
+    // Assert
+    REQUIRE(actual == 2);
+}
+
+TEST_CASE("then() skips the remaining steps and rethrows if the awaitable throws")
+{
+    // Arrange
+    bool called{};
+    auto chain = async::then(awaitable_void_throws{ std::make_exception_ptr(std::runtime_error{ "expected" }) },
+        [&called]() { called = true; });
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(async::awaitable_get(std::move(chain)), std::runtime_error,
+        Catch::Matchers::Message("expected"));
+    REQUIRE(!called);
+}
+
+TEST_CASE("then() skips the remaining steps and rethrows if a step throws")
+{
+    // Arrange
+    bool called{};
+    auto chain = async::then(awaitable_value<int>{ 1 }, [](int) -> int { throw std::runtime_error{ "expected" }; })
+                     .then([&called](int value)
+                         {
+                             called = true;
+                             return value;
+                         });
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(async::awaitable_get(std::move(chain)), std::runtime_error,
+        Catch::Matchers::Message("expected"));
+    REQUIRE(!called);
+}
+
+TEST_CASE("then() with an executor runs the chain's steps when the executor resumes it")
+{
+    // Arrange
+    std::vector<std::coroutine_handle<>> handles{};
+    deferred_executor executor{ &handles };
+    auto chain = async::then(awaitable_value<int>{ 1 }, executor, [](int value) { return value + 1; })
+                     .then([](int value) { return value * 10; });
+
+    // Act
+    async::task<int> task{ co_await_chain(std::move(chain)) };
+
+    // Assert
+    REQUIRE(handles.size() == 1);
+    REQUIRE(!task.await_ready());
+    handles[0].resume();
+    REQUIRE(task.await_ready());
+    REQUIRE(task.await_resume() == 20);
+}
@@ -0,0 +1,178 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/atomic_acq_rel.h"
+#include "async/awaitable_get.h"
+#include "async/batcher.h"
+#include "async/task.h"
+#include "async/timer_service.h"
+#include "simplejthread.h"
+
+namespace
+{
+    async::task<std::string> submit(async::batcher<int, std::string>& batcher, int item)
+    {
+        co_return co_await batcher.submit(item);
+    }
+
+    async::task<std::vector<std::string>> to_strings(std::vector<int> items, std::vector<std::size_t>& batchSizes)
+    {
+        batchSizes.push_back(items.size());
+        std::vector<std::string> results{};
+
+        for (int item : items)
+        {
+            results.push_back(std::to_string(item));
+        }
+
+        co_return results;
+    }
+}
+
+TEST_CASE("batcher runs the batch function once the batch is full")
+{
+    // Arrange
+    async::timer_service timers{};
+    std::vector<std::size_t> batchSizes{};
+    async::batcher<int, std::string> batcher{ 3, std::chrono::hours{ 1 },
+        [&batchSizes](std::vector<int> items) { return to_strings(std::move(items), batchSizes); }, timers };
+    async::task<std::string> first{ submit(batcher, 1) };
+    async::task<std::string> second{ submit(batcher, 2) };
+
+    // Act
+    bool readyEarly{ first.await_ready() || second.await_ready() };
+    async::task<std::string> third{ submit(batcher, 3) };
+
+    // Assert
+    REQUIRE(!readyEarly);
+    REQUIRE(batchSizes == std::vector<std::size_t>{ 3 });
+    REQUIRE(first.await_ready());
+    REQUIRE(first.await_resume() == "1");
+    REQUIRE(second.await_resume() == "2");
+    REQUIRE(third.await_resume() == "3");
+    REQUIRE(timers.pending_count() == 0);
+}
+
+TEST_CASE("batcher runs the batch function when the maximum delay passes")
+{
+    // Arrange
+    async::timer_service timers{};
+    std::vector<std::size_t> batchSizes{};
+    async::batcher<int, std::string> batcher{ 100, std::chrono::milliseconds{ 10 },
+        [&batchSizes](std::vector<int> items) { return to_strings(std::move(items), batchSizes); }, timers };
+    async::task<std::string> first{ submit(batcher, 1) };
+    async::task<std::string> second{ submit(batcher, 2) };
+
+    // Act
+    std::string firstResult{ async::awaitable_get(std::move(first)) };
+    std::string secondResult{ async::awaitable_get(std::move(second)) };
+
+    // Assert
+    REQUIRE(firstResult == "1");
+    REQUIRE(secondResult == "2");
+    REQUIRE(batchSizes == std::vector<std::size_t>{ 2 });
+}
+
+TEST_CASE("batcher.flush() runs the batch function for the pending batch")
+{
+    // Arrange
+    async::timer_service timers{};
+    std::vector<std::size_t> batchSizes{};
+    async::batcher<int, std::string> batcher{ 100, std::chrono::hours{ 1 },
+        [&batchSizes](std::vector<int> items) { return to_strings(std::move(items), batchSizes); }, timers };
+    async::task<std::string> task{ submit(batcher, 7) };
+
+    // Act
+    batcher.flush();
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE(task.await_resume() == "7");
+    REQUIRE(timers.pending_count() == 0);
+}
+
+TEST_CASE("batcher rethrows the batch function's exception to every submitter")
+{
+    // Arrange
+    async::timer_service timers{};
+    async::batcher<int, std::string> batcher{ 2, std::chrono::hours{ 1 },
+        [](std::vector<int>) -> async::task<std::vector<std::string>> { throw std::runtime_error{ "backend" }; },
+        timers };
+    async::task<std::string> first{ submit(batcher, 1) };
+
+    // Act
+    async::task<std::string> second{ submit(batcher, 2) };
+
+    // Assert
+    REQUIRE_THROWS_MATCHES(first.await_resume(), std::runtime_error, Catch::Matchers::Message("backend"));
+    REQUIRE_THROWS_MATCHES(second.await_resume(), std::runtime_error, Catch::Matchers::Message("backend"));
+}
+
+TEST_CASE("batcher throws when the batch function returns the wrong number of results")
+{
+    // Arrange
+    async::timer_service timers{};
+    async::batcher<int, std::string> batcher{ 1, std::chrono::hours{ 1 },
+        [](std::vector<int>) -> async::task<std::vector<std::string>> { co_return std::vector<std::string>{}; },
+        timers };
+
+    // Act
+    async::task<std::string> task{ submit(batcher, 1) };
+
+    // Assert
+    REQUIRE_THROWS_MATCHES(task.await_resume(), std::runtime_error,
+        Catch::Matchers::Message("The batch function must return exactly one result per item."));
+}
+
+TEST_CASE("batcher constructor throws when the maximum batch size is zero")
+{
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES((async::batcher<int, int>{ 0, std::chrono::hours{ 1 },
+                               [](std::vector<int> items) -> async::task<std::vector<int>> { co_return items; } }),
+        std::invalid_argument, Catch::Matchers::Message("The maximum batch size must not be zero."));
+}
+
+namespace
+{
+    async::task<std::vector<int>> echo(std::vector<int> items) { co_return items; }
+
+    async::task<void> submit_range(async::batcher<int, int>& batcher, int first, int count,
+        async::details::atomic_acq_rel<int>& mismatches)
+    {
+        for (int item = first; item != first + count; ++item)
+        {
+            if (co_await batcher.submit(item) != item)
+            {
+                mismatches.fetch_add(1);
+            }
+        }
+    }
+}
+
+TEST_CASE("batcher returns each submitter its own result when submitting from other threads")
+{
+    // Arrange
+    constexpr int threadCount{ 4 };
+    constexpr int itemsPerThread{ 1000 };
+    async::timer_service timers{};
+    async::batcher<int, int> batcher{ 16, std::chrono::microseconds{ 100 }, echo, timers };
+    async::details::atomic_acq_rel<int> mismatches{ 0 };
+
+    // Act
+    {
+        std::vector<simplejthread> threads{};
+
+        for (int i = 0; i != threadCount; ++i)
+        {
+            threads.emplace_back([&batcher, &mismatches, i]()
+                { async::awaitable_get(submit_range(batcher, i * itemsPerThread, itemsPerThread, mismatches)); });
+        }
+    }
+
+    // Assert
+    REQUIRE(mismatches.load() == 0);
+}
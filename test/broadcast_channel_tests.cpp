@@ -0,0 +1,223 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/broadcast_channel.h"
+#include "async/task.h"
+#include "simplejthread.h"
+
+namespace
+{
+    async::task<std::optional<int>> receive_one(async::broadcast_subscriber<int>& subscriber)
+    {
+        co_return co_await subscriber.receive();
+    }
+
+    async::task<std::vector<int>> receive_until_closed(async::broadcast_subscriber<int>& subscriber)
+    {
+        std::vector<int> values{};
+
+        while (std::optional<int> value{ co_await subscriber.receive() })
+        {
+            values.push_back(*value);
+        }
+
+        co_return values;
+    }
+}
+
+TEST_CASE("broadcast_channel constructor throws if the capacity is not a power of two")
+{
+    // Arrange
+    constexpr std::size_t capacity{ 3 };
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(async::broadcast_channel<int>{ capacity }, std::invalid_argument,
+        Catch::Matchers::Message("The capacity must be a power of two."));
+}
+
+TEST_CASE("broadcast_channel sends every item to every subscriber")
+{
+    // Arrange
+    async::broadcast_channel<int> channel{ 4 };
+    async::broadcast_subscriber<int> first{ channel.subscribe() };
+    async::broadcast_subscriber<int> second{ channel.subscribe() };
+
+    // Act
+    channel.send(1);
+    channel.send(2);
+    channel.close();
+
+    // Assert
+    REQUIRE(async::awaitable_get(receive_until_closed(first)) == std::vector<int>{ 1, 2 });
+    REQUIRE(async::awaitable_get(receive_until_closed(second)) == std::vector<int>{ 1, 2 });
+}
+
+TEST_CASE("broadcast_subscriber receives only items sent after it subscribed")
+{
+    // Arrange
+    async::broadcast_channel<int> channel{ 4 };
+    channel.send(1);
+    async::broadcast_subscriber<int> subscriber{ channel.subscribe() };
+
+    // Act
+    channel.send(2);
+    channel.close();
+
+    // Assert
+    REQUIRE(async::awaitable_get(receive_until_closed(subscriber)) == std::vector<int>{ 2 });
+}
+
+TEST_CASE("broadcast_subscriber.receive() suspends until an item is sent")
+{
+    // Arrange
+    async::broadcast_channel<int> channel{ 4 };
+    async::broadcast_subscriber<int> first{ channel.subscribe() };
+    async::broadcast_subscriber<int> second{ channel.subscribe() };
+    async::task<std::optional<int>> firstReceiver{ receive_one(first) };
+    async::task<std::optional<int>> secondReceiver{ receive_one(second) };
+    bool resumedEarly{ firstReceiver.await_ready() || secondReceiver.await_ready() };
+
+    // Act
+    channel.send(7);
+
+    // Assert
+    REQUIRE(!resumedEarly);
+    REQUIRE(firstReceiver.await_ready());
+    REQUIRE(firstReceiver.await_resume() == 7);
+    REQUIRE(secondReceiver.await_ready());
+    REQUIRE(secondReceiver.await_resume() == 7);
+}
+
+TEST_CASE("broadcast_channel.send() overwrites the oldest item rather than waiting for a slow subscriber")
+{
+    // Arrange
+    async::broadcast_channel<int> channel{ 2 };
+    async::broadcast_subscriber<int> subscriber{ channel.subscribe() };
+
+    // Act
+    for (int value = 1; value <= 5; ++value)
+    {
+        channel.send(value);
+    }
+
+    channel.close();
+
+    // Assert
+    REQUIRE(async::awaitable_get(receive_until_closed(subscriber)) == std::vector<int>{ 4, 5 });
+}
+
+TEST_CASE("broadcast_subscriber.receive() throws broadcast_overflow when items were overwritten with report_overflow")
+{
+    // Arrange
+    async::broadcast_channel<int> channel{ 2, async::broadcast_lag_policy::report_overflow };
+    async::broadcast_subscriber<int> subscriber{ channel.subscribe() };
+
+    for (int value = 1; value <= 5; ++value)
+    {
+        channel.send(value);
+    }
+
+    // Act
+    std::uint64_t skipped{};
+
+    try
+    {
+        std::ignore = async::awaitable_get(receive_one(subscriber));
+    }
+    catch (const async::broadcast_overflow& exception)
+    {
+        skipped = exception.skipped();
+    }
+
+    // Assert
+    REQUIRE(skipped == 3);
+    REQUIRE(async::awaitable_get(receive_one(subscriber)) == 4);
+    REQUIRE(async::awaitable_get(receive_one(subscriber)) == 5);
+}
+
+TEST_CASE("broadcast_channel.close() resumes waiting subscribers with nullopt")
+{
+    // Arrange
+    async::broadcast_channel<int> channel{ 4 };
+    async::broadcast_subscriber<int> subscriber{ channel.subscribe() };
+    async::task<std::optional<int>> receiver{ receive_one(subscriber) };
+
+    // Act
+    channel.close();
+
+    // Assert
+    REQUIRE(receiver.await_ready());
+    REQUIRE(!receiver.await_resume().has_value());
+}
+
+TEST_CASE("broadcast_channel stores each item once regardless of the number of subscribers")
+{
+    // Arrange
+    std::shared_ptr<int> item{ std::make_shared<int>(1) };
+    async::broadcast_channel<std::shared_ptr<int>> channel{ 4 };
+    std::vector<async::broadcast_subscriber<std::shared_ptr<int>>> subscribers{};
+
+    for (int index = 0; index != 8; ++index)
+    {
+        subscribers.push_back(channel.subscribe());
+    }
+
+    // Act
+    channel.send(item);
+
+    // Assert
+    REQUIRE(item.use_count() == 2);
+}
+
+TEST_CASE("broadcast_channel delivers items in order to subscribers on other threads")
+{
+    // Arrange
+    constexpr int itemCount{ 100000 };
+    constexpr int subscriberCount{ 4 };
+    async::broadcast_channel<int> channel{ 64 };
+    std::vector<async::broadcast_subscriber<int>> subscribers{};
+    std::vector<std::vector<int>> received(subscriberCount);
+
+    for (int index = 0; index != subscriberCount; ++index)
+    {
+        subscribers.push_back(channel.subscribe());
+    }
+
+    // Act
+    {
+        std::vector<simplejthread> threads{};
+
+        for (int index = 0; index != subscriberCount; ++index)
+        {
+            threads.emplace_back([&subscribers, &received, index]()
+                { received[index] = async::awaitable_get(receive_until_closed(subscribers[index])); });
+        }
+
+        for (int value = 0; value != itemCount; ++value)
+        {
+            channel.send(value);
+        }
+
+        channel.close();
+    }
+
+    // Assert
+    for (const std::vector<int>& values : received)
+    {
+        REQUIRE(!values.empty());
+        REQUIRE(values.back() == itemCount - 1);
+
+        for (std::size_t index = 1; index != values.size(); ++index)
+        {
+            REQUIRE(values[index - 1] < values[index]);
+        }
+    }
+}
@@ -0,0 +1,198 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/buffer_channel.h"
+#include "async/task.h"
+#include "simplejthread.h"
+
+namespace
+{
+    async::task<async::buffer_slab> acquire_one(async::buffer_channel& channel)
+    {
+        co_return co_await channel.acquire();
+    }
+
+    async::task<std::optional<async::buffer_view>> receive_one(async::buffer_channel& channel)
+    {
+        co_return co_await channel.receive();
+    }
+
+    bool commit_byte(async::buffer_channel& channel, std::byte value)
+    {
+        async::buffer_slab slab{ async::awaitable_get(acquire_one(channel)) };
+        slab.data()[0] = value;
+        return channel.commit(std::move(slab), 1);
+    }
+}
+
+TEST_CASE("buffer_channel constructor throws if the slab size or count is zero")
+{
+    // Act & Assert
+    REQUIRE_THROWS_AS((async::buffer_channel{ 0, 4 }), std::invalid_argument);
+    REQUIRE_THROWS_AS((async::buffer_channel{ 64, 0 }), std::invalid_argument);
+}
+
+TEST_CASE("buffer_channel.receive() returns a view of the committed bytes in the slab the producer filled")
+{
+    // Arrange
+    async::buffer_channel channel{ 64, 2 };
+    async::buffer_slab slab{ async::awaitable_get(acquire_one(channel)) };
+    const std::byte* const filled{ slab.data().data() };
+    std::memcpy(slab.data().data(), "abc", 3);
+
+    // Act
+    const bool committed{ channel.commit(std::move(slab), 3) };
+    std::optional<async::buffer_view> view{ async::awaitable_get(receive_one(channel)) };
+
+    // Assert
+    REQUIRE(committed);
+    REQUIRE(view.has_value());
+    REQUIRE(view->data().data() == filled);
+    REQUIRE(view->size() == 3);
+    REQUIRE(std::memcmp(view->data().data(), "abc", 3) == 0);
+}
+
+TEST_CASE("buffer_channel.acquire() suspends until the last view of a slab is destroyed")
+{
+    // Arrange
+    async::buffer_channel channel{ 64, 1 };
+    REQUIRE(commit_byte(channel, std::byte{ 1 }));
+    std::optional<async::buffer_view> view{ async::awaitable_get(receive_one(channel)) };
+    std::optional<async::buffer_view> copy{ view };
+    async::task<async::buffer_slab> acquiring{ acquire_one(channel) };
+    bool acquiredEarly{ acquiring.await_ready() };
+
+    // Act
+    view.reset();
+    bool acquiredAfterFirstRelease{ acquiring.await_ready() };
+    copy.reset();
+
+    // Assert
+    REQUIRE(!acquiredEarly);
+    REQUIRE(!acquiredAfterFirstRelease);
+    REQUIRE(acquiring.await_ready());
+}
+
+TEST_CASE("buffer_channel returns a slab destroyed without being committed to the pool")
+{
+    // Arrange
+    async::buffer_channel channel{ 64, 1 };
+
+    // Act
+    {
+        async::buffer_slab slab{ async::awaitable_get(acquire_one(channel)) };
+    }
+
+    async::task<async::buffer_slab> acquiring{ acquire_one(channel) };
+
+    // Assert
+    REQUIRE(acquiring.await_ready());
+}
+
+TEST_CASE("buffer_channel reuses the same slabs in steady state")
+{
+    // Arrange
+    async::buffer_channel channel{ 64, 2 };
+    std::vector<const std::byte*> slabs{};
+
+    // Act
+    for (int index = 0; index != 8; ++index)
+    {
+        async::buffer_slab slab{ async::awaitable_get(acquire_one(channel)) };
+        slabs.push_back(slab.data().data());
+        REQUIRE(channel.commit(std::move(slab), 1));
+        REQUIRE(async::awaitable_get(receive_one(channel)).has_value());
+    }
+
+    // Assert
+    for (std::size_t index = 2; index != slabs.size(); ++index)
+    {
+        REQUIRE(slabs[index] == slabs[index - 2]);
+    }
+}
+
+TEST_CASE("buffer_channel.commit() throws if the size does not fit in the slab")
+{
+    // Arrange
+    async::buffer_channel channel{ 64, 1 };
+    async::buffer_slab slab{ async::awaitable_get(acquire_one(channel)) };
+
+    // Act & Assert
+    REQUIRE_THROWS_AS(channel.commit(std::move(slab), 65), std::invalid_argument);
+}
+
+TEST_CASE("buffer_channel.close() ends receiving after the committed slabs and makes commit() return false")
+{
+    // Arrange
+    async::buffer_channel channel{ 64, 2 };
+    REQUIRE(commit_byte(channel, std::byte{ 7 }));
+
+    // Act
+    channel.close();
+    const bool committedAfterClose{ commit_byte(channel, std::byte{ 8 }) };
+    std::optional<async::buffer_view> first{ async::awaitable_get(receive_one(channel)) };
+    std::optional<async::buffer_view> second{ async::awaitable_get(receive_one(channel)) };
+
+    // Assert
+    REQUIRE(!committedAfterClose);
+    REQUIRE(first.has_value());
+    REQUIRE(first->data()[0] == std::byte{ 7 });
+    REQUIRE(!second.has_value());
+}
+
+namespace
+{
+    async::task<void> produce(async::buffer_channel& channel, int count)
+    {
+        for (int value = 0; value != count; ++value)
+        {
+            async::buffer_slab slab{ co_await channel.acquire() };
+            std::memcpy(slab.data().data(), &value, sizeof(value));
+            channel.commit(std::move(slab), sizeof(value));
+        }
+    }
+
+    async::task<std::vector<int>> consume(async::buffer_channel& channel)
+    {
+        std::vector<int> values{};
+
+        while (std::optional<async::buffer_view> view{ co_await channel.receive() })
+        {
+            int value{};
+            std::memcpy(&value, view->data().data(), sizeof(value));
+            values.push_back(value);
+        }
+
+        co_return values;
+    }
+}
+
+TEST_CASE("buffer_channel delivers buffers in order across threads")
+{
+    // Arrange
+    constexpr int bufferCount{ 100000 };
+    async::buffer_channel channel{ 256, 4 };
+    std::vector<int> received{};
+
+    // Act
+    {
+        simplejthread consumer{ [&channel, &received]() { received = async::awaitable_get(consume(channel)); } };
+        async::awaitable_get(produce(channel, bufferCount));
+        channel.close();
+    }
+
+    // Assert
+    REQUIRE(received.size() == bufferCount);
+
+    for (int index = 0; index != bufferCount; ++index)
+    {
+        REQUIRE(received[index] == index);
+    }
+}
@@ -0,0 +1,146 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <stop_token>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/for_each_concurrent.h"
+#include "async/task.h"
+#include "async/task_completion_source.h"
+#include "simplejthread.h"
+
+namespace
+{
+    async::task<int> square_async(int value) { co_return value * value; }
+}
+
+TEST_CASE("transform_concurrent() returns results in the order of the range")
+{
+    // Arrange
+    std::vector<int> values(100);
+    std::iota(values.begin(), values.end(), 0);
+
+    // Act
+    std::vector<int> results{ async::awaitable_get(async::transform_concurrent(values, 8, square_async)) };
+
+    // Assert
+    REQUIRE(results.size() == values.size());
+
+    for (int value : values)
+    {
+        REQUIRE(results[value] == value * value);
+    }
+}
+
+TEST_CASE("transform_concurrent() returns an empty vector for an empty range")
+{
+    // Arrange
+    std::vector<int> values{};
+
+    // Act
+    std::vector<int> results{ async::awaitable_get(async::transform_concurrent(values, 8, square_async)) };
+
+    // Assert
+    REQUIRE(results.empty());
+}
+
+TEST_CASE("for_each_concurrent() keeps at most limit calls in flight")
+{
+    // Arrange
+    constexpr std::size_t limit{ 3 };
+    std::vector<async::task_completion_source<void>> promises(10);
+    int inFlight{};
+    int maxInFlight{};
+    auto fn{ [&inFlight, &maxInFlight](async::task_completion_source<void>& promise) -> async::task<void>
+        {
+            maxInFlight = std::max(maxInFlight, ++inFlight);
+            co_await promise.task();
+            --inFlight;
+        } };
+    async::task<void> task{ async::for_each_concurrent(promises, limit, fn) };
+
+    // Act
+    int inFlightAtStart{ inFlight };
+
+    for (async::task_completion_source<void>& promise : promises)
+    {
+        promise.set_value();
+    }
+
+    // Assert
+    REQUIRE(inFlightAtStart == static_cast<int>(limit));
+    REQUIRE(maxInFlight == static_cast<int>(limit));
+    REQUIRE(task.await_ready());
+    task.await_resume();
+}
+
+TEST_CASE("for_each_concurrent() throws when the limit is zero")
+{
+    // Arrange
+    std::vector<int> values{ 1 };
+
+    // Act
+    async::task<void> task{ async::for_each_concurrent(values, 0, square_async) };
+
+    // Assert
+    REQUIRE_THROWS_MATCHES(async::awaitable_get(std::move(task)), std::invalid_argument,
+        Catch::Matchers::Message("The limit must not be zero."));
+}
+
+TEST_CASE("for_each_concurrent() stops starting elements and rethrows the first exception")
+{
+    // Arrange
+    std::vector<async::task_completion_source<void>> promises(10);
+    int started{};
+    bool inFlightStopRequested{};
+    auto fn{ [&started, &inFlightStopRequested](
+                 async::task_completion_source<void>& promise, std::stop_token stopToken) -> async::task<void>
+        {
+            ++started;
+            co_await promise.task();
+            inFlightStopRequested = stopToken.stop_requested();
+        } };
+    async::task<void> task{ async::for_each_concurrent(promises, 2, fn) };
+
+    // Act
+    promises[0].set_exception(std::make_exception_ptr(std::runtime_error{ "first" }));
+    bool readyEarly{ task.await_ready() };
+    promises[1].set_value();
+
+    // Assert
+    REQUIRE(!readyEarly);
+    REQUIRE(started == 2);
+    REQUIRE(inFlightStopRequested);
+    REQUIRE(task.await_ready());
+    REQUIRE_THROWS_MATCHES(task.await_resume(), std::runtime_error, Catch::Matchers::Message("first"));
+}
+
+TEST_CASE("transform_concurrent() processes every element when calls complete on other threads")
+{
+    // Arrange
+    constexpr int count{ 1000 };
+    std::vector<async::task_completion_source<int>> promises(count);
+    auto fn{ [](async::task_completion_source<int>& promise) { return promise.task(); } };
+    async::task<std::vector<int>> task{ async::transform_concurrent(promises, 16, fn) };
+
+    // Act
+    {
+        simplejthread completer{ [&promises]()
+            {
+                for (int i = 0; i != count; ++i)
+                {
+                    promises[i].set_value(i);
+                }
+            } };
+    }
+
+    // Assert
+    REQUIRE(task.await_ready());
+    std::vector<int> results{ task.await_resume() };
+    std::vector<int> expected(count);
+    std::iota(expected.begin(), expected.end(), 0);
+    REQUIRE(results == expected);
+}
@@ -0,0 +1,368 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <cstddef>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/generator.h"
+
+namespace
+{
+    async::generator<int> count_to(int count, bool& started)
+    {
+        started = true;
+
+        for (int value = 1; value <= count; ++value)
+        {
+            co_yield value;
+        }
+    }
+
+    async::generator<int> count_between(int first, int last)
+    {
+        for (int value = first; value != last; ++value)
+        {
+            co_yield value;
+        }
+    }
+
+    async::generator<int> yield_then_throw()
+    {
+        co_yield 1;
+        throw std::runtime_error{ "generator failed" };
+    }
+
+    async::generator<std::string> yield_elements(const std::vector<std::string>& values)
+    {
+        for (const std::string& value : values)
+        {
+            co_yield value;
+        }
+    }
+
+    async::generator<const std::string> yield_const_elements(const std::vector<std::string>& values)
+    {
+        for (const std::string& value : values)
+        {
+            co_yield value;
+        }
+    }
+
+    async::generator<std::unique_ptr<int>> yield_move_only()
+    {
+        co_yield std::make_unique<int>(5);
+    }
+
+    async::generator<int> yield_forever(std::shared_ptr<int> resource)
+    {
+        while (true)
+        {
+            co_yield *resource;
+        }
+    }
+
+    async::generator<int> yield_nested()
+    {
+        co_yield 1;
+        co_yield async::elements_of(count_between(2, 4));
+        async::generator<int> empty{ count_between(0, 0) };
+        co_yield async::elements_of(empty);
+        co_yield 4;
+    }
+
+    // Yields 0 to count - 1 through a chain of count nested generators.
+    async::generator<int> yield_deeply_nested(int count)
+    {
+        if (count == 0)
+        {
+            co_return;
+        }
+
+        co_yield async::elements_of(yield_deeply_nested(count - 1));
+        co_yield count - 1;
+    }
+
+    async::generator<int> catch_nested_exception(std::string& message)
+    {
+        try
+        {
+            co_yield async::elements_of(yield_then_throw());
+        }
+        catch (const std::runtime_error& exception)
+        {
+            message = exception.what();
+        }
+
+        co_yield 2;
+    }
+
+    async::generator<int> rethrow_nested_exception()
+    {
+        co_yield async::elements_of(yield_then_throw());
+    }
+
+    template <typename T>
+    struct counting_allocator final
+    {
+        using value_type = T;
+
+        explicit counting_allocator(std::size_t& allocations) noexcept : m_allocations{ &allocations } {}
+
+        template <typename U>
+        counting_allocator(const counting_allocator<U>& other) noexcept : m_allocations{ other.m_allocations }
+        {
+        }
+
+        [[nodiscard]] T* allocate(std::size_t count)
+        {
+            ++*m_allocations;
+            return std::allocator<T>{}.allocate(count);
+        }
+
+        void deallocate(T* pointer, std::size_t count) noexcept
+        {
+            --*m_allocations;
+            std::allocator<T>{}.deallocate(pointer, count);
+        }
+
+        template <typename U>
+        [[nodiscard]] bool operator==(const counting_allocator<U>& other) const noexcept
+        {
+            return m_allocations == other.m_allocations;
+        }
+
+    private:
+        template <typename U>
+        friend struct counting_allocator;
+
+        std::size_t* m_allocations;
+    };
+
+    async::generator<int> count_with_allocator(std::allocator_arg_t, counting_allocator<std::byte>, int count)
+    {
+        for (int value = 0; value != count; ++value)
+        {
+            co_yield value;
+        }
+    }
+
+    template <typename T>
+    std::vector<std::remove_cv_t<T>> collect(async::generator<T>& generator)
+    {
+        std::vector<std::remove_cv_t<T>> values{};
+
+        for (T& value : generator)
+        {
+            values.push_back(value);
+        }
+
+        return values;
+    }
+}
+
+static_assert(std::ranges::input_range<async::generator<int>>);
+static_assert(std::ranges::view<async::generator<int>>);
+static_assert(std::same_as<std::ranges::range_reference_t<async::generator<const std::string>>, const std::string&>);
+
+TEST_CASE("generator does not start until begin() is called")
+{
+    // Arrange
+    bool started{ false };
+
+    // Act
+    async::generator<int> generator{ count_to(3, started) };
+
+    // Assert
+    REQUIRE(!started);
+}
+
+TEST_CASE("generator yields values in order")
+{
+    // Arrange
+    bool started{ false };
+    async::generator<int> generator{ count_to(3, started) };
+
+    // Act
+    std::vector<int> values{ collect(generator) };
+
+    // Assert
+    REQUIRE(values == std::vector<int>{ 1, 2, 3 });
+}
+
+TEST_CASE("generator begin() equals end() for an empty generator")
+{
+    // Arrange
+    bool started{ false };
+    async::generator<int> generator{ count_to(0, started) };
+
+    // Act
+    auto iterator{ generator.begin() };
+
+    // Assert
+    REQUIRE(started);
+    REQUIRE(iterator == generator.end());
+}
+
+TEST_CASE("generator works with range adaptors")
+{
+    // Arrange
+    bool started{ false };
+    auto doubled{ count_to(4, started) | std::views::transform([](int value) { return value * 2; }) };
+
+    // Act
+    std::vector<int> values{};
+
+    for (int value : doubled)
+    {
+        values.push_back(value);
+    }
+
+    // Assert
+    REQUIRE(values == std::vector<int>{ 2, 4, 6, 8 });
+}
+
+TEST_CASE("generator increment rethrows an exception thrown by the generator")
+{
+    // Arrange
+    async::generator<int> generator{ yield_then_throw() };
+    auto iterator{ generator.begin() };
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(++iterator, std::runtime_error, Catch::Matchers::Message("generator failed"));
+    REQUIRE(iterator == generator.end());
+}
+
+TEST_CASE("generator copies const lvalues when the value type is not const")
+{
+    // Arrange
+    const std::vector<std::string> values{ "a", "b" };
+    async::generator<std::string> generator{ yield_elements(values) };
+
+    // Act
+    std::string& first{ *generator.begin() };
+
+    // Assert
+    REQUIRE(first == "a");
+    REQUIRE(&first != &values[0]);
+}
+
+TEST_CASE("generator yields references without copying when the value type is const")
+{
+    // Arrange
+    const std::vector<std::string> values{ "a", "b" };
+    async::generator<const std::string> generator{ yield_const_elements(values) };
+    auto iterator{ generator.begin() };
+
+    // Act
+    const std::string* first{ &*iterator };
+    ++iterator;
+    const std::string* second{ &*iterator };
+
+    // Assert
+    REQUIRE(first == &values[0]);
+    REQUIRE(second == &values[1]);
+}
+
+TEST_CASE("generator supports moving out move-only values")
+{
+    // Arrange
+    async::generator<std::unique_ptr<int>> generator{ yield_move_only() };
+
+    // Act
+    std::unique_ptr<int> value{ std::move(*generator.begin()) };
+
+    // Assert
+    REQUIRE(*value == 5);
+}
+
+TEST_CASE("generator destroys a suspended generator's frame")
+{
+    // Arrange
+    std::shared_ptr<int> resource{ std::make_shared<int>(1) };
+
+    // Act
+    {
+        async::generator<int> generator{ yield_forever(resource) };
+        std::ignore = generator.begin();
+    }
+
+    // Assert
+    REQUIRE(resource.use_count() == 1);
+}
+
+TEST_CASE("generator yields the elements of nested generators")
+{
+    // Arrange
+    async::generator<int> generator{ yield_nested() };
+
+    // Act
+    std::vector<int> values{ collect(generator) };
+
+    // Assert
+    REQUIRE(values == std::vector<int>{ 1, 2, 3, 4 });
+}
+
+TEST_CASE("generator yields the elements of deeply nested generators")
+{
+    // Arrange
+    constexpr int depth{ 1000 };
+    async::generator<int> generator{ yield_deeply_nested(depth) };
+
+    // Act
+    std::vector<int> values{ collect(generator) };
+
+    // Assert
+    REQUIRE(values.size() == depth);
+    REQUIRE(values.front() == 0);
+    REQUIRE(values.back() == depth - 1);
+}
+
+TEST_CASE("generator rethrows an exception thrown by a nested generator in the enclosing generator")
+{
+    // Arrange
+    std::string message{};
+    async::generator<int> generator{ catch_nested_exception(message) };
+
+    // Act
+    std::vector<int> values{ collect(generator) };
+
+    // Assert
+    REQUIRE(values == std::vector<int>{ 1, 2 });
+    REQUIRE(message == "generator failed");
+}
+
+TEST_CASE("generator increment rethrows an exception not caught by any enclosing generator")
+{
+    // Arrange
+    async::generator<int> generator{ rethrow_nested_exception() };
+    auto iterator{ generator.begin() };
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(++iterator, std::runtime_error, Catch::Matchers::Message("generator failed"));
+    REQUIRE(iterator == generator.end());
+}
+
+TEST_CASE("generator allocates its frame with an allocator passed after std::allocator_arg")
+{
+    // Arrange
+    std::size_t allocations{};
+    std::vector<int> values{};
+
+    // Act
+    {
+        async::generator<int> generator{ count_with_allocator(
+            std::allocator_arg, counting_allocator<std::byte>{ allocations }, 3) };
+        REQUIRE(allocations == 1);
+        values = collect(generator);
+    }
+
+    // Assert
+    REQUIRE(values == std::vector<int>{ 0, 1, 2 });
+    REQUIRE(allocations == 0);
+}
@@ -0,0 +1,217 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <stop_token>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/hedge.h"
+#include "async/task.h"
+#include "async/task_completion_source.h"
+#include "async/timer_service.h"
+
+namespace
+{
+    // Creates one pending attempt per call; the test completes them through promises.
+    struct pending_attempts final
+    {
+        async::task<int> operator()(std::stop_token stopToken)
+        {
+            promises.push_back(std::make_unique<async::task_completion_source<int>>());
+            stopTokens.push_back(stopToken);
+            return promises.back()->task();
+        }
+
+        std::vector<std::unique_ptr<async::task_completion_source<int>>> promises{};
+        std::vector<std::stop_token> stopTokens{};
+    };
+
+    async::task<int> fail()
+    {
+        throw std::runtime_error{ "attempt failed" };
+        co_return 0;
+    }
+}
+
+TEST_CASE("hedge() returns the result of a first attempt that completes before the delay")
+{
+    // Arrange
+    async::timer_service timers{};
+    pending_attempts attempts{};
+    auto factory{ [&attempts](std::stop_token stopToken) { return attempts(stopToken); } };
+    async::task<int> task{ async::hedge(factory, std::chrono::hours{ 1 }, 3, timers) };
+
+    // Act
+    attempts.promises[0]->set_value(123);
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE(task.await_resume() == 123);
+    REQUIRE(attempts.promises.size() == 1);
+    REQUIRE(timers.pending_count() == 0);
+}
+
+TEST_CASE("hedge() starts another attempt after the delay and returns the first result")
+{
+    // Arrange
+    async::timer_service timers{};
+    pending_attempts attempts{};
+    auto factory{ [&attempts](std::stop_token stopToken) { return attempts(stopToken); } };
+    async::task<int> task{ async::hedge(factory, std::chrono::microseconds{ 0 }, 2, timers) };
+    REQUIRE(attempts.promises.size() == 2);
+
+    // Act
+    attempts.promises[1]->set_value(2);
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE(task.await_resume() == 2);
+    REQUIRE(attempts.stopTokens[0].stop_requested());
+    attempts.promises[0]->set_value(1);
+}
+
+TEST_CASE("hedge() starts another attempt on the timer thread when the delay elapses")
+{
+    // Arrange
+    async::timer_service timers{};
+    async::task_completion_source<int> slowAttempt{};
+    int calls{};
+    auto factory{ [&slowAttempt, &calls]() -> async::task<int>
+        {
+            if (++calls == 1)
+            {
+                return slowAttempt.task();
+            }
+
+            return []() -> async::task<int> { co_return 2; }();
+        } };
+
+    // Act
+    int result{ async::awaitable_get(async::hedge(factory, std::chrono::milliseconds{ 1 }, 2, timers)) };
+
+    // Assert
+    REQUIRE(result == 2);
+    REQUIRE(calls == 2);
+    slowAttempt.set_value(1);
+}
+
+TEST_CASE("hedge() does not start more than the maximum number of attempts")
+{
+    // Arrange
+    async::timer_service timers{};
+    pending_attempts attempts{};
+    auto factory{ [&attempts](std::stop_token stopToken) { return attempts(stopToken); } };
+
+    // Act
+    async::task<int> task{ async::hedge(factory, std::chrono::microseconds{ 0 }, 3, timers) };
+
+    // Assert
+    REQUIRE(attempts.promises.size() == 3);
+    REQUIRE(!task.await_ready());
+    attempts.promises[2]->set_value(3);
+    REQUIRE(task.await_resume() == 3);
+    attempts.promises[0]->set_value(1);
+    attempts.promises[1]->set_value(2);
+}
+
+TEST_CASE("hedge() ignores a failed attempt while another may still succeed")
+{
+    // Arrange
+    async::timer_service timers{};
+    pending_attempts attempts{};
+    auto factory{ [&attempts](std::stop_token stopToken) { return attempts(stopToken); } };
+    async::task<int> task{ async::hedge(factory, std::chrono::microseconds{ 0 }, 2, timers) };
+
+    // Act
+    attempts.promises[0]->set_exception(std::make_exception_ptr(std::runtime_error{ "first failed" }));
+    attempts.promises[1]->set_value(2);
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE(task.await_resume() == 2);
+}
+
+TEST_CASE("hedge() rethrows the first failure when every attempt fails")
+{
+    // Arrange
+    async::timer_service timers{};
+    std::size_t calls{};
+    auto factory{ [&calls]()
+        {
+            ++calls;
+            return fail();
+        } };
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(async::awaitable_get(async::hedge(factory, std::chrono::microseconds{ 0 }, 3, timers)),
+        std::runtime_error, Catch::Matchers::Message("attempt failed"));
+    REQUIRE(calls == 3);
+}
+
+TEST_CASE("hedge() throws if the maximum number of attempts is zero")
+{
+    // Arrange
+    async::timer_service timers{};
+    auto factory{ []() -> async::task<int> { co_return 1; } };
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(async::awaitable_get(async::hedge(factory, std::chrono::microseconds{ 0 }, 0, timers)),
+        std::invalid_argument, Catch::Matchers::Message("The maximum number of attempts must not be zero."));
+}
+
+TEST_CASE("hedge() records fired and won hedges in its statistics")
+{
+    // Arrange
+    async::timer_service timers{};
+    async::hedge_statistics statistics{ std::chrono::microseconds{ 0 } };
+    pending_attempts attempts{};
+    auto factory{ [&attempts](std::stop_token stopToken) { return attempts(stopToken); } };
+    async::task<int> task{ async::hedge(factory, statistics, 2, timers) };
+
+    // Act
+    attempts.promises[1]->set_value(2);
+
+    // Assert
+    REQUIRE(task.await_resume() == 2);
+    REQUIRE(statistics.requests() == 1);
+    REQUIRE(statistics.hedges_fired() == 1);
+    REQUIRE(statistics.hedges_won() == 1);
+    attempts.promises[0]->set_value(1);
+}
+
+TEST_CASE("hedge_statistics.delay() returns the initial delay until enough latencies are recorded")
+{
+    // Arrange
+    async::hedge_statistics statistics{ std::chrono::milliseconds{ 5 }, 0.95, 32 };
+
+    // Act
+    statistics.record(std::chrono::microseconds{ 1 }, 0, false);
+
+    // Assert
+    REQUIRE(statistics.delay() == std::chrono::milliseconds{ 5 });
+}
+
+TEST_CASE("hedge_statistics.delay() returns the percentile of recent latencies")
+{
+    // Arrange
+    async::hedge_statistics statistics{ std::chrono::milliseconds{ 5 }, 0.95, 20 };
+
+    // Act
+    for (int latency = 1; latency <= 40; ++latency)
+    {
+        statistics.record(std::chrono::microseconds{ latency }, 0, false);
+    }
+
+    // Assert
+    REQUIRE(statistics.delay() == std::chrono::microseconds{ 39 });
+}
+
+TEST_CASE("hedge_statistics throws if the percentile is out of range")
+{
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(async::hedge_statistics(std::chrono::microseconds{ 1 }, 0.0), std::invalid_argument,
+        Catch::Matchers::Message("The percentile must be greater than zero and at most one."));
+}
@@ -0,0 +1,249 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/mailbox.h"
+#include "async/task.h"
+#include "simplejthread.h"
+
+namespace
+{
+    struct message final : async::mailbox_node
+    {
+        explicit message(int id) noexcept : value{ id } {}
+
+        int value;
+    };
+
+    async::task<async::mailbox_batch<message>> receive_batch(async::mailbox<message>& mailbox)
+    {
+        co_return co_await mailbox.receive_batch();
+    }
+
+    std::vector<int> pop_values(async::mailbox_batch<message>& batch)
+    {
+        std::vector<int> values{};
+
+        while (message* popped{ batch.pop() })
+        {
+            values.push_back(popped->value);
+        }
+
+        return values;
+    }
+}
+
+TEST_CASE("mailbox.receive_batch() completes with every posted message in order without suspending")
+{
+    // Arrange
+    async::mailbox<message> mailbox{};
+    message first{ 1 };
+    message second{ 2 };
+    message third{ 3 };
+    mailbox.post(first);
+    mailbox.post(second);
+    mailbox.post(third);
+
+    // Act
+    async::task<async::mailbox_batch<message>> receiving{ receive_batch(mailbox) };
+
+    // Assert
+    REQUIRE(receiving.await_ready());
+    async::mailbox_batch<message> batch{ receiving.await_resume() };
+    REQUIRE(batch.size() == 3);
+    REQUIRE(pop_values(batch) == std::vector<int>{ 1, 2, 3 });
+    REQUIRE(batch.empty());
+}
+
+TEST_CASE("mailbox.receive_batch() suspends until a message is posted")
+{
+    // Arrange
+    async::mailbox<message> mailbox{};
+    message posted{ 7 };
+    async::task<async::mailbox_batch<message>> receiving{ receive_batch(mailbox) };
+    bool receivedEarly{ receiving.await_ready() };
+
+    // Act
+    mailbox.post(posted);
+
+    // Assert
+    REQUIRE(!receivedEarly);
+    REQUIRE(receiving.await_ready());
+    async::mailbox_batch<message> batch{ receiving.await_resume() };
+    REQUIRE(pop_values(batch) == std::vector<int>{ 7 });
+}
+
+TEST_CASE("mailbox.receive_batch() returns the messages posted after the previous batch")
+{
+    // Arrange
+    async::mailbox<message> mailbox{};
+    message first{ 1 };
+    message second{ 2 };
+    message third{ 3 };
+    mailbox.post(first);
+    async::mailbox_batch<message> firstBatch{ async::awaitable_get(receive_batch(mailbox)) };
+
+    // Act
+    mailbox.post(second);
+    mailbox.post(third);
+    async::mailbox_batch<message> secondBatch{ async::awaitable_get(receive_batch(mailbox)) };
+
+    // Assert
+    REQUIRE(pop_values(firstBatch) == std::vector<int>{ 1 });
+    REQUIRE(pop_values(secondBatch) == std::vector<int>{ 2, 3 });
+}
+
+TEST_CASE("mailbox accepts a message again after it is popped")
+{
+    // Arrange
+    async::mailbox<message> mailbox{};
+    message reused{ 4 };
+    mailbox.post(reused);
+    async::mailbox_batch<message> firstBatch{ async::awaitable_get(receive_batch(mailbox)) };
+    message* popped{ firstBatch.pop() };
+
+    // Act
+    mailbox.post(*popped);
+    async::task<async::mailbox_batch<message>> receiving{ receive_batch(mailbox) };
+
+    // Assert
+    REQUIRE(popped == &reused);
+    REQUIRE(receiving.await_ready());
+    async::mailbox_batch<message> secondBatch{ receiving.await_resume() };
+    REQUIRE(secondBatch.pop() == &reused);
+    REQUIRE(secondBatch.pop() == nullptr);
+}
+
+namespace
+{
+    async::task<std::int64_t> receive_all(async::mailbox<message>& mailbox, std::size_t count)
+    {
+        std::int64_t sum{};
+        std::size_t received{};
+
+        while (received != count)
+        {
+            async::mailbox_batch<message> batch{ co_await mailbox.receive_batch() };
+            received += batch.size();
+
+            while (message* popped{ batch.pop() })
+            {
+                sum += popped->value;
+            }
+        }
+
+        co_return sum;
+    }
+}
+
+TEST_CASE("mailbox delivers every message posted from several threads")
+{
+    // Arrange
+    constexpr int producerCount{ 4 };
+    constexpr int messageCount{ 50000 };
+    constexpr std::int64_t expectedSum{ std::int64_t{ producerCount } * messageCount * (messageCount + 1) / 2 };
+    async::mailbox<message> mailbox{};
+    std::vector<std::vector<message>> messages(producerCount);
+
+    for (std::vector<message>& producerMessages : messages)
+    {
+        producerMessages.reserve(messageCount);
+
+        for (int value = 1; value <= messageCount; ++value)
+        {
+            producerMessages.emplace_back(value);
+        }
+    }
+
+    std::int64_t sum{};
+
+    // Act
+    {
+        simplejthread consumer{ [&]()
+            { sum = async::awaitable_get(receive_all(mailbox, std::size_t{ producerCount } * messageCount)); } };
+        std::vector<simplejthread> producers{};
+
+        for (std::vector<message>& producerMessages : messages)
+        {
+            producers.emplace_back(
+                [&mailbox, &producerMessages]()
+                {
+                    for (message& posted : producerMessages)
+                    {
+                        mailbox.post(posted);
+                    }
+                });
+        }
+    }
+
+    // Assert
+    REQUIRE(sum == expectedSum);
+}
+
+TEST_CASE("mailbox delivers each producer's messages in the order it posted them")
+{
+    // Arrange
+    constexpr int messageCount{ 50000 };
+    async::mailbox<message> mailbox{};
+    std::vector<message> first{};
+    std::vector<message> second{};
+    first.reserve(messageCount);
+    second.reserve(messageCount);
+
+    for (int value = 0; value != messageCount; ++value)
+    {
+        first.emplace_back(value);
+        second.emplace_back(messageCount + value);
+    }
+
+    std::vector<int> received{};
+
+    // Act
+    {
+        simplejthread consumer{ [&]()
+            {
+                async::awaitable_get(
+                    [](async::mailbox<message>& mailbox, std::vector<int>& received) -> async::task<void>
+                    {
+                        while (received.size() != 2 * messageCount)
+                        {
+                            async::mailbox_batch<message> batch{ co_await mailbox.receive_batch() };
+
+                            while (message* popped{ batch.pop() })
+                            {
+                                received.push_back(popped->value);
+                            }
+                        }
+                    }(mailbox, received));
+            } };
+        simplejthread firstProducer{ [&]()
+            {
+                for (message& posted : first)
+                {
+                    mailbox.post(posted);
+                }
+            } };
+        simplejthread secondProducer{ [&]()
+            {
+                for (message& posted : second)
+                {
+                    mailbox.post(posted);
+                }
+            } };
+    }
+
+    // Assert
+    REQUIRE(received.size() == 2 * messageCount);
+    int nextFirst{ 0 };
+    int nextSecond{ messageCount };
+
+    for (int value : received)
+    {
+        int& next{ value < messageCount ? nextFirst : nextSecond };
+        REQUIRE(value == next);
+        ++next;
+    }
+}
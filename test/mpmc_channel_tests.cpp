@@ -0,0 +1,293 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/mpmc_channel.h"
+#include "async/task.h"
+#include "simplejthread.h"
+
+namespace
+{
+    async::task<bool> send_one(async::mpmc_channel<int>& channel, int value)
+    {
+        co_return co_await channel.send(value);
+    }
+
+    async::task<std::optional<int>> receive_one(async::mpmc_channel<int>& channel)
+    {
+        co_return co_await channel.receive();
+    }
+
+    async::task<std::size_t> receive_many(async::mpmc_channel<int>& channel, std::span<int> items)
+    {
+        co_return co_await channel.receive_many(items);
+    }
+
+    async::task<void> send_range(async::mpmc_channel<int>& channel, int first, int last)
+    {
+        for (int value = first; value != last; ++value)
+        {
+            co_await channel.send(value);
+        }
+    }
+
+    async::task<std::int64_t> sum_until_closed(async::mpmc_channel<int>& channel)
+    {
+        std::int64_t sum{};
+        std::array<int, 8> items{};
+
+        while (const std::size_t count{ co_await channel.receive_many(items) })
+        {
+            for (std::size_t index = 0; index != count; ++index)
+            {
+                sum += items[index];
+            }
+        }
+
+        co_return sum;
+    }
+}
+
+TEST_CASE("mpmc_channel constructor throws if the capacity is not a power of two greater than one")
+{
+    // Arrange
+    constexpr std::size_t capacity{ 1 };
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(async::mpmc_channel<int>{ capacity }, std::invalid_argument,
+        Catch::Matchers::Message("The capacity must be a power of two greater than one."));
+}
+
+TEST_CASE("mpmc_channel.receive() does not suspend when an item is available")
+{
+    // Arrange
+    async::mpmc_channel<int> channel{ 4 };
+    async::task<bool> sender{ send_one(channel, 1) };
+
+    // Act
+    async::task<std::optional<int>> receiver{ receive_one(channel) };
+
+    // Assert
+    REQUIRE(receiver.await_ready());
+    REQUIRE(receiver.await_resume() == 1);
+}
+
+TEST_CASE("mpmc_channel.receive() suspends until an item is sent")
+{
+    // Arrange
+    async::mpmc_channel<int> channel{ 4 };
+    async::task<std::optional<int>> receiver{ receive_one(channel) };
+    bool resumedEarly{ receiver.await_ready() };
+
+    // Act
+    async::task<bool> sender{ send_one(channel, 7) };
+
+    // Assert
+    REQUIRE(!resumedEarly);
+    REQUIRE(receiver.await_ready());
+    REQUIRE(receiver.await_resume() == 7);
+}
+
+TEST_CASE("mpmc_channel.receive() resumes waiting receivers in FIFO order")
+{
+    // Arrange
+    async::mpmc_channel<int> channel{ 4 };
+    async::task<std::optional<int>> first{ receive_one(channel) };
+    async::task<std::optional<int>> second{ receive_one(channel) };
+
+    // Act
+    async::task<void> sender{ send_range(channel, 1, 3) };
+
+    // Assert
+    REQUIRE(first.await_resume() == 1);
+    REQUIRE(second.await_resume() == 2);
+}
+
+TEST_CASE("mpmc_channel.send() suspends while the channel is full")
+{
+    // Arrange
+    async::mpmc_channel<int> channel{ 2 };
+    async::task<void> filler{ send_range(channel, 1, 3) };
+    async::task<bool> sender{ send_one(channel, 3) };
+    bool completedEarly{ sender.await_ready() };
+
+    // Act
+    async::task<std::optional<int>> receiver{ receive_one(channel) };
+
+    // Assert
+    REQUIRE(!completedEarly);
+    REQUIRE(sender.await_ready());
+    REQUIRE(sender.await_resume());
+    REQUIRE(receiver.await_resume() == 1);
+}
+
+TEST_CASE("mpmc_channel.close() resumes waiting senders, which return false")
+{
+    // Arrange
+    async::mpmc_channel<int> channel{ 2 };
+    async::task<void> filler{ send_range(channel, 1, 3) };
+    async::task<bool> sender{ send_one(channel, 3) };
+
+    // Act
+    channel.close();
+
+    // Assert
+    REQUIRE(sender.await_ready());
+    REQUIRE(!sender.await_resume());
+}
+
+TEST_CASE("mpmc_channel.close() resumes waiting receivers with nullopt")
+{
+    // Arrange
+    async::mpmc_channel<int> channel{ 4 };
+    async::task<std::optional<int>> receiver{ receive_one(channel) };
+
+    // Act
+    channel.close();
+
+    // Assert
+    REQUIRE(receiver.await_ready());
+    REQUIRE(!receiver.await_resume().has_value());
+}
+
+TEST_CASE("mpmc_channel.receive() returns remaining items after close()")
+{
+    // Arrange
+    async::mpmc_channel<int> channel{ 4 };
+    async::task<void> sender{ send_range(channel, 1, 3) };
+    channel.close();
+
+    // Act
+    async::task<std::optional<int>> first{ receive_one(channel) };
+    async::task<std::optional<int>> second{ receive_one(channel) };
+    async::task<std::optional<int>> third{ receive_one(channel) };
+
+    // Assert
+    REQUIRE(first.await_resume() == 1);
+    REQUIRE(second.await_resume() == 2);
+    REQUIRE(!third.await_resume().has_value());
+}
+
+TEST_CASE("mpmc_channel.send() returns false after close()")
+{
+    // Arrange
+    async::mpmc_channel<int> channel{ 4 };
+    channel.close();
+
+    // Act
+    async::task<bool> sender{ send_one(channel, 1) };
+
+    // Assert
+    REQUIRE(!sender.await_resume());
+}
+
+TEST_CASE("mpmc_channel.receive_many() receives up to the size of the span")
+{
+    // Arrange
+    async::mpmc_channel<int> channel{ 8 };
+    async::task<void> sender{ send_range(channel, 1, 6) };
+    std::array<int, 3> items{};
+
+    // Act
+    async::task<std::size_t> first{ receive_many(channel, items) };
+    std::array<int, 3> firstItems{ items };
+    async::task<std::size_t> second{ receive_many(channel, items) };
+
+    // Assert
+    REQUIRE(first.await_resume() == 3);
+    REQUIRE(firstItems == std::array<int, 3>{ 1, 2, 3 });
+    REQUIRE(second.await_resume() == 2);
+    REQUIRE(items[0] == 4);
+    REQUIRE(items[1] == 5);
+}
+
+TEST_CASE("mpmc_channel.receive_many() suspends until an item is sent")
+{
+    // Arrange
+    async::mpmc_channel<int> channel{ 4 };
+    std::array<int, 4> items{};
+    async::task<std::size_t> receiver{ receive_many(channel, items) };
+    bool resumedEarly{ receiver.await_ready() };
+
+    // Act
+    async::task<bool> sender{ send_one(channel, 9) };
+
+    // Assert
+    REQUIRE(!resumedEarly);
+    REQUIRE(receiver.await_resume() == 1);
+    REQUIRE(items[0] == 9);
+}
+
+TEST_CASE("mpmc_channel.receive_many() throws if the span is empty")
+{
+    // Arrange
+    async::mpmc_channel<int> channel{ 4 };
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(std::ignore = channel.receive_many(std::span<int>{}), std::invalid_argument,
+        Catch::Matchers::Message("The span must not be empty."));
+}
+
+TEST_CASE("mpmc_channel destroys items that were never received")
+{
+    // Arrange
+    std::shared_ptr<int> item{ std::make_shared<int>(1) };
+
+    // Act
+    {
+        async::mpmc_channel<std::shared_ptr<int>> channel{ 4 };
+        REQUIRE(async::awaitable_get(channel.send(item)));
+        REQUIRE(async::awaitable_get(channel.send(item)));
+    }
+
+    // Assert
+    REQUIRE(item.use_count() == 1);
+}
+
+TEST_CASE("mpmc_channel transfers every item between multiple producers and consumers")
+{
+    // Arrange
+    constexpr int producerCount{ 4 };
+    constexpr int itemsPerProducer{ 20000 };
+    async::mpmc_channel<int> channel{ 16 };
+    std::atomic<std::int64_t> sum{};
+
+    // Act
+    {
+        std::vector<simplejthread> consumers{};
+
+        for (int index = 0; index != 3; ++index)
+        {
+            consumers.emplace_back([&channel, &sum]() { sum += async::awaitable_get(sum_until_closed(channel)); });
+        }
+
+        {
+            std::vector<simplejthread> producers{};
+
+            for (int index = 0; index != producerCount; ++index)
+            {
+                producers.emplace_back([&channel, index]()
+                    {
+                        async::awaitable_get(
+                            send_range(channel, index * itemsPerProducer, (index + 1) * itemsPerProducer));
+                    });
+            }
+        }
+
+        channel.close();
+    }
+
+    // Assert
+    constexpr std::int64_t itemCount{ producerCount * itemsPerProducer };
+    REQUIRE(sum == itemCount * (itemCount - 1) / 2);
+}
@@ -0,0 +1,126 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/reduce.h"
+#include "async/task.h"
+#include "async/thread_pool.h"
+
+namespace
+{
+    // Runs each chunk inline, on the thread that starts the reduce.
+    struct inline_executor final
+    {
+        void operator()(std::coroutine_handle<> handle) const { handle.resume(); }
+    };
+
+    std::int64_t sum(std::vector<int>::const_iterator first, std::vector<int>::const_iterator last)
+    {
+        return std::accumulate(first, last, std::int64_t{});
+    }
+
+    std::int64_t add(std::int64_t left, std::int64_t right) noexcept { return left + right; }
+}
+
+TEST_CASE("reduce() combines the results of every chunk")
+{
+    // Arrange
+    std::vector<int> values(1000);
+    std::iota(values.begin(), values.end(), 1);
+
+    // Act
+    std::int64_t result{ async::awaitable_get(async::reduce(values, 7, sum, add, inline_executor{})) };
+
+    // Assert
+    REQUIRE(result == 500500);
+}
+
+TEST_CASE("reduce() preserves chunk order for a non-commutative combine")
+{
+    // Arrange
+    async::thread_pool pool{ 4 };
+    const std::string text{ "the quick brown fox jumps over the lazy dog" };
+    auto map = [](std::string::const_iterator first, std::string::const_iterator last)
+    { return std::string{ first, last }; };
+    auto concatenate = [](std::string left, const std::string& right) { return left + right; };
+
+    // Act
+    std::string result{ async::awaitable_get(async::reduce(text, 3, map, concatenate, pool.executor())) };
+
+    // Assert
+    REQUIRE(result == text);
+}
+
+TEST_CASE("reduce() runs a range smaller than one chunk as a single chunk")
+{
+    // Arrange
+    std::vector<int> values{ 1, 2, 3 };
+
+    // Act
+    std::int64_t result{ async::awaitable_get(async::reduce(values, 100, sum, add, inline_executor{})) };
+
+    // Assert
+    REQUIRE(result == 6);
+}
+
+TEST_CASE("reduce() awaits a map function that returns an awaitable")
+{
+    // Arrange
+    async::thread_pool pool{ 2 };
+    std::vector<int> values(100, 1);
+    auto map = [](std::vector<int>::const_iterator first, std::vector<int>::const_iterator last) -> async::task<int>
+    { co_return static_cast<int>(last - first); };
+
+    // Act
+    int result{ async::awaitable_get(async::reduce(values, 8, map, std::plus<int>{}, pool.executor())) };
+
+    // Assert
+    REQUIRE(result == 100);
+}
+
+TEST_CASE("reduce() rethrows an exception thrown by a chunk")
+{
+    // Arrange
+    async::thread_pool pool{ 2 };
+    std::vector<int> values(100, 1);
+    auto map = [](std::vector<int>::const_iterator first, std::vector<int>::const_iterator) -> int
+    {
+        if (*first == 1)
+        {
+            throw std::runtime_error{ "chunk failed" };
+        }
+
+        return 0;
+    };
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(async::awaitable_get(async::reduce(values, 10, map, std::plus<int>{}, pool.executor())),
+        std::runtime_error, Catch::Matchers::Message("chunk failed"));
+}
+
+TEST_CASE("reduce() throws if the range is empty")
+{
+    // Arrange
+    std::vector<int> values{};
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(async::awaitable_get(async::reduce(values, 10, sum, add, inline_executor{})),
+        std::invalid_argument, Catch::Matchers::Message("The range must not be empty."));
+}
+
+TEST_CASE("reduce() throws if the chunk size is zero")
+{
+    // Arrange
+    std::vector<int> values{ 1 };
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(async::awaitable_get(async::reduce(values, 0, sum, add, inline_executor{})),
+        std::invalid_argument, Catch::Matchers::Message("The chunk size must not be zero."));
+}
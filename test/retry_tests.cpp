@@ -0,0 +1,146 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+#include <stop_token>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/retry.h"
+#include "async/task.h"
+#include "async/task_canceled.h"
+#include "async/timer_service.h"
+
+namespace
+{
+    async::task<int> fail_until(int& attempts, int successfulAttempt)
+    {
+        if (++attempts < successfulAttempt)
+        {
+            throw std::runtime_error{ "attempt failed" };
+        }
+
+        co_return attempts;
+    }
+
+    async::retry_policy fast_policy(std::size_t maxAttempts)
+    {
+        async::retry_policy policy{};
+        policy.maxAttempts = maxAttempts;
+        policy.initialDelay = std::chrono::microseconds{ 100 };
+        policy.maxDelay = std::chrono::milliseconds{ 1 };
+        return policy;
+    }
+}
+
+TEST_CASE("retry() returns the result of the first successful attempt")
+{
+    // Arrange
+    async::timer_service timers{};
+    int attempts{};
+
+    // Act
+    int result{ async::awaitable_get(async::retry(
+        fast_policy(5), [&attempts]() { return fail_until(attempts, 3); }, {}, timers)) };
+
+    // Assert
+    REQUIRE(result == 3);
+    REQUIRE(attempts == 3);
+}
+
+TEST_CASE("retry() rethrows the last failure after the maximum number of attempts")
+{
+    // Arrange
+    async::timer_service timers{};
+    int attempts{};
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(async::awaitable_get(async::retry(
+                               fast_policy(3), [&attempts]() { return fail_until(attempts, 10); }, {}, timers)),
+        std::runtime_error, Catch::Matchers::Message("attempt failed"));
+    REQUIRE(attempts == 3);
+}
+
+TEST_CASE("retry() does not retry failures the predicate rejects")
+{
+    // Arrange
+    async::timer_service timers{};
+    async::retry_policy policy{ fast_policy(5) };
+    policy.retryable = [](const std::exception_ptr&) { return false; };
+    int attempts{};
+
+    // Act & Assert
+    REQUIRE_THROWS_AS(async::awaitable_get(async::retry(
+                          policy, [&attempts]() { return fail_until(attempts, 10); }, {}, timers)),
+        std::runtime_error);
+    REQUIRE(attempts == 1);
+}
+
+TEST_CASE("retry() does not retry task_canceled by default")
+{
+    // Arrange
+    async::timer_service timers{};
+    int attempts{};
+    auto factory{ [&attempts]() -> async::task<void>
+        {
+            ++attempts;
+            throw async::task_canceled{};
+        } };
+
+    // Act & Assert
+    REQUIRE_THROWS_AS(async::awaitable_get(async::retry(fast_policy(5), factory, {}, timers)), async::task_canceled);
+    REQUIRE(attempts == 1);
+}
+
+TEST_CASE("retry() throws task_canceled when stop is requested during a delay")
+{
+    // Arrange
+    async::timer_service timers{};
+    std::stop_source stopSource{};
+    async::retry_policy policy{ fast_policy(5) };
+    policy.initialDelay = std::chrono::hours{ 1 };
+    policy.maxDelay = std::chrono::hours{ 1 };
+    int attempts{};
+    async::task<int> task{ async::retry(
+        policy, [&attempts]() { return fail_until(attempts, 10); }, stopSource.get_token(), timers) };
+
+    // Act
+    stopSource.request_stop();
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE_THROWS_AS(task.await_resume(), async::task_canceled);
+    REQUIRE(attempts == 1);
+}
+
+TEST_CASE("retry() passes its stop token to a factory that accepts one")
+{
+    // Arrange
+    async::timer_service timers{};
+    std::stop_source stopSource{};
+    bool receivedToken{};
+    auto factory{ [&receivedToken, &stopSource](std::stop_token stopToken) -> async::task<void>
+        {
+            receivedToken = stopToken == stopSource.get_token();
+            co_return;
+        } };
+
+    // Act
+    async::awaitable_get(async::retry(fast_policy(1), factory, stopSource.get_token(), timers));
+
+    // Assert
+    REQUIRE(receivedToken);
+}
+
+TEST_CASE("retry() throws when the policy allows no attempts")
+{
+    // Arrange
+    async::timer_service timers{};
+    int attempts{};
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(async::awaitable_get(async::retry(
+                               fast_policy(0), [&attempts]() { return fail_until(attempts, 1); }, {}, timers)),
+        std::invalid_argument, Catch::Matchers::Message("The maximum number of attempts must not be zero."));
+    REQUIRE(attempts == 0);
+}
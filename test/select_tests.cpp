@@ -0,0 +1,262 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <variant>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/mpmc_channel.h"
+#include "async/select.h"
+#include "async/task.h"
+#include "async/task_canceled.h"
+#include "async/timer_service.h"
+#include "simplejthread.h"
+
+namespace
+{
+    using two_channel_result = std::variant<std::optional<int>, std::optional<int>>;
+    using channel_or_timer_result = std::variant<std::optional<int>, std::monostate>;
+
+    async::task<two_channel_result> select_two(async::mpmc_channel<int>& first, async::mpmc_channel<int>& second)
+    {
+        co_return co_await async::select(first.receive(), second.receive());
+    }
+
+    async::task<channel_or_timer_result> select_with_timeout(
+        async::mpmc_channel<int>& channel, async::timer_service& timers, std::chrono::milliseconds timeout)
+    {
+        co_return co_await async::select(channel.receive(), timers.wait_for(timeout));
+    }
+
+    async::task<std::optional<int>> receive_one(async::mpmc_channel<int>& channel)
+    {
+        co_return co_await channel.receive();
+    }
+
+    async::task<bool> send_one(async::mpmc_channel<int>& channel, int value)
+    {
+        co_return co_await channel.send(value);
+    }
+}
+
+TEST_CASE("select() completes with a ready channel without suspending")
+{
+    // Arrange
+    async::mpmc_channel<int> first{ 4 };
+    async::mpmc_channel<int> second{ 4 };
+    std::ignore = async::awaitable_get(send_one(second, 2));
+
+    // Act
+    async::task<two_channel_result> selecting{ select_two(first, second) };
+
+    // Assert
+    REQUIRE(selecting.await_ready());
+    two_channel_result result{ selecting.await_resume() };
+    REQUIRE(result.index() == 1);
+    REQUIRE(std::get<1>(result) == 2);
+}
+
+TEST_CASE("select() prefers the first ready operation and leaves the other items in place")
+{
+    // Arrange
+    async::mpmc_channel<int> first{ 4 };
+    async::mpmc_channel<int> second{ 4 };
+    std::ignore = async::awaitable_get(send_one(first, 1));
+    std::ignore = async::awaitable_get(send_one(second, 2));
+
+    // Act
+    two_channel_result result{ async::awaitable_get(select_two(first, second)) };
+
+    // Assert
+    REQUIRE(result.index() == 0);
+    REQUIRE(std::get<0>(result) == 1);
+    REQUIRE(async::awaitable_get(receive_one(second)) == 2);
+}
+
+TEST_CASE("select() suspends until an item is sent to any of the channels")
+{
+    // Arrange
+    async::mpmc_channel<int> first{ 4 };
+    async::mpmc_channel<int> second{ 4 };
+    async::task<two_channel_result> selecting{ select_two(first, second) };
+    bool resumedEarly{ selecting.await_ready() };
+
+    // Act
+    std::ignore = async::awaitable_get(send_one(second, 2));
+
+    // Assert
+    REQUIRE(!resumedEarly);
+    REQUIRE(selecting.await_ready());
+    two_channel_result result{ selecting.await_resume() };
+    REQUIRE(result.index() == 1);
+    REQUIRE(std::get<1>(result) == 2);
+}
+
+TEST_CASE("select() deregisters from the other channels so later items are not lost")
+{
+    // Arrange
+    async::mpmc_channel<int> first{ 4 };
+    async::mpmc_channel<int> second{ 4 };
+    async::task<two_channel_result> selecting{ select_two(first, second) };
+    std::ignore = async::awaitable_get(send_one(first, 1));
+    std::ignore = selecting.await_resume();
+
+    // Act
+    std::ignore = async::awaitable_get(send_one(second, 2));
+
+    // Assert
+    REQUIRE(async::awaitable_get(receive_one(second)) == 2);
+}
+
+TEST_CASE("select() completes with a closed channel's receive returning nullopt")
+{
+    // Arrange
+    async::mpmc_channel<int> first{ 4 };
+    async::mpmc_channel<int> second{ 4 };
+    async::task<two_channel_result> selecting{ select_two(first, second) };
+
+    // Act
+    first.close();
+
+    // Assert
+    REQUIRE(selecting.await_ready());
+    two_channel_result result{ selecting.await_resume() };
+    REQUIRE(result.index() == 0);
+    REQUIRE(!std::get<0>(result).has_value());
+}
+
+TEST_CASE("select() completes with a timer wait when no item arrives in time")
+{
+    // Arrange
+    async::timer_service timers{};
+    async::mpmc_channel<int> channel{ 4 };
+
+    // Act
+    channel_or_timer_result result{ async::awaitable_get(
+        select_with_timeout(channel, timers, std::chrono::milliseconds{ 10 })) };
+
+    // Assert
+    REQUIRE(result.index() == 1);
+}
+
+TEST_CASE("select() removes a pending timer wait when a channel completes first")
+{
+    // Arrange
+    async::timer_service timers{};
+    async::mpmc_channel<int> channel{ 4 };
+    async::task<channel_or_timer_result> selecting{ select_with_timeout(channel, timers, std::chrono::hours{ 1 }) };
+    bool timerPending{ timers.pending_count() == 1 };
+
+    // Act
+    std::ignore = async::awaitable_get(send_one(channel, 1));
+
+    // Assert
+    REQUIRE(timerPending);
+    REQUIRE(selecting.await_ready());
+    channel_or_timer_result result{ selecting.await_resume() };
+    REQUIRE(result.index() == 0);
+    REQUIRE(std::get<0>(result) == 1);
+    REQUIRE(timers.pending_count() == 0);
+}
+
+TEST_CASE("select() throws task_canceled when the timer service is destroyed")
+{
+    // Arrange
+    async::mpmc_channel<int> channel{ 4 };
+    std::optional<async::timer_service> timers{ std::in_place };
+    async::task<channel_or_timer_result> selecting{ select_with_timeout(channel, *timers, std::chrono::hours{ 1 }) };
+
+    // Act
+    timers.reset();
+
+    // Assert
+    REQUIRE(selecting.await_ready());
+    REQUIRE_THROWS_AS(selecting.await_resume(), async::task_canceled);
+}
+
+namespace
+{
+    async::task<std::int64_t> select_until_closed(async::mpmc_channel<int>& first, async::mpmc_channel<int>& second)
+    {
+        std::int64_t sum{};
+        bool firstOpen{ true };
+        bool secondOpen{ true };
+
+        while (firstOpen && secondOpen)
+        {
+            two_channel_result result{ co_await async::select(first.receive(), second.receive()) };
+            std::optional<int>& value{ result.index() == 0 ? std::get<0>(result) : std::get<1>(result) };
+
+            if (value)
+            {
+                sum += *value;
+            }
+            else
+            {
+                (result.index() == 0 ? firstOpen : secondOpen) = false;
+            }
+        }
+
+        // Drain whichever channel is still open.
+        async::mpmc_channel<int>& remaining{ firstOpen ? first : second };
+
+        while (std::optional<int> value{ co_await remaining.receive() })
+        {
+            sum += *value;
+        }
+
+        co_return sum;
+    }
+
+    async::task<std::int64_t> receive_until_closed(async::mpmc_channel<int>& channel)
+    {
+        std::int64_t sum{};
+
+        while (std::optional<int> value{ co_await channel.receive() })
+        {
+            sum += *value;
+        }
+
+        co_return sum;
+    }
+
+    async::task<void> send_range(async::mpmc_channel<int>& channel, int count)
+    {
+        for (int value = 1; value <= count; ++value)
+        {
+            co_await channel.send(value);
+        }
+    }
+}
+
+TEST_CASE("select() loses no items when racing other receivers across threads")
+{
+    // Arrange
+    constexpr int itemCount{ 100000 };
+    constexpr std::int64_t expectedSum{ 2 * static_cast<std::int64_t>(itemCount) * (itemCount + 1) / 2 };
+    async::mpmc_channel<int> first{ 16 };
+    async::mpmc_channel<int> second{ 16 };
+    std::atomic<std::int64_t> sum{};
+
+    // Act
+    {
+        std::vector<simplejthread> threads{};
+        threads.emplace_back([&]() { sum += async::awaitable_get(select_until_closed(first, second)); });
+        threads.emplace_back([&]() { sum += async::awaitable_get(select_until_closed(first, second)); });
+        threads.emplace_back([&]() { sum += async::awaitable_get(receive_until_closed(first)); });
+
+        {
+            simplejthread firstProducer{ [&]() { async::awaitable_get(send_range(first, itemCount)); } };
+            simplejthread secondProducer{ [&]() { async::awaitable_get(send_range(second, itemCount)); } };
+        }
+
+        first.close();
+        second.close();
+    }
+
+    // Assert
+    REQUIRE(sum == expectedSum);
+}
@@ -0,0 +1,174 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/sequence_barrier.h"
+#include "async/task.h"
+#include "simplejthread.h"
+
+namespace
+{
+    async::task<void> wait_and_record(
+        async::sequence_barrier& barrier, std::int64_t sequence, std::vector<std::int64_t>& resumed)
+    {
+        co_await barrier.wait_until_published(sequence);
+        resumed.push_back(sequence);
+    }
+}
+
+TEST_CASE("sequence_barrier.last_published() returns the initial sequence")
+{
+    // Arrange
+    async::sequence_barrier barrier{ 5 };
+
+    // Act
+    std::int64_t lastPublished{ barrier.last_published() };
+
+    // Assert
+    REQUIRE(lastPublished == 5);
+}
+
+TEST_CASE("sequence_barrier.wait_until_published() does not suspend when the sequence is already published")
+{
+    // Arrange
+    async::sequence_barrier barrier{};
+    barrier.publish(3);
+    std::vector<std::int64_t> resumed{};
+
+    // Act
+    async::task<void> task{ wait_and_record(barrier, 3, resumed) };
+
+    // Assert
+    REQUIRE(task.await_ready());
+}
+
+TEST_CASE("sequence_barrier.wait_until_published() suspends until the sequence is published")
+{
+    // Arrange
+    async::sequence_barrier barrier{};
+    std::vector<std::int64_t> resumed{};
+    async::task<void> task{ wait_and_record(barrier, 2, resumed) };
+
+    // Act
+    barrier.publish(1);
+    bool resumedEarly{ !resumed.empty() };
+    barrier.publish(2);
+
+    // Assert
+    REQUIRE(!resumedEarly);
+    REQUIRE(resumed == std::vector<std::int64_t>{ 2 });
+}
+
+TEST_CASE("sequence_barrier.publish() resumes waiters in sequence order")
+{
+    // Arrange
+    async::sequence_barrier barrier{};
+    std::vector<std::int64_t> resumed{};
+    async::task<void> third{ wait_and_record(barrier, 3, resumed) };
+    async::task<void> first{ wait_and_record(barrier, 1, resumed) };
+    async::task<void> fourth{ wait_and_record(barrier, 4, resumed) };
+    async::task<void> second{ wait_and_record(barrier, 2, resumed) };
+
+    // Act
+    barrier.publish(3);
+
+    // Assert
+    REQUIRE(resumed == std::vector<std::int64_t>{ 1, 2, 3 });
+    barrier.publish(4);
+    REQUIRE(resumed == std::vector<std::int64_t>{ 1, 2, 3, 4 });
+}
+
+namespace
+{
+    async::task<std::int64_t> wait_until_published(async::sequence_barrier& barrier, std::int64_t sequence)
+    {
+        co_return co_await barrier.wait_until_published(sequence);
+    }
+}
+
+TEST_CASE("sequence_barrier.wait_until_published() returns the last published sequence")
+{
+    // Arrange
+    async::sequence_barrier barrier{};
+    async::task<std::int64_t> task{ wait_until_published(barrier, 2) };
+
+    // Act
+    barrier.publish(10);
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE(task.await_resume() == 10);
+}
+
+TEST_CASE("sequence_barrier.publish() throws when the sequence moves backwards")
+{
+    // Arrange
+    async::sequence_barrier barrier{};
+    barrier.publish(3);
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(barrier.publish(2), std::invalid_argument,
+        Catch::Matchers::Message("The sequence must not be less than the last published sequence."));
+}
+
+namespace
+{
+    async::task<std::int64_t> consume(async::sequence_barrier& barrier, const std::vector<std::int64_t>& ring,
+        std::int64_t count)
+    {
+        std::int64_t sum{};
+        std::int64_t next{};
+
+        while (next != count)
+        {
+            const std::int64_t available{ co_await barrier.wait_until_published(next) };
+
+            for (; next <= available; ++next)
+            {
+                sum += ring[static_cast<std::size_t>(next)];
+            }
+        }
+
+        co_return sum;
+    }
+}
+
+TEST_CASE("sequence_barrier delivers every published sequence to consumers on other threads")
+{
+    // Arrange
+    constexpr std::int64_t count{ 100000 };
+    constexpr int consumerCount{ 4 };
+    async::sequence_barrier barrier{};
+    std::vector<std::int64_t> ring(static_cast<std::size_t>(count));
+    std::vector<std::int64_t> sums(consumerCount);
+
+    // Act
+    {
+        std::vector<simplejthread> consumers{};
+
+        for (int i = 0; i != consumerCount; ++i)
+        {
+            consumers.emplace_back(
+                [&barrier, &ring, &sums, i]() { sums[i] = async::awaitable_get(consume(barrier, ring, count)); });
+        }
+
+        for (std::int64_t sequence = 0; sequence != count; sequence += 8)
+        {
+            const std::int64_t batchEnd{ std::min(sequence + 8, count) };
+
+            for (std::int64_t item = sequence; item != batchEnd; ++item)
+            {
+                ring[static_cast<std::size_t>(item)] = item;
+            }
+
+            barrier.publish(batchEnd - 1);
+        }
+    }
+
+    // Assert
+    REQUIRE(sums == std::vector<std::int64_t>(consumerCount, count * (count - 1) / 2));
+}
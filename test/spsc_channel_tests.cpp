@@ -0,0 +1,177 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/spsc_channel.h"
+#include "async/task.h"
+#include "simplejthread.h"
+
+namespace
+{
+    template <typename T, std::size_t Capacity>
+    async::task<void> send_all(async::spsc_channel<T, Capacity>& channel, std::vector<T> values)
+    {
+        for (T& value : values)
+        {
+            co_await channel.send(std::move(value));
+        }
+    }
+
+    template <typename T, std::size_t Capacity>
+    async::task<void> receive_count(
+        async::spsc_channel<T, Capacity>& channel, std::size_t count, std::vector<T>& received)
+    {
+        for (std::size_t index = 0; index != count; ++index)
+        {
+            received.push_back(co_await channel.receive());
+        }
+    }
+
+    template <std::size_t Capacity>
+    async::task<std::int64_t> sum_received(async::spsc_channel<int, Capacity>& channel, int count)
+    {
+        std::int64_t sum{};
+
+        for (int index = 0; index != count; ++index)
+        {
+            sum += co_await channel.receive();
+        }
+
+        co_return sum;
+    }
+
+    template <std::size_t Capacity>
+    async::task<void> send_sequence(async::spsc_channel<int, Capacity>& channel, int count)
+    {
+        for (int index = 0; index != count; ++index)
+        {
+            co_await channel.send(index);
+        }
+    }
+}
+
+TEST_CASE("spsc_channel.receive() does not suspend when an item is available")
+{
+    // Arrange
+    async::spsc_channel<int, 4> channel{};
+    async::task<void> sender{ send_all(channel, std::vector<int>{ 1 }) };
+    std::vector<int> received{};
+
+    // Act
+    async::task<void> receiver{ receive_count(channel, 1, received) };
+
+    // Assert
+    REQUIRE(receiver.await_ready());
+    REQUIRE(received == std::vector<int>{ 1 });
+}
+
+TEST_CASE("spsc_channel.receive() suspends until an item is sent")
+{
+    // Arrange
+    async::spsc_channel<int, 4> channel{};
+    std::vector<int> received{};
+    async::task<void> receiver{ receive_count(channel, 1, received) };
+    bool resumedEarly{ receiver.await_ready() };
+
+    // Act
+    async::task<void> sender{ send_all(channel, std::vector<int>{ 7 }) };
+
+    // Assert
+    REQUIRE(!resumedEarly);
+    REQUIRE(receiver.await_ready());
+    REQUIRE(received == std::vector<int>{ 7 });
+}
+
+TEST_CASE("spsc_channel.send() suspends while the channel is full")
+{
+    // Arrange
+    async::spsc_channel<int, 2> channel{};
+    async::task<void> sender{ send_all(channel, std::vector<int>{ 1, 2, 3 }) };
+    bool completedEarly{ sender.await_ready() };
+    std::vector<int> received{};
+
+    // Act
+    async::task<void> receiver{ receive_count(channel, 1, received) };
+
+    // Assert
+    REQUIRE(!completedEarly);
+    REQUIRE(sender.await_ready());
+    REQUIRE(received == std::vector<int>{ 1 });
+}
+
+TEST_CASE("spsc_channel preserves order when the ring buffer wraps around")
+{
+    // Arrange
+    async::spsc_channel<int, 4> channel{};
+    std::vector<int> values{};
+
+    for (int index = 0; index != 10; ++index)
+    {
+        values.push_back(index);
+    }
+
+    std::vector<int> received{};
+    async::task<void> sender{ send_all(channel, values) };
+
+    // Act
+    async::task<void> receiver{ receive_count(channel, values.size(), received) };
+
+    // Assert
+    REQUIRE(sender.await_ready());
+    REQUIRE(receiver.await_ready());
+    REQUIRE(received == values);
+}
+
+TEST_CASE("spsc_channel supports move-only items")
+{
+    // Arrange
+    async::spsc_channel<std::unique_ptr<int>, 2> channel{};
+    std::vector<std::unique_ptr<int>> values{};
+    values.push_back(std::make_unique<int>(5));
+    async::task<void> sender{ send_all(channel, std::move(values)) };
+    std::vector<std::unique_ptr<int>> received{};
+
+    // Act
+    async::task<void> receiver{ receive_count(channel, 1, received) };
+
+    // Assert
+    REQUIRE(received.size() == 1);
+    REQUIRE(*received[0] == 5);
+}
+
+TEST_CASE("spsc_channel destroys items that were never received")
+{
+    // Arrange
+    std::shared_ptr<int> item{ std::make_shared<int>(1) };
+
+    // Act
+    {
+        async::spsc_channel<std::shared_ptr<int>, 4> channel{};
+        async::task<void> sender{ send_all(channel, std::vector<std::shared_ptr<int>>{ item, item }) };
+    }
+
+    // Assert
+    REQUIRE(item.use_count() == 1);
+}
+
+TEST_CASE("spsc_channel transfers every item between threads")
+{
+    // Arrange
+    constexpr int count{ 100000 };
+    async::spsc_channel<int, 16> channel{};
+    std::int64_t sum{};
+
+    // Act
+    {
+        simplejthread consumer{ [&channel, &sum]() { sum = async::awaitable_get(sum_received(channel, count)); } };
+        simplejthread producer{ [&channel]() { async::awaitable_get(send_sequence(channel, count)); } };
+    }
+
+    // Assert
+    REQUIRE(sum == std::int64_t{ count } * (count - 1) / 2);
+}
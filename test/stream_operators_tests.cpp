@@ -0,0 +1,341 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/async_generator.h"
+#include "async/awaitable_get.h"
+#include "async/stream_operators.h"
+#include "async/task.h"
+#include "async/task_completion_source.h"
+#include "async/thread_pool.h"
+
+namespace
+{
+    async::async_generator<int> count_to(int count, int& pulled)
+    {
+        for (int value = 1; value <= count; ++value)
+        {
+            ++pulled;
+            co_yield value;
+        }
+    }
+
+    async::async_generator<int> count_to(int count)
+    {
+        for (int value = 1; value <= count; ++value)
+        {
+            co_yield value;
+        }
+    }
+
+    async::async_generator<int> yield_then_throw(int count)
+    {
+        for (int value = 1; value <= count; ++value)
+        {
+            co_yield value;
+        }
+
+        throw std::runtime_error{ "generator failed" };
+    }
+
+    async::async_generator<int> yield_after(async::task<int> awaitable)
+    {
+        co_yield co_await std::move(awaitable);
+    }
+
+    async::async_generator<const std::string> yield_const_elements(const std::vector<std::string>& values)
+    {
+        for (const std::string& value : values)
+        {
+            co_yield value;
+        }
+    }
+
+    async::async_generator<int> yield_forever(std::shared_ptr<int> resource)
+    {
+        while (true)
+        {
+            co_yield *resource;
+        }
+    }
+
+    template <typename T>
+    async::task<std::vector<T>> collect(async::async_generator<T> generator)
+    {
+        std::vector<T> values{};
+
+        while (T* value{ co_await generator.next() })
+        {
+            values.push_back(*value);
+        }
+
+        co_return values;
+    }
+
+    template <typename T>
+    async::task<T*> next_pointer(const async::async_generator<T>& generator)
+    {
+        co_return co_await generator.next();
+    }
+}
+
+TEST_CASE("map and filter transform and select values in order")
+{
+    // Arrange
+    async::async_generator<std::string> generator{ count_to(6) |
+        async::filter([](int value) { return value % 2 == 0; }) |
+        async::map([](int value) { return std::to_string(value * 10); }) };
+
+    // Act
+    std::vector<std::string> values{ async::awaitable_get(collect(std::move(generator))) };
+
+    // Assert
+    REQUIRE(values == std::vector<std::string>{ "20", "40", "60" });
+}
+
+TEST_CASE("take stops resuming the upstream once it has passed on count values")
+{
+    // Arrange
+    int pulled{};
+    async::async_generator<int> generator{ count_to(100, pulled) | async::take(3) };
+
+    // Act
+    std::vector<int> values{ async::awaitable_get(collect(std::move(generator))) };
+
+    // Assert
+    REQUIRE(values == std::vector<int>{ 1, 2, 3 });
+    REQUIRE(pulled == 3);
+}
+
+TEST_CASE("take(0) completes without resuming the upstream")
+{
+    // Arrange
+    int pulled{};
+    async::async_generator<int> generator{ count_to(100, pulled) | async::take(0) };
+
+    // Act
+    std::vector<int> values{ async::awaitable_get(collect(std::move(generator))) };
+
+    // Assert
+    REQUIRE(values.empty());
+    REQUIRE(pulled == 0);
+}
+
+TEST_CASE("chunk groups values and yields the last partial chunk")
+{
+    // Arrange
+    async::async_generator<std::vector<int>> generator{ count_to(7) | async::chunk(3) };
+
+    // Act
+    std::vector<std::vector<int>> values{ async::awaitable_get(collect(std::move(generator))) };
+
+    // Assert
+    REQUIRE(values == std::vector<std::vector<int>>{ { 1, 2, 3 }, { 4, 5, 6 }, { 7 } });
+}
+
+TEST_CASE("chunk throws if the size is zero")
+{
+    // Act & Assert
+    REQUIRE_THROWS_AS(async::chunk(0), std::invalid_argument);
+}
+
+TEST_CASE("stages after chunk receive the flushed partial chunk")
+{
+    // Arrange
+    async::async_generator<std::size_t> generator{ count_to(5) | async::chunk(2) |
+        async::map([](const std::vector<int>& values) { return values.size(); }) | async::take(5) };
+
+    // Act
+    std::vector<std::size_t> values{ async::awaitable_get(collect(std::move(generator))) };
+
+    // Assert
+    REQUIRE(values == std::vector<std::size_t>{ 2, 2, 1 });
+}
+
+TEST_CASE("chunk before take flushes no more than take passes on")
+{
+    // Arrange
+    async::async_generator<std::vector<int>> generator{ count_to(10) | async::chunk(4) | async::take(1) };
+
+    // Act
+    std::vector<std::vector<int>> values{ async::awaitable_get(collect(std::move(generator))) };
+
+    // Assert
+    REQUIRE(values == std::vector<std::vector<int>>{ { 1, 2, 3, 4 } });
+}
+
+TEST_CASE("fused stages copy the values of a generator of const values")
+{
+    // Arrange
+    const std::vector<std::string> elements{ "a", "b" };
+    async::async_generator<std::string> generator{ yield_const_elements(elements) |
+        async::map([](std::string value) { return value + value; }) };
+
+    // Act
+    std::vector<std::string> values{ async::awaitable_get(collect(std::move(generator))) };
+
+    // Assert
+    REQUIRE(values == std::vector<std::string>{ "aa", "bb" });
+    REQUIRE(elements == std::vector<std::string>{ "a", "b" });
+}
+
+TEST_CASE("fused stages wait for awaitables in the upstream")
+{
+    // Arrange
+    async::task_completion_source<int> promise{};
+    async::async_generator<int> generator{ yield_after(promise.task()) |
+        async::map([](int value) { return value + 1; }) };
+    async::task<int*> next{ next_pointer(generator) };
+    bool readyEarly{ next.await_ready() };
+
+    // Act
+    promise.set_value(1);
+
+    // Assert
+    REQUIRE(!readyEarly);
+    REQUIRE(next.await_ready());
+    REQUIRE(*next.await_resume() == 2);
+}
+
+TEST_CASE("fused stages rethrow an exception thrown by the upstream")
+{
+    // Arrange
+    async::async_generator<int> generator{ yield_then_throw(1) | async::map([](int value) { return value; }) };
+
+    // Act
+    int* first{ async::awaitable_get(next_pointer(generator)) };
+
+    // Assert
+    REQUIRE(*first == 1);
+    REQUIRE_THROWS_AS(async::awaitable_get(next_pointer(generator)), std::runtime_error);
+}
+
+TEST_CASE("buffer passes on every value, produced on the executor")
+{
+    // Arrange
+    async::thread_pool pool{ 1 };
+    const std::thread::id consumerThread{ std::this_thread::get_id() };
+    std::atomic<int> consumerThreadValues{};
+    auto recordThread = [consumerThread, &consumerThreadValues](int value)
+    {
+        if (std::this_thread::get_id() == consumerThread)
+        {
+            ++consumerThreadValues;
+        }
+
+        return value;
+    };
+    async::async_generator<int> generator{ count_to(1000) | async::map(recordThread) |
+        async::buffer(16, pool.executor()) };
+
+    // Act
+    std::vector<int> values{ async::awaitable_get(collect(std::move(generator))) };
+
+    // Assert
+    REQUIRE(values.size() == 1000);
+
+    for (int index = 0; index != 1000; ++index)
+    {
+        REQUIRE(values[index] == index + 1);
+    }
+
+    REQUIRE(consumerThreadValues == 0);
+}
+
+TEST_CASE("buffer passes on the values produced before an exception and then the exception")
+{
+    // Arrange
+    async::thread_pool pool{ 1 };
+    async::async_generator<int> generator{ yield_then_throw(2) | async::buffer(4, pool.executor()) };
+
+    // Act
+    int first{ *async::awaitable_get(next_pointer(generator)) };
+    int second{ *async::awaitable_get(next_pointer(generator)) };
+
+    // Assert
+    REQUIRE(first == 1);
+    REQUIRE(second == 2);
+    REQUIRE_THROWS_AS(async::awaitable_get(next_pointer(generator)), std::runtime_error);
+}
+
+TEST_CASE("buffer throws if the capacity is zero")
+{
+    // Act & Assert
+    REQUIRE_THROWS_AS(async::buffer(0, async::details::inline_executor{}), std::invalid_argument);
+}
+
+TEST_CASE("destroying a buffered generator stops and destroys the upstream")
+{
+    // Arrange
+    std::shared_ptr<int> resource{ std::make_shared<int>(1) };
+    std::weak_ptr<int> weakResource{ resource };
+    std::optional<async::async_generator<int>> generator{ yield_forever(std::move(resource)) |
+        async::buffer(4, async::details::inline_executor{}) };
+    int first{ *async::awaitable_get(next_pointer(*generator)) };
+
+    // Act
+    generator.reset();
+
+    // Assert
+    REQUIRE(first == 1);
+    REQUIRE(weakResource.expired());
+}
+
+TEST_CASE("merge interleaves every value of every source and then completes")
+{
+    // Arrange
+    async::task_completion_source<int> promise{};
+    async::async_generator<int> generator{ async::merge(4, yield_after(promise.task()), count_to(3)) };
+    async::task<std::vector<int>> collecting{ collect(std::move(generator)) };
+    bool completedEarly{ collecting.await_ready() };
+
+    // Act
+    promise.set_value(10);
+
+    // Assert
+    REQUIRE(!completedEarly);
+    REQUIRE(collecting.await_ready());
+    REQUIRE(collecting.await_resume() == std::vector<int>{ 1, 2, 3, 10 });
+}
+
+TEST_CASE("merge rethrows an exception thrown by a source after the values already received")
+{
+    // Arrange
+    async::async_generator<int> generator{ async::merge(4, yield_then_throw(1), count_to(0)) };
+
+    // Act
+    int first{ *async::awaitable_get(next_pointer(generator)) };
+
+    // Assert
+    REQUIRE(first == 1);
+    REQUIRE_THROWS_AS(async::awaitable_get(next_pointer(generator)), std::runtime_error);
+}
+
+TEST_CASE("merge pulls from sources on other threads until every one completes")
+{
+    // Arrange
+    constexpr int valueCount{ 10000 };
+    async::thread_pool pool{ 2 };
+    async::async_generator<int> generator{ async::merge(8, count_to(valueCount) | async::buffer(8, pool.executor()),
+        count_to(valueCount) | async::buffer(8, pool.executor())) };
+
+    // Act
+    std::vector<int> values{ async::awaitable_get(collect(std::move(generator))) };
+
+    // Assert
+    REQUIRE(values.size() == 2 * valueCount);
+    long long sum{};
+
+    for (int value : values)
+    {
+        sum += value;
+    }
+
+    REQUIRE(sum == static_cast<long long>(valueCount) * (valueCount + 1));
+}
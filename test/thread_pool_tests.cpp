@@ -0,0 +1,93 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <atomic>
+#include <coroutine>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/awaitable_then.h"
+#include "async/event_signal.h"
+#include "async/task.h"
+#include "async/thread_pool.h"
+
+namespace
+{
+    async::task<std::thread::id> get_thread_after_schedule(async::thread_pool& pool)
+    {
+        co_await pool.schedule();
+        co_return std::this_thread::get_id();
+    }
+
+    async::task<int> increment_after_schedule(async::thread_pool& pool, std::atomic<int>& count)
+    {
+        co_await pool.schedule();
+        co_return ++count;
+    }
+}
+
+TEST_CASE("thread_pool.schedule() resumes the awaiting coroutine on a pool thread")
+{
+    // Arrange
+    async::thread_pool pool{ 1 };
+
+    // Act
+    std::thread::id poolThread{ async::awaitable_get(get_thread_after_schedule(pool)) };
+
+    // Assert
+    REQUIRE(poolThread != std::this_thread::get_id());
+}
+
+TEST_CASE("thread_pool.executor() runs awaitable_then continuations on a pool thread")
+{
+    // Arrange
+    async::thread_pool pool{ 2 };
+    async::event_signal done{};
+    std::thread::id continuationThread{};
+
+    // Act
+    async::awaitable_then(
+        std::suspend_never{}, pool.executor(), [&continuationThread, &done](async::awaitable_result<void>)
+        {
+            continuationThread = std::this_thread::get_id();
+            done.set();
+        });
+    done.wait();
+
+    // Assert
+    REQUIRE(continuationThread != std::this_thread::get_id());
+}
+
+TEST_CASE("thread_pool runs queued coroutines before its destructor returns")
+{
+    // Arrange
+    constexpr int taskCount{ 100 };
+    std::atomic<int> count{};
+    std::vector<async::task<int>> tasks{};
+
+    // Act
+    {
+        async::thread_pool pool{ 4 };
+
+        for (int i = 0; i != taskCount; ++i)
+        {
+            tasks.push_back(increment_after_schedule(pool, count));
+        }
+    }
+
+    // Assert
+    REQUIRE(count.load() == taskCount);
+
+    for (async::task<int>& task : tasks)
+    {
+        REQUIRE(task.await_ready());
+    }
+}
+
+TEST_CASE("thread_pool throws if the thread count is zero")
+{
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(async::thread_pool{ 0 }, std::invalid_argument,
+        Catch::Matchers::Message("The thread count must not be zero."));
+}
@@ -0,0 +1,165 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <chrono>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/task.h"
+#include "async/task_canceled.h"
+#include "async/timer_service.h"
+#include "simplejthread.h"
+
+namespace
+{
+    async::task<std::thread::id> wait_until(async::timer_service& timers,
+        std::chrono::steady_clock::time_point deadline, std::stop_token stopToken = {})
+    {
+        co_await timers.wait_until(deadline, stopToken);
+        co_return std::this_thread::get_id();
+    }
+
+    async::task<void> wait_and_record(async::timer_service& timers, std::chrono::milliseconds delay, int id,
+        std::vector<int>& order)
+    {
+        co_await timers.wait_for(delay);
+        order.push_back(id);
+    }
+}
+
+TEST_CASE("timer_service.wait_until() does not suspend when the deadline has passed")
+{
+    // Arrange
+    async::timer_service timers{};
+
+    // Act
+    async::task<std::thread::id> task{ wait_until(timers, std::chrono::steady_clock::now()) };
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE(task.await_resume() == std::this_thread::get_id());
+}
+
+TEST_CASE("timer_service.wait_until() resumes on the timer thread after the deadline")
+{
+    // Arrange
+    async::timer_service timers{};
+    const std::chrono::steady_clock::time_point deadline{ std::chrono::steady_clock::now() +
+                                                          std::chrono::milliseconds{ 20 } };
+
+    // Act
+    std::thread::id resumedOn{ async::awaitable_get(wait_until(timers, deadline)) };
+
+    // Assert
+    REQUIRE(std::chrono::steady_clock::now() >= deadline);
+    REQUIRE(resumedOn != std::this_thread::get_id());
+    REQUIRE(timers.pending_count() == 0);
+}
+
+TEST_CASE("timer_service resumes waits in deadline order")
+{
+    // Arrange
+    async::timer_service timers{};
+    std::vector<int> order{};
+    async::task<void> third{ wait_and_record(timers, std::chrono::milliseconds{ 60 }, 3, order) };
+    async::task<void> first{ wait_and_record(timers, std::chrono::milliseconds{ 20 }, 1, order) };
+    async::task<void> second{ wait_and_record(timers, std::chrono::milliseconds{ 40 }, 2, order) };
+
+    // Act
+    async::awaitable_get(std::move(third));
+
+    // Assert
+    REQUIRE(order == std::vector<int>{ 1, 2, 3 });
+}
+
+TEST_CASE("timer_service.wait_until() throws task_canceled and removes the wait when stop is requested")
+{
+    // Arrange
+    async::timer_service timers{};
+    std::stop_source stopSource{};
+    async::task<std::thread::id> task{ wait_until(
+        timers, std::chrono::steady_clock::now() + std::chrono::hours{ 1 }, stopSource.get_token()) };
+    std::size_t pendingBeforeStop{ timers.pending_count() };
+
+    // Act
+    stopSource.request_stop();
+
+    // Assert
+    REQUIRE(pendingBeforeStop == 1);
+    REQUIRE(timers.pending_count() == 0);
+    REQUIRE(task.await_ready());
+    REQUIRE_THROWS_AS(task.await_resume(), async::task_canceled);
+}
+
+TEST_CASE("timer_service.wait_until() throws task_canceled when stop was already requested")
+{
+    // Arrange
+    async::timer_service timers{};
+    std::stop_source stopSource{};
+    stopSource.request_stop();
+
+    // Act
+    async::task<std::thread::id> task{ wait_until(
+        timers, std::chrono::steady_clock::now() + std::chrono::hours{ 1 }, stopSource.get_token()) };
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE_THROWS_AS(task.await_resume(), async::task_canceled);
+}
+
+TEST_CASE("timer_service destructor cancels pending waits")
+{
+    // Arrange
+    std::optional<async::timer_service> timers{ std::in_place };
+    async::task<std::thread::id> task{ wait_until(
+        *timers, std::chrono::steady_clock::now() + std::chrono::hours{ 1 }) };
+
+    // Act
+    timers.reset();
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE_THROWS_AS(task.await_resume(), async::task_canceled);
+}
+
+TEST_CASE("timer_service handles many pending waits canceled from other threads")
+{
+    // Arrange
+    constexpr int waitCount{ 10000 };
+    async::timer_service timers{};
+    std::vector<std::stop_source> stopSources(waitCount);
+    std::vector<async::task<std::thread::id>> tasks{};
+
+    for (std::stop_source& stopSource : stopSources)
+    {
+        tasks.push_back(wait_until(
+            timers, std::chrono::steady_clock::now() + std::chrono::hours{ 1 }, stopSource.get_token()));
+    }
+
+    // Act
+    {
+        simplejthread first{ [&stopSources]()
+            {
+                for (int i = 0; i < waitCount; i += 2)
+                {
+                    stopSources[i].request_stop();
+                }
+            } };
+
+        for (int i = 1; i < waitCount; i += 2)
+        {
+            stopSources[i].request_stop();
+        }
+    }
+
+    // Assert
+    REQUIRE(timers.pending_count() == 0);
+
+    for (async::task<std::thread::id>& task : tasks)
+    {
+        REQUIRE(task.await_ready());
+        REQUIRE_THROWS_AS(task.await_resume(), async::task_canceled);
+    }
+}
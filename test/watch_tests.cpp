@@ -0,0 +1,185 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/task.h"
+#include "async/watch.h"
+#include "simplejthread.h"
+
+namespace
+{
+    async::task<std::shared_ptr<const async::watch_value<int>>> await_changed(
+        async::watch<int>& cell, std::uint64_t lastSeenVersion)
+    {
+        co_return co_await cell.changed(lastSeenVersion);
+    }
+}
+
+TEST_CASE("watch<T> starts with the initial value at version 0")
+{
+    // Arrange
+    async::watch<std::string> cell{ "initial" };
+
+    // Act
+    std::shared_ptr<const async::watch_value<std::string>> snapshot{ cell.get() };
+
+    // Assert
+    REQUIRE(cell.version() == 0);
+    REQUIRE(snapshot->version == 0);
+    REQUIRE(snapshot->value == "initial");
+}
+
+TEST_CASE("watch<T>.publish() replaces the value and increments the version")
+{
+    // Arrange
+    async::watch<int> cell{ 1 };
+
+    // Act
+    std::uint64_t first{ cell.publish(2) };
+    std::uint64_t second{ cell.publish(3) };
+
+    // Assert
+    REQUIRE(first == 1);
+    REQUIRE(second == 2);
+    REQUIRE(cell.version() == 2);
+    REQUIRE(cell.get()->version == 2);
+    REQUIRE(cell.get()->value == 3);
+}
+
+TEST_CASE("watch<T>.publish() does not modify snapshots already read")
+{
+    // Arrange
+    async::watch<int> cell{ 1 };
+    std::shared_ptr<const async::watch_value<int>> snapshot{ cell.get() };
+
+    // Act
+    cell.publish(2);
+
+    // Assert
+    REQUIRE(snapshot->version == 0);
+    REQUIRE(snapshot->value == 1);
+}
+
+TEST_CASE("watch<T>.changed() does not suspend if a newer version exists")
+{
+    // Arrange
+    async::watch<int> cell{ 1 };
+    cell.publish(2);
+
+    // Act
+    async::task<std::shared_ptr<const async::watch_value<int>>> waiter{ await_changed(cell, 0) };
+
+    // Assert
+    REQUIRE(waiter.await_ready());
+    REQUIRE(waiter.await_resume()->value == 2);
+}
+
+TEST_CASE("watch<T>.changed() suspends until a newer version is published")
+{
+    // Arrange
+    async::watch<int> cell{ 1 };
+    async::task<std::shared_ptr<const async::watch_value<int>>> first{ await_changed(cell, 0) };
+    async::task<std::shared_ptr<const async::watch_value<int>>> second{ await_changed(cell, 0) };
+    bool resumedEarly{ first.await_ready() || second.await_ready() };
+
+    // Act
+    cell.publish(2);
+
+    // Assert
+    REQUIRE(!resumedEarly);
+    REQUIRE(first.await_ready());
+    REQUIRE(first.await_resume()->value == 2);
+    REQUIRE(second.await_ready());
+    REQUIRE(second.await_resume()->value == 2);
+}
+
+TEST_CASE("watch<T>.changed() returns only the latest of several versions")
+{
+    // Arrange
+    async::watch<int> cell{ 1 };
+
+    // Act
+    cell.publish(2);
+    cell.publish(3);
+    cell.publish(4);
+    std::shared_ptr<const async::watch_value<int>> snapshot{ async::awaitable_get(await_changed(cell, 0)) };
+
+    // Assert
+    REQUIRE(snapshot->version == 3);
+    REQUIRE(snapshot->value == 4);
+}
+
+TEST_CASE("watch<T>.close() resumes waiting coroutines with nullptr")
+{
+    // Arrange
+    async::watch<int> cell{ 1 };
+    async::task<std::shared_ptr<const async::watch_value<int>>> waiter{ await_changed(cell, 0) };
+
+    // Act
+    cell.close();
+
+    // Assert
+    REQUIRE(waiter.await_ready());
+    REQUIRE(waiter.await_resume() == nullptr);
+    REQUIRE(async::awaitable_get(await_changed(cell, 0)) == nullptr);
+}
+
+namespace
+{
+    async::task<std::vector<int>> observe_until_closed(async::watch<int>& cell)
+    {
+        std::vector<int> values{};
+        std::uint64_t version{ 0 };
+
+        while (std::shared_ptr<const async::watch_value<int>> snapshot{ co_await cell.changed(version) })
+        {
+            version = snapshot->version;
+            values.push_back(snapshot->value);
+        }
+
+        co_return values;
+    }
+}
+
+TEST_CASE("watch<T> delivers increasing versions to waiters on other threads")
+{
+    // Arrange
+    constexpr int publishCount{ 100000 };
+    constexpr int observerCount{ 4 };
+    async::watch<int> cell{ 0 };
+    std::vector<std::vector<int>> observed(observerCount);
+
+    // Act
+    {
+        std::vector<simplejthread> threads{};
+
+        for (int index = 0; index != observerCount; ++index)
+        {
+            threads.emplace_back([&cell, &observed, index]()
+                { observed[index] = async::awaitable_get(observe_until_closed(cell)); });
+        }
+
+        for (int value = 1; value <= publishCount; ++value)
+        {
+            cell.publish(value);
+        }
+
+        cell.close();
+    }
+
+    // Assert
+    for (const std::vector<int>& values : observed)
+    {
+        REQUIRE(!values.empty());
+        REQUIRE(values.back() == publishCount);
+
+        for (std::size_t index = 1; index != values.size(); ++index)
+        {
+            REQUIRE(values[index - 1] < values[index]);
+        }
+    }
+}
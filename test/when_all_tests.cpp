@@ -0,0 +1,296 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/task.h"
+#include "async/task_completion_source.h"
+#include "async/when_all.h"
+#include "awaitable_reference_value.h"
+#include "awaitable_value.h"
+#include "awaitable_void.h"
+#include "simplejthread.h"
+
+namespace
+{
+    template <typename... Awaitables>
+    using when_all_results_t = decltype(async::when_all(std::declval<Awaitables>()...).await_resume());
+
+    template <typename... Awaitables>
+    async::task<when_all_results_t<Awaitables...>> co_await_when_all(Awaitables... awaitables)
+    {
+        co_return co_await async::when_all(std::move(awaitables)...);
+    }
+
+    template <typename T>
+    async::task<std::vector<T>> co_await_when_all_range(std::vector<async::task<T>> tasks)
+    {
+        co_return co_await async::when_all(std::move(tasks));
+    }
+
+    async::task<void> co_await_when_all_void_range(std::vector<async::task<void>> tasks)
+    {
+        co_await async::when_all(std::move(tasks));
+    }
+}
+
+TEST_CASE("when_all() returns a tuple of results in argument order")
+{
+    // Arrange
+    awaitable_value<int> first{ 1 };
+    awaitable_value<int> second{ 2 };
+
+    // Act
+    std::tuple<int, int> results{ async::awaitable_get(co_await_when_all(std::move(first), std::move(second))) };
+
+    // Assert
+    REQUIRE(results == std::tuple<int, int>{ 1, 2 });
+}
+
+TEST_CASE("when_all() returns std::monostate for void results")
+{
+    // Arrange
+    awaitable_void first{};
+    awaitable_value<int> second{ 2 };
+
+    // Act
+    std::tuple<std::monostate, int> results{ async::awaitable_get(
+        co_await_when_all(std::move(first), std::move(second))) };
+
+    // Assert
+    REQUIRE(std::get<1>(results) == 2);
+}
+
+TEST_CASE("when_all() returns references for reference results")
+{
+    // Arrange
+    int value{ 3 };
+    awaitable_reference_value<int> awaitable{ value };
+
+    // Act
+    std::tuple<int&> results{ async::awaitable_get(co_await_when_all(std::move(awaitable))) };
+
+    // Assert
+    REQUIRE(&std::get<0>(results) == &value);
+}
+
+TEST_CASE("when_all() does not complete until every awaitable completes")
+{
+    // Arrange
+    async::task_completion_source<int> first{};
+    async::task_completion_source<int> second{};
+    async::task<std::tuple<int, int>> task{ co_await_when_all(first.task(), second.task()) };
+
+    // Act
+    second.set_value(2);
+    bool readyEarly{ task.await_ready() };
+    first.set_value(1);
+
+    // Assert
+    REQUIRE(!readyEarly);
+    REQUIRE(task.await_ready());
+    REQUIRE(task.await_resume() == std::tuple<int, int>{ 1, 2 });
+}
+
+TEST_CASE("when_all() throws the first exception in argument order after every awaitable completes")
+{
+    // Arrange
+    async::task_completion_source<int> first{};
+    async::task_completion_source<int> second{};
+    async::task_completion_source<int> third{};
+    async::task<std::tuple<int, int, int>> task{ co_await_when_all(first.task(), second.task(), third.task()) };
+
+    // Act
+    third.set_exception(std::make_exception_ptr(std::logic_error{ "third" }));
+    second.set_exception(std::make_exception_ptr(std::runtime_error{ "second" }));
+    bool readyEarly{ task.await_ready() };
+    first.set_value(1);
+
+    // Assert
+    REQUIRE(!readyEarly);
+    REQUIRE(task.await_ready());
+    REQUIRE_THROWS_MATCHES(task.await_resume(), std::runtime_error, Catch::Matchers::Message("second"));
+}
+
+TEST_CASE("when_all(range) returns a vector of results in range order")
+{
+    // Arrange
+    std::vector<async::task_completion_source<int>> promises(3);
+    std::vector<async::task<int>> tasks{};
+
+    for (async::task_completion_source<int>& promise : promises)
+    {
+        tasks.push_back(promise.task());
+    }
+
+    async::task<std::vector<int>> task{ co_await_when_all_range(std::move(tasks)) };
+
+    // Act
+    promises[2].set_value(3);
+    promises[0].set_value(1);
+    bool readyEarly{ task.await_ready() };
+    promises[1].set_value(2);
+
+    // Assert
+    REQUIRE(!readyEarly);
+    REQUIRE(task.await_ready());
+    REQUIRE(task.await_resume() == std::vector<int>{ 1, 2, 3 });
+}
+
+TEST_CASE("when_all(range) completes immediately for an empty range")
+{
+    // Arrange
+    std::vector<async::task<int>> tasks{};
+
+    // Act
+    std::vector<int> results{ async::awaitable_get(co_await_when_all_range(std::move(tasks))) };
+
+    // Assert
+    REQUIRE(results.empty());
+}
+
+TEST_CASE("when_all(range) throws the first exception in range order for void results")
+{
+    // Arrange
+    std::vector<async::task_completion_source<void>> promises(2);
+    std::vector<async::task<void>> tasks{};
+
+    for (async::task_completion_source<void>& promise : promises)
+    {
+        tasks.push_back(promise.task());
+    }
+
+    async::task<void> task{ co_await_when_all_void_range(std::move(tasks)) };
+
+    // Act
+    promises[1].set_exception(std::make_exception_ptr(std::runtime_error{ "second" }));
+    promises[0].set_value();
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE_THROWS_MATCHES(task.await_resume(), std::runtime_error, Catch::Matchers::Message("second"));
+}
+
+TEST_CASE("when_all(range) completes once when awaitables complete on other threads")
+{
+    // Arrange
+    constexpr int taskCount{ 1000 };
+    constexpr int threadCount{ 4 };
+    std::vector<async::task_completion_source<int>> promises(taskCount);
+    std::vector<async::task<int>> tasks{};
+
+    for (async::task_completion_source<int>& promise : promises)
+    {
+        tasks.push_back(promise.task());
+    }
+
+    async::task<std::vector<int>> task{ co_await_when_all_range(std::move(tasks)) };
+
+    // Act
+    {
+        std::vector<simplejthread> threads{};
+
+        for (int i = 0; i != threadCount; ++i)
+        {
+            threads.emplace_back([&promises, i]()
+                {
+                    for (int j = i; j < taskCount; j += threadCount)
+                    {
+                        promises[j].set_value(j);
+                    }
+                });
+        }
+    }
+
+    // Assert
+    REQUIRE(task.await_ready());
+    std::vector<int> results{ task.await_resume() };
+    REQUIRE(results.size() == taskCount);
+
+    for (int i = 0; i != taskCount; ++i)
+    {
+        REQUIRE(results[i] == i);
+    }
+}
+
+namespace
+{
+    template <typename... T>
+    async::task<std::tuple<async::awaitable_result<T>...>> co_await_when_all_settled(async::task<T>... tasks)
+    {
+        co_return co_await async::when_all_settled(std::move(tasks)...);
+    }
+
+    template <typename T>
+    async::task<std::vector<async::awaitable_result<T>>> co_await_when_all_settled_range(
+        std::vector<async::task<T>> tasks)
+    {
+        co_return co_await async::when_all_settled(std::move(tasks));
+    }
+}
+
+TEST_CASE("when_all_settled() returns every result, including failures, in argument order")
+{
+    // Arrange
+    async::task_completion_source<int> first{};
+    async::task_completion_source<void> second{};
+    async::task<std::tuple<async::awaitable_result<int>, async::awaitable_result<void>>> task{
+        co_await_when_all_settled(first.task(), second.task())
+    };
+
+    // Act
+    second.set_exception(std::make_exception_ptr(std::runtime_error{ "second" }));
+    bool readyEarly{ task.await_ready() };
+    first.set_value(1);
+
+    // Assert
+    REQUIRE(!readyEarly);
+    REQUIRE(task.await_ready());
+    auto results{ task.await_resume() };
+    REQUIRE(std::get<0>(results)() == 1);
+    REQUIRE_THROWS_MATCHES(std::get<1>(results)(), std::runtime_error, Catch::Matchers::Message("second"));
+}
+
+TEST_CASE("when_all_settled(range) returns every result, including failures, in range order")
+{
+    // Arrange
+    std::vector<async::task_completion_source<int>> promises(3);
+    std::vector<async::task<int>> tasks{};
+
+    for (async::task_completion_source<int>& promise : promises)
+    {
+        tasks.push_back(promise.task());
+    }
+
+    async::task<std::vector<async::awaitable_result<int>>> task{ co_await_when_all_settled_range(std::move(tasks)) };
+
+    // Act
+    promises[1].set_exception(std::make_exception_ptr(std::runtime_error{ "second" }));
+    promises[2].set_value(3);
+    promises[0].set_value(1);
+
+    // Assert
+    REQUIRE(task.await_ready());
+    std::vector<async::awaitable_result<int>> results{ task.await_resume() };
+    REQUIRE(results.size() == 3);
+    REQUIRE(results[0]() == 1);
+    REQUIRE_THROWS_MATCHES(results[1](), std::runtime_error, Catch::Matchers::Message("second"));
+    REQUIRE(results[2]() == 3);
+}
+
+TEST_CASE("when_all_settled(range) completes immediately for an empty range")
+{
+    // Arrange
+    std::vector<async::task<void>> tasks{};
+
+    // Act
+    std::vector<async::awaitable_result<void>> results{ async::awaitable_get(
+        co_await_when_all_settled_range(std::move(tasks))) };
+
+    // Assert
+    REQUIRE(results.empty());
+}
@@ -0,0 +1,234 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <coroutine>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <stop_token>
+#include <utility>
+#include <variant>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "async/atomic_acq_rel.h"
+#include "async/awaitable_get.h"
+#include "async/task.h"
+#include "async/task_completion_source.h"
+#include "async/when_any.h"
+#include "awaitable_reference_value.h"
+#include "awaitable_value.h"
+#include "simplejthread.h"
+
+namespace
+{
+    template <typename... Awaitables>
+    using when_any_results_t = decltype(async::when_any(std::declval<Awaitables>()...).await_resume());
+
+    template <typename... Arguments>
+    async::task<when_any_results_t<Arguments...>> co_await_when_any(Arguments... arguments)
+    {
+        co_return co_await async::when_any(std::move(arguments)...);
+    }
+
+    async::task<int> wait_then_record_stop(async::task<int> task, std::stop_token token, bool& stopRequested)
+    {
+        int result{ co_await std::move(task) };
+        stopRequested = token.stop_requested();
+        co_return result;
+    }
+
+    struct awaitable_awaited_spy final
+    {
+        explicit awaitable_awaited_spy(bool& awaited) noexcept : m_awaited{ awaited } {}
+
+        [[nodiscard]] bool await_ready() const noexcept
+        {
+            m_awaited = true;
+            return true;
+        }
+
+        constexpr void await_suspend(std::coroutine_handle<>) const noexcept {}
+
+        [[nodiscard]] constexpr int await_resume() const noexcept { return 2; }
+
+    private:
+        bool& m_awaited;
+    };
+}
+
+TEST_CASE("when_any() returns the index and result of an awaitable that is already complete")
+{
+    // Arrange
+    async::task_completion_source<int> first{};
+    awaitable_value<int> second{ 2 };
+
+    // Act
+    std::variant<int, int> result{ async::awaitable_get(co_await_when_any(first.task(), std::move(second))) };
+
+    // Assert
+    REQUIRE(result.index() == 1);
+    REQUIRE(std::get<1>(result) == 2);
+    first.set_value(1);
+}
+
+TEST_CASE("when_any() completes when the first awaitable completes")
+{
+    // Arrange
+    async::task_completion_source<int> first{};
+    async::task_completion_source<void> second{};
+    async::task<std::variant<int, std::monostate>> task{ co_await_when_any(first.task(), second.task()) };
+
+    // Act
+    bool readyEarly{ task.await_ready() };
+    second.set_value();
+
+    // Assert
+    REQUIRE(!readyEarly);
+    REQUIRE(task.await_ready());
+    REQUIRE(task.await_resume().index() == 1);
+    first.set_value(1);
+}
+
+TEST_CASE("when_any() returns std::reference_wrapper for reference results")
+{
+    // Arrange
+    int value{ 3 };
+    awaitable_reference_value<int> awaitable{ value };
+
+    // Act
+    std::variant<std::reference_wrapper<int>> result{ async::awaitable_get(co_await_when_any(std::move(awaitable))) };
+
+    // Assert
+    REQUIRE(&std::get<0>(result).get() == &value);
+}
+
+TEST_CASE("when_any() throws if the first awaitable to complete throws")
+{
+    // Arrange
+    async::task_completion_source<int> first{};
+    async::task_completion_source<int> second{};
+    async::task<std::variant<int, int>> task{ co_await_when_any(first.task(), second.task()) };
+
+    // Act
+    second.set_exception(std::make_exception_ptr(std::runtime_error{ "second" }));
+    first.set_value(1);
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE_THROWS_MATCHES(task.await_resume(), std::runtime_error, Catch::Matchers::Message("second"));
+}
+
+TEST_CASE("when_any() requests stop for the losers and does not wait for them")
+{
+    // Arrange
+    std::stop_source stopSource{};
+    async::task_completion_source<int> first{};
+    async::task_completion_source<int> second{};
+    bool firstStopRequested{};
+    bool secondStopRequested{};
+    async::task<std::variant<int, int>> task{ co_await_when_any(stopSource,
+        wait_then_record_stop(first.task(), stopSource.get_token(), firstStopRequested),
+        wait_then_record_stop(second.task(), stopSource.get_token(), secondStopRequested)) };
+
+    // Act
+    first.set_value(1);
+    bool readyBeforeLoserCompletes{ task.await_ready() };
+    std::variant<int, int> result{ task.await_resume() };
+    second.set_value(2);
+
+    // Assert
+    REQUIRE(readyBeforeLoserCompletes);
+    REQUIRE(result.index() == 0);
+    REQUIRE(std::get<0>(result) == 1);
+    REQUIRE(!firstStopRequested);
+    REQUIRE(stopSource.stop_requested());
+    REQUIRE(secondStopRequested);
+}
+
+TEST_CASE("when_any() does not start awaitables after one has completed")
+{
+    // Arrange
+    awaitable_value<int> first{ 1 };
+    bool secondAwaited{};
+    awaitable_awaited_spy second{ secondAwaited };
+
+    // Act
+    std::variant<int, int> result{ async::awaitable_get(co_await_when_any(std::move(first), second)) };
+
+    // Assert
+    REQUIRE(result.index() == 0);
+    REQUIRE(!secondAwaited);
+}
+
+TEST_CASE("when_any(range) returns the index and result of the first awaitable to complete")
+{
+    // Arrange
+    std::vector<async::task_completion_source<int>> promises(3);
+    std::vector<async::task<int>> tasks{};
+
+    for (async::task_completion_source<int>& promise : promises)
+    {
+        tasks.push_back(promise.task());
+    }
+
+    async::task<async::when_any_result<int>> task{ co_await_when_any(std::move(tasks)) };
+
+    // Act
+    promises[2].set_value(3);
+    promises[0].set_value(1);
+    promises[1].set_value(2);
+
+    // Assert
+    REQUIRE(task.await_ready());
+    async::when_any_result<int> result{ task.await_resume() };
+    REQUIRE(result.index == 2);
+    REQUIRE(result.value == 3);
+}
+
+TEST_CASE("when_any(range) throws for an empty range")
+{
+    // Arrange
+    std::vector<async::task<void>> tasks{};
+
+    // Act & Assert
+    REQUIRE_THROWS_MATCHES(async::when_any(std::move(tasks)), std::invalid_argument,
+        Catch::Matchers::Message("when_any requires at least one awaitable."));
+}
+
+TEST_CASE("when_any(range) picks exactly one winner when awaitables complete on other threads")
+{
+    // Arrange
+    constexpr int iterations{ 1000 };
+    constexpr int threadCount{ 4 };
+    async::details::atomic_acq_rel<int> completed{ 0 };
+
+    // Act
+    for (int i = 0; i != iterations; ++i)
+    {
+        std::vector<async::task_completion_source<void>> promises(threadCount);
+        std::vector<async::task<void>> tasks{};
+
+        for (async::task_completion_source<void>& promise : promises)
+        {
+            tasks.push_back(promise.task());
+        }
+
+        async::task<async::when_any_result<void>> task{ co_await_when_any(std::move(tasks)) };
+
+        {
+            std::vector<simplejthread> threads{};
+
+            for (async::task_completion_source<void>& promise : promises)
+            {
+                threads.emplace_back([&promise]() { promise.set_value(); });
+            }
+        }
+
+        if (task.await_ready() && task.await_resume().index < threadCount)
+        {
+            completed.fetch_add(1);
+        }
+    }
+
+    // Assert
+    REQUIRE(completed.load() == iterations);
+}
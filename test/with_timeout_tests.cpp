@@ -0,0 +1,85 @@
+// © Microsoft Corporation. All rights reserved.
+
+#include <chrono>
+#include <stop_token>
+#include <catch2/catch.hpp>
+#include "async/awaitable_get.h"
+#include "async/task.h"
+#include "async/task_canceled.h"
+#include "async/task_completion_source.h"
+#include "async/timer_service.h"
+#include "async/with_timeout.h"
+#include "awaitable_value.h"
+
+namespace
+{
+    async::task<int> wait_then_record_stop(async::task<int> task, std::stop_token token, bool& stopRequested)
+    {
+        int result{ co_await std::move(task) };
+        stopRequested = token.stop_requested();
+        co_return result;
+    }
+}
+
+TEST_CASE("with_timeout() returns the result when the awaitable completes in time")
+{
+    // Arrange
+    async::timer_service timers{};
+    async::task_completion_source<int> promise{};
+    async::task<int> task{ async::with_timeout(promise.task(), std::chrono::hours{ 1 }, timers) };
+
+    // Act
+    promise.set_value(123);
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE(task.await_resume() == 123);
+    REQUIRE(timers.pending_count() == 0);
+}
+
+TEST_CASE("with_timeout() returns the result of an awaitable that is already complete")
+{
+    // Arrange
+    async::timer_service timers{};
+    awaitable_value<int> awaitable{ 123 };
+
+    // Act
+    async::task<int> task{ async::with_timeout(std::move(awaitable), std::chrono::hours{ 1 }, timers) };
+
+    // Assert
+    REQUIRE(task.await_ready());
+    REQUIRE(task.await_resume() == 123);
+}
+
+TEST_CASE("with_timeout() throws task_canceled when the awaitable does not complete in time")
+{
+    // Arrange
+    async::timer_service timers{};
+    async::task_completion_source<void> promise{};
+
+    // Act
+    async::task<void> task{ async::with_timeout(promise.task(), std::chrono::milliseconds{ 10 }, timers) };
+
+    // Assert
+    REQUIRE_THROWS_AS(async::awaitable_get(std::move(task)), async::task_canceled);
+    promise.set_value();
+}
+
+TEST_CASE("with_deadline() requests stop on the awaitable when the deadline passes")
+{
+    // Arrange
+    async::timer_service timers{};
+    std::stop_source stopSource{};
+    async::task_completion_source<int> promise{};
+    bool stopRequested{};
+    async::task<int> task{ async::with_deadline(stopSource,
+        wait_then_record_stop(promise.task(), stopSource.get_token(), stopRequested),
+        std::chrono::steady_clock::now() + std::chrono::milliseconds{ 10 }, timers) };
+
+    // Act
+    REQUIRE_THROWS_AS(async::awaitable_get(std::move(task)), async::task_canceled);
+    promise.set_value(1);
+
+    // Assert
+    REQUIRE(stopRequested);
+}